@@ -20,6 +20,7 @@
 #include "val/common/include/acs_pe.h"
 #include "val/common/include/acs_val.h"
 #include "val/common/include/acs_memory.h"
+#include "val/common/include/acs_pgt.h"
 #include "val/bsa/include/bsa_val_interface.h"
 #include "val/bsa/include/bsa_acs_dma.h"
 #include "BsaAcs.h"
@@ -193,6 +194,7 @@ freeBsaAcsMem()
   val_peripheral_free_info_table();
   val_smbios_free_info_table();
   val_dma_free_info_table();
+  val_pgt_release();
   val_free_shared_mem();
 }
 
@@ -18,6 +18,9 @@
 #ifndef __BSA_ACS_LITMUS_H__
 #define __BSA_ACS_LITMUS_H__
 
+void mem_model_set_args(const char *args);
+int barrier_bench_main(int argc, char **argv);
+
 int _X2_2B_2W_2B_dmb_2E_sys(int argc, char **argv);
 int CO_2D_MIXED_2D_20cc_2B_H(int argc, char **argv);
 int CoRR(int argc, char **argv);
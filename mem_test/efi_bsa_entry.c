@@ -24,6 +24,14 @@ extern char *__environ[200];
 efi_status_t mem_model_execute_tests(efi_handle_t handle, efi_system_table_t *sys_tab);
 efi_system_table_t *efi_system_table = NULL;
 
+/* Litmus harness options, "litmus" stands for the program name in argv[0] */
+static char mem_model_args[256];
+
+void mem_model_set_args(const char *args)
+{
+    snprintf(mem_model_args, sizeof(mem_model_args), "litmus %s", args);
+}
+
 static void efi_free_pool(void *ptr)
 {
     efi_bs_call(free_pool, ptr);
@@ -198,6 +206,9 @@ efi_status_t mem_model_execute_tests(efi_handle_t handle, efi_system_table_t *sy
     //     status = EFI_OUT_OF_RESOURCES;
     //     goto efi_main_error;
     // }
+    /* Litmus options come from the BSA command line, see mem_model_set_args */
+    if (mem_model_args[0])
+        cmdline_ptr = mem_model_args;
     setup_args(cmdline_ptr);
 
     /* Set up efi_bootinfo */
@@ -222,6 +233,9 @@ efi_status_t mem_model_execute_tests(efi_handle_t handle, efi_system_table_t *sy
         goto efi_main_error;
     }
 
+      /* Barrier microbenchmark, only with +bench in litmus options */
+      if (barrier_bench_main(__argc, __argv))
+          printf("\n*********************************************\n");
       printf("\nRunning tests ...\n\n");
       printf("\n*********************************************\n");
       _X2_2B_2W_2B_dmb_2E_sys(__argc, __argv);
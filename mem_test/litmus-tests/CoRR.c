@@ -15,6 +15,7 @@
 #define N_n 2
 #define NVARS 1
 #define NEXE 2
+#define NEXE_MAX (AVAIL_MAX/N_n)
 #define NTHREADS 4
 #define NOCCS 1
 /* Includes */
@@ -86,90 +87,7 @@ inline static void cache_touch_store(void *p) {
 
 
 
-typedef struct {
-  volatile int c,sense;
-  int n ;
-} sense_t;
-
-static void barrier_init (sense_t *p,int n) {
-  p->n = p->c = n;
-  p->sense = 0;
-}
-
-/*
-barrier_wait:
-	ldr	w2, [x0,4]
-.L28:
-	ldaxr	w1, [x0]
-	sub	w1, w1, #1
-	stlxr	w3, w1, [x0]
-	cbnz	w3, .L28
-	cmp	w1, wzr
-	ble	.L24
-.L26:
-	ldr	w1, [x0,4]
-	cmp	w1, w2
-	beq	.L26
-	dmb	ish
-.L24:
-	ldr	w1, [x0,8]
-	str	w1, [x0]
-	mov	w1, 1
-	dmb	ish
-	sub	w2, w1, w2
-	str	w2, [x0,4]
-	dmb	ish
-	ret
-*/
-static void barrier_wait(sense_t *p) {
-  int sense = p->sense ;
-  int r1,r3 ;
-asm __volatile (
-"dmb sy\n"
-"0:\n\t"
-"ldxr %w[r1],%[c]\n\t"
-"sub %w[r1],%w[r1],#1\n\t"
-"stxr %w[r3],%w[r1],%[c]\n\t"
-"cbnz %w[r3],0b\n\t"
-"cmp %w[r1],wzr\n\t"
-"ble 2f\n\t"
-"dmb sy\n"
-"1:\n\t"
-"ldr %w[r1],%[s]\n\t"
-"cmp %w[r1],%w[ms]\n\t"
-"beq 1b\n\t"
-"b 3f\n"
-"2:\n\t"
-"dmb sy\n\t"
-"ldr %w[r1],%[n]\n\t"
-"str %w[r1],%[c]\n\t"
-"mov %w[r3],#1\n\t"
-"dmb sy\n\t"
-"sub %w[ms],%w[r3],%w[ms]\n\t"
-"str %w[ms],%[s]\n"
-"3:\n\t"
-"dsb sy\n\t"
-: [r1] "=&r" (r1), [r3] "=&r" (r3)
-: [c] "m" (p->c), [s] "m" (p->sense), [ms] "r" (sense), [n] "m" (p->n)
-: "memory") ;
-}
-#if 0
-/* C version */
-static void barrier_wait(sense_t *p) {
-  int sense = p->sense ;
-  __sync_synchronize() ;
-  int rem = __sync_add_and_fetch(&p->c,-1) ;
-  if (rem > 0) {
-    while (p->sense == sense) ;
-    __sync_synchronize() ;
-  } else {
-    p->c = p->n ;
-    __sync_synchronize() ;
-    p->sense = 1-sense ;
-    __sync_synchronize() ;
-  }
-}
-#endif
+/* Barriers are selected at run time, see kvm_barrier.h */
 /************/
 /* Topology */
 /************/
@@ -178,15 +96,7 @@ static void barrier_wait(sense_t *p) {
  Topology: {{{0}, {1}, {2}, {3}}}
 */
 
-static const int inst[] = {
-// [[0],[1]]
-1, 1, 0, 0,
-};
-
-static const int role[] = {
-// [[0],[1]]
-1, 0, 1, 0,
-};
+/* Instances and roles follow thread placement, see kvm_topology.h */
 
 static const char *group[] = {
 "[[0],[1]]",
@@ -235,13 +145,13 @@ static int eq_log(log_t *p,log_t *q) {
 typedef struct { int instance,proc; } who_t;
 
 static count_t nfaults[NTHREADS];
-static who_t whoami[AVAIL];
+static who_t whoami[AVAIL_MAX];
 
 typedef uint32_t ins_t; /* Type of instructions */
 
 #define PRECISE 1
 
-static vars_t *vars_ptr[NEXE];
+static vars_t *vars_ptr[NEXE_MAX];
 static inline int log_fault(int proc, int instr_symb, int data_symb, int ftype)
 {
   return 0;
@@ -278,7 +188,9 @@ static void record_fault(who_t *w, unsigned long pc, unsigned long esr) {
 
 static void fault_handler(struct pt_regs *regs,unsigned int esr) {
   struct thread_info *ti = current_thread_info();
-  who_t *w = &whoami[ti->cpu];
+  int slot = place_slot(ti->cpu);
+  if (slot < 0 || slot >= AVAIL_MAX) return;
+  who_t *w = &whoami[slot];
   atomic_inc_fetch(&nfaults[w->proc]);
 
   record_fault(w, regs->pc, esr);
@@ -393,18 +305,18 @@ typedef struct {
   int ok ;
 } entry_t ;
 
-static void pp_entry(FILE *out,entry_t *p, int verbose, const char **group) ;
+static void pp_entry(FILE *out,entry_t *p, int verbose, const char **group, count_t total) ;
 
 typedef struct {
   int nhash ;
   entry_t t[HASHSZ] ;
 } hash_t ;
 
-static void pp_hash(FILE *fp,hash_t *t,int verbose,const char **group) {
+static void pp_hash(FILE *fp,hash_t *t,int verbose,const char **group,count_t total) {
   for (int k = 0 ; k < HASHSZ ; k++) {
     entry_t *p = t->t+k ;
     if (p->c > 0) {
-      pp_entry(fp,p,verbose,group) ;
+      pp_entry(fp,p,verbose,group,total) ;
     }
   }
 }
@@ -413,7 +325,7 @@ static void pp_hash(FILE *fp,hash_t *t,int verbose,const char **group) {
 static void pp_hash_ok(FILE *fp,hash_t *t,char **group) {
   for (int k = 0 ; k < HASHSZ ; k++) {
     entry_t *p = t->t+k ;
-    if (p->c > 0 && p->ok) pp_entry(fp,p,1,group) ;
+    if (p->c > 0 && p->ok) pp_entry(fp,p,1,group,0) ;
   }
 }
 #endif
@@ -543,9 +455,13 @@ static int hash_adds(hash_t *t, hash_t *f) {
   return r;
 }
 
-static void pp_entry(FILE *out,entry_t *p, int verbose, const char **group) {
+static void pp_entry(FILE *out,entry_t *p, int verbose, const char **group, count_t total) {
   printf("%-6" PCTR "%c>",p->c,p->ok ? '*' : ':');
   pp_log(out,&p->key);
+  if (total > 0) {
+    puts(" ");
+    pp_rate(p->c,total);
+  }
   if (verbose) {
     puts(" # ");
     pp_param(out,&p->p);
@@ -630,6 +546,23 @@ static void labels_init(vars_t *_vars) {
 }
 
 
+/*********************/
+/* Thread histograms */
+/*********************/
+
+/* Private to one thread, merged after all runs */
+typedef struct {
+  hash_t t ;
+  count_t groups[SCANSZ] ;
+  int hash_ok ;
+} __attribute__((aligned(CACHE_LINE_MAX))) hist_t ;
+
+static void hist_init(hist_t *h) {
+  hash_init(&h->t) ;
+  for (int k = 0 ; k < SCANSZ ; k++) h->groups[k] = 0 ;
+  h->hash_ok = 1 ;
+}
+
 /************/
 /* Instance */
 /************/
@@ -647,19 +580,18 @@ typedef struct {
 #ifdef HAVE_TIMEBASE
   tb_t next_tb;
 #endif
-  hash_t t;
-  sense_t b;
+  barrier_t b;
+  barrier_node_t bn[N_n];
   param_t p;
   int ind[N_n]; /* Indirection for role shuffle */
-} ctx_t ;
+} __attribute__((aligned(CACHE_LINE_MAX))) ctx_t ;
 
 
-static void instance_init(ctx_t *p, int id, intmax_t *mem) {
+static void instance_init(ctx_t *p, int id, intmax_t *mem, barrier_kind_t bk) {
   p->id = id ;
   p->mem = mem ;
-  hash_init(&p->t) ;
   log_init(&p->out) ;
-  barrier_init(&p->b,N_n) ;
+  barrier_init(&p->b,bk,N_n,p->bn) ;
   interval_init((int *)&p->ind,N_n) ;
 #ifdef SOME_VARS
   vars_init(&p->v,mem);
@@ -677,20 +609,17 @@ static void instance_free(ctx_t *p) {
 /* Global context */
 /******************/
 
+typedef enum { stop_none, stop_budget, stop_stable, } stop_t;
+
 #define LINESZ (LINE/sizeof(intmax_t))
 #define VOFFSZ (VOFF/sizeof(intmax_t))
-#define MEMSZ ((NVARS*NEXE+1)*LINESZ)
-
-#ifndef DYNALLOC
-static intmax_t mem[MEMSZ] ;
-#endif
+#define MEMSZ(nexe) ((NVARS*(nexe)+1)*LINESZ)
 
 typedef struct global_t {
   /* Command-line parameter */
   param_t *param ;
   parse_param_t *parse ;
   /* Topology */
-  const int *inst, *role ;
   const char **group ;
   /* memory */
   intmax_t *mem ;
@@ -703,16 +632,27 @@ typedef struct global_t {
   int size,nruns,nexe,noccs ;
   int delay,step ;
   int fix ;
+  /* Placement */
+  place_t place ;
+  int avail ;
   /* Indirection for shuffling all threads */
-  int ind[AVAIL] ;
+  int ind[AVAIL_MAX] ;
   /* Synchronisation for all threads */
-  sense_t gb ;
+  barrier_kind_t barrier ;
+  barrier_t gb ;
+  barrier_node_t *gbn ;
   /* Count 'interesting' outcomes */
   volatile int ok ;
   /* Times for timeout */
   tsc_t start,now ;
+  /* Early stop: time budget and confidence interval target (ppm) */
+  tsc_t budget ;
+  int ci ;
+  volatile int stop ;
+  int runs ;
   /* All instance contexts */
-  ctx_t ctx[NEXE] ; /* All test instance contexts */
+  ctx_t *ctx ;      /* All test instance contexts */
+  hist_t *hist ;    /* Per-thread outcomes */
   hash_t hash ;     /* Sum of outcomes */
   int hash_ok;
 #ifdef STATS
@@ -725,8 +665,6 @@ typedef struct global_t {
 static void init_global(global_t *g) {
   g->param = &param;
   g->parse = &parse[0];
-  g->inst = inst;
-  g->role = role;
   g->group = group;
 #ifdef ACTIVE
   g->active = active;
@@ -736,25 +674,35 @@ static void init_global(global_t *g) {
   g->start = timeofday() ;
 #endif
   /* Global barrier */
-  barrier_init(&g->gb,AVAIL) ;
+  barrier_init(&g->gb,g->barrier,g->avail,g->gbn) ;
   /* Align  to cache line */
   uintptr_t x = (uintptr_t)(g->mem) ;
   x += LINE-1 ; x /=  LINE ; x *= LINE ;
   intmax_t *m = (intmax_t *)x ;
   /* Instance contexts */
-  for (int k = 0 ; k < NEXE ; k++) {
-    instance_init(&g->ctx[k],k,m) ;
+  for (int k = 0 ; k < g->nexe ; k++) {
+    instance_init(&g->ctx[k],k,m,g->barrier) ;
     m += NVARS*LINESZ ;
   }
+  for (int k = 0 ; k < g->avail ; k++) hist_init(&g->hist[k]) ;
   g->hash_ok = 1;
+  g->stop = stop_none ;
+  g->runs = g->nruns ;
+#ifdef STATS
+  memset(&g->stats,0,sizeof(g->stats)) ;
+#endif
+  memset(nfaults,0,sizeof(nfaults)) ;
 }
 
 static void free_global(global_t *g) {
-  for (int k = 0 ; k < NEXE ; k++) {
+  for (int k = 0 ; k < g->nexe ; k++) {
     instance_free(&g->ctx[k]);
   }
-#ifdef DYNALLOC
+  free(g->ctx);
+  free(g->hist);
+  free(g->gbn);
   free(g->mem);
+#ifdef DYNALLOC
   free(g);
 #endif
 }
@@ -775,18 +723,18 @@ typedef struct {
 
 
 static void set_role(global_t *g,thread_ctx_t *c,int part) {
-  barrier_wait(&g->gb) ;
-  int idx = SCANLINE*part+g->ind[c->id] ;
-  int inst = g->inst[idx] ;
+  barrier_wait(&g->gb,c->id) ;
+  int idx = g->ind[c->id] ;
+  int inst = idx / N_n ;
   if (0 <= inst && inst < g->nexe) {
     c->inst = inst ;
     c->ctx = &g->ctx[inst] ;
-    c->role = g->role[idx] ;
+    c->role = idx % N_n ;
     if (SCANSZ > 1 && !g->fix) {
     /* Shuffle roles in case several topological placements are possible. */
       ctx_t *d = c->ctx ;
       if (c->role == 0) interval_shuffle(&c->seed,(int *)&d->ind,N_n);
-      barrier_wait(&d->b) ;
+      barrier_wait(&d->b,c->role) ;
       c->role = d->ind[c->role] ;
     }
 #ifdef KVM
@@ -818,7 +766,7 @@ static void set_role(global_t *g,thread_ctx_t *c,int part) {
 #ifdef KVM
   set_fault_vector(c->role);
 #endif
-  barrier_wait(&g->gb) ;
+  barrier_wait(&g->gb,c->id) ;
 }
 
 static void init_getinstrs(void) {
@@ -830,36 +778,37 @@ inline static int do_run(thread_ctx_t *_c, param_t *_p,global_t *_g) {
   int _role = _c->role;
   if (_role < 0) return _ok;
   ctx_t *_ctx = _c->ctx;
-  sense_t *_b = &_ctx->b;
+  barrier_t *_b = &_ctx->b;
   log_t *_log = &_ctx->out;
   vars_t *_vars = &_ctx->v;
   int *x = (int *)_vars->x;
-  barrier_wait(_b);
+  barrier_wait(_b,_role);
   switch (_role) {
   case 0: {
-    barrier_wait(_b);
+    barrier_wait(_b,_role);
     if (_p->c_0_x == ctouch) cache_touch((void *)x);
     else if (_p->c_0_x == cflush) cache_flush((void *)x);
-    barrier_wait(_b);
+    barrier_wait(_b,_role);
     code0(x);
-    barrier_wait(_b);
+    barrier_wait(_b,_role);
     int _cond = final_ok(final_cond(_log));
-    int _added = hash_add(&_ctx->t,_log,_p,1,_cond);
-    if (!_added && _g->hash_ok) _g->hash_ok = 0; // Avoid writing too much.
+    hist_t *_h = &_g->hist[_c->id];
+    int _added = hash_add(&_h->t,_log,_p,1,_cond);
+    if (!_added && _h->hash_ok) _h->hash_ok = 0; // Avoid writing too much.
     if (_cond) {
       _ok = 1;
-      (void)__sync_add_and_fetch(&_g->stats.groups[_p->part],1);
+      _h->groups[_p->part]++;
     }
     break; }
   case 1: {
     *x = 0;
     litmus_flush_tlb((void *)x);
-    barrier_wait(_b);
+    barrier_wait(_b,_role);
     if (_p->c_1_x == ctouch) cache_touch((void *)x);
     else if (_p->c_1_x == cflush) cache_flush((void *)x);
-    barrier_wait(_b);
+    barrier_wait(_b,_role);
     code1(x,&_log->out_1_x1,&_log->out_1_x2);
-    barrier_wait(_b);
+    barrier_wait(_b,_role);
     (void)litmus_set_pte_safe(x,_vars->pte_x,_vars->saved_pte_x);
     litmus_flush_tlb((void *)x);
     break; }
@@ -883,7 +832,7 @@ static void choose_params(global_t *g,thread_ctx_t *c,int part) {
   param_t *q = g->param;
 
   for (int _s=0 ; _s < g->size ; _s++) {
-    barrier_wait(&ctx->b);
+    barrier_wait(&ctx->b,_role);
     switch (_role) {
     case 0:
       ctx->p.c_0_x = comp_param(&c->seed,&q->c_0_x,cmax,1);
@@ -897,15 +846,58 @@ static void choose_params(global_t *g,thread_ctx_t *c,int part) {
   }
 }
 
+/*
+  Called by thread 0 between runs, while all threads wait on the global
+  barrier. Outcomes are stable once the confidence interval of every
+  observed outcome, and the bound on a yet unseen one, is narrow enough.
+*/
+static int stable(global_t *g) {
+  hash_t *t = &g->hash ;
+  count_t n = 0 ;
+  uint64_t lo,hi ;
+
+  hash_init(t) ;
+  for (int k = 0 ; k < g->avail ; k++) (void)hash_adds(t,&g->hist[k].t) ;
+  for (int k = 0 ; k < HASHSZ ; k++) n += t->t[k].c ;
+  wilson_ppm(0,n,&lo,&hi) ;
+  if (hi > 2*(uint64_t)g->ci) return 0 ;
+  for (int k = 0 ; k < HASHSZ ; k++) {
+    entry_t *p = t->t+k ;
+    if (p->c == 0) continue ;
+    wilson_ppm(p->c,n,&lo,&hi) ;
+    if (hi-lo > 2*(uint64_t)g->ci) return 0 ;
+  }
+  return 1 ;
+}
+
+static stop_t stop_now(global_t *g,int nrun) {
+  if (nrun == 0) return stop_none ;
+  stop_t r = stop_none ;
+  if (g->budget > 0) {
+    g->now = timeofday() ;
+    if (g->now-g->start >= g->budget) r = stop_budget ;
+  }
+  if (r == stop_none && g->ci > 0 && stable(g)) r = stop_stable ;
+  if (r != stop_none) g->runs = nrun ;
+  return r ;
+}
+
 static void choose(int id,global_t *g) {
   param_t *q = g->param;
   thread_ctx_t c; c.id = c.seed = id;
   st_t seed = 0; st_t seed0 = 0;
 
   for (int nrun = 0; nrun < g->nruns ; nrun++) {
+    if (g->budget > 0 || g->ci > 0) {
+      barrier_wait(&g->gb,id);
+      if (id == 0) g->stop = stop_now(g,nrun);
+      barrier_wait(&g->gb,id);
+      if (g->stop != stop_none) break;
+    }
     if (SCANSZ <= 1 && !g->fix && id == 0) {
-    /* Shuffle all threads in absence of topology information. */
-      interval_shuffle(&seed0,(int *)g->ind,AVAIL);
+    /* Shuffle all threads, or within instances when placed on purpose. */
+      interval_shuffle_groups(&seed0,(int *)g->ind,g->avail,
+                              g->place == place_any ? g->avail : N_n);
     }
     if (g->verbose>1) fprintf(stderr, "Run %d of %d\r", nrun, g->nruns);
     /* Select threads partition amounts SCANSZ */
@@ -921,8 +913,8 @@ typedef struct {
 } zyva_t;
 
 static void zyva(void *_a) {
-  int id = smp_processor_id();
-  if (id >= AVAIL) return;
+  int id = place_slot(smp_processor_id());
+  if (id < 0 || id >= AVAIL_MAX) return;
   zyva_t *a = (zyva_t*)_a + id;
   global_t *g = a->g;
   install_fault_handler(id);
@@ -944,7 +936,7 @@ static void postlude(FILE *out,global_t *g,count_t p_true,count_t p_false,tsc_t
   hash_t *hash = &g->hash ;
   puts("Test CoRR Forbidden\n");
   printf("Histogram (%d states)\n",hash->nhash);
-  pp_hash(out,hash,g->verbose > 1,g->group);
+  pp_hash(out,hash,g->verbose > 1,g->group,(g->budget > 0 || g->ci > 0) ? p_true+p_false : 0);
   int cond = p_true == 0;
   puts(cond?"Ok":"No");
   puts("\n");
@@ -976,6 +968,13 @@ static void postlude(FILE *out,global_t *g,count_t p_true,count_t p_false,tsc_t
   puts("Time CoRR ");
   emit_millions(tsc_millions(total));
   puts("\n");
+  printf("Throughput CoRR %" PRIu64 " outcomes/s\n",
+         total > 0 ? ((uint64_t)(p_true+p_false)*1000000)/total : 0);
+  if (g->budget > 0 || g->ci > 0) {
+    printf("Runs CoRR %d, stopped by %s\n",g->runs,
+           g->stop == stop_budget ? "time budget" :
+           g->stop == stop_stable ? "confidence" : "run count");
+  }
   if (!g->hash_ok) {
     puts("Warning: some hash table was full, some outcomes were not collected\n");
   }
@@ -992,9 +991,9 @@ static void postlude(FILE *out,global_t *g,count_t p_true,count_t p_false,tsc_t
 
 #ifndef DYNALLOC
 static global_t global;
-static zyva_t arg[AVAIL];
+static zyva_t arg[AVAIL_MAX];
 #ifndef KVM
-static pthread_t th[AVAIL];
+static pthread_t th[AVAIL_MAX];
 #endif
 #endif
 
@@ -1011,44 +1010,49 @@ static int RUN(int argc,char **argv,FILE *out) {
 #endif
 #endif
   global_t *glo_ptr = malloc_check(sizeof(global_t));
-  glo_ptr->mem = malloc_check(MEMSZ*sizeof(*glo_ptr->mem));
-  zyva_t *arg = malloc_check(AVAIL*sizeof(*arg));
+  zyva_t *arg = malloc_check(AVAIL_MAX*sizeof(*arg));
 #ifndef KVM
-  pthread_t *th = malloc_check(AVAIL*sizeof(*th));
+  pthread_t *th = malloc_check(AVAIL_MAX*sizeof(*th));
 #endif
 #else
   global_t *glo_ptr = &global;
-  glo_ptr->mem = mem;
 #endif
   init_getinstrs();
-  init_global(glo_ptr);
-#ifdef OUT_n
 #ifdef HAVE_TIMEBASE
   const int delta_tb = DELTA_TB;
 #else
   const int delta_tb = 0;
 #endif
-  opt_t def = { 0, NUMBER_OF_RUN, SIZE_OF_TEST, AVAIL, NEXE, delta_tb, 0, };
+  /* All PEs by default, as independent instances of N_n threads */
+  opt_t def = { 0, NUMBER_OF_RUN, SIZE_OF_TEST, place_avail(), place_avail()/N_n, delta_tb, 0, };
   opt_t d = def;
   char *prog = argv[0];
   char **p = parse_opt(argc,argv,&def,&d);
   int n_exe = d.n_exe;
-  if (d.avail < AVAIL) n_exe = d.avail / N_n;
+  if (d.avail != def.avail) n_exe = d.avail / N_n;
 #ifdef HAVE_TIMEBASE
   if (d.delay < NSTEPS-1) d.delay = NSTEPS-1;
 #endif
   if (n_exe < 1) n_exe = 1;
-  if (n_exe > NEXE) n_exe = NEXE;
+  if (n_exe > NEXE_MAX) n_exe = NEXE_MAX;
+  /* Instances are independent, each one has its own context, outcomes and locations */
+  glo_ptr->ctx = memalign_check(CACHE_LINE_MAX,n_exe*sizeof(ctx_t));
+  glo_ptr->hist = memalign_check(CACHE_LINE_MAX,n_exe*N_n*sizeof(hist_t));
+  glo_ptr->gbn = memalign_check(CACHE_LINE_MAX,n_exe*N_n*sizeof(barrier_node_t));
+  glo_ptr->mem = memalign_check(LINE,MEMSZ(n_exe)*sizeof(intmax_t));
   glo_ptr->verbose = d.verbose;
   glo_ptr->nexe = n_exe;
-  glo_ptr->nruns = d.max_run;
+  glo_ptr->nruns = d.budget > 0 ? NRUNS_MAX : d.max_run;
+  glo_ptr->budget = (tsc_t)d.budget*1000000;
+  glo_ptr->ci = d.ci;
   glo_ptr->size = d.size_of_test;
 #ifdef HAVE_TIMEBASE
   glo_ptr->delay = d.delay;
   glo_ptr->step = d.delay/(NSTEPS-1);
 #endif
   glo_ptr->fix = d.fix;
-  interval_init((int *)&glo_ptr->ind,AVAIL);
+  glo_ptr->barrier = d.barrier;
+  if (glo_ptr->barrier != barrier_sense) printf("Barrier %s\n",barrier_name(glo_ptr->barrier));
   if (glo_ptr->verbose) {
 #ifdef NOSTDIO
     emit_string(stderr,prog);
@@ -1067,36 +1071,52 @@ static int RUN(int argc,char **argv,FILE *out) {
 #ifdef PRELUDE
   prelude(out);
 #endif
-  tsc_t start = timeofday();
-#endif
-  for (int id=0; id < AVAIL; id++) {
-    arg[id].id = id;
-    arg[id].g = glo_ptr;
-  }
+  /* One complete run per placement strategy */
+  int places = d.place ? d.place : 1 << place_any;
+  for (place_t pl = 0 ; pl < place_max ; pl++) {
+    if (!(places & (1 << pl))) continue;
+    int nexe = N_n > 1 || pl == place_any ? place_cpus(pl,N_n,n_exe) : 0;
+    if (nexe == 0) {
+      printf("Placement %s: not applicable, skipped\n",place_name(pl));
+      continue;
+    }
+    glo_ptr->place = pl;
+    glo_ptr->nexe = nexe;
+    glo_ptr->avail = nexe*N_n;
+    interval_init((int *)&glo_ptr->ind,glo_ptr->avail);
+    init_global(glo_ptr);
+    place_pp(pl,N_n,nexe,glo_ptr->verbose);
+    tsc_t start = timeofday();
+    glo_ptr->start = start;
+    for (int id=0; id < glo_ptr->avail; id++) {
+      arg[id].id = id;
+      arg[id].g = glo_ptr;
+    }
 #ifdef KVM
-  on_cpus(zyva, arg);
+    on_cpus(zyva, arg);
 #else
-  for (int id=0; id < AVAIL ; id++) launch(&th[id],zyva,&arg[id]);
-  for (int id=0; id < AVAIL ; id++) join(&th[id]);
+    for (int id=0; id < glo_ptr->avail ; id++) launch(&th[id],zyva,&arg[id]);
+    for (int id=0; id < glo_ptr->avail ; id++) join(&th[id]);
 #endif
-  int nexe = glo_ptr->nexe ;
-  hash_init(&glo_ptr->hash) ;
-  for (int k=0 ; k < nexe ; k++) {
-    glo_ptr->hash_ok = hash_adds(&glo_ptr->hash,&glo_ptr->ctx[k].t) && glo_ptr->hash_ok ;
-  }
-#ifdef OUT_n
-  tsc_t total = timeofday()-start;
-  count_t p_true = 0, p_false = 0;
-  for (int k = 0 ; k < HASHSZ ; k++) {
-    entry_t *e = &glo_ptr->hash.t[k];
-    if (e->ok) {
-      p_true += e->c;
-    } else {
-      p_false += e->c;
+    /* Merge per-thread histograms */
+    hash_init(&glo_ptr->hash) ;
+    for (int k=0 ; k < glo_ptr->avail ; k++) {
+      hist_t *h = &glo_ptr->hist[k] ;
+      glo_ptr->hash_ok = hash_adds(&glo_ptr->hash,&h->t) && h->hash_ok && glo_ptr->hash_ok ;
+      for (int j = 0 ; j < SCANSZ ; j++) glo_ptr->stats.groups[j] += h->groups[j] ;
     }
+    tsc_t total = timeofday()-start;
+    count_t p_true = 0, p_false = 0;
+    for (int k = 0 ; k < HASHSZ ; k++) {
+      entry_t *e = &glo_ptr->hash.t[k];
+      if (e->ok) {
+        p_true += e->c;
+      } else {
+        p_false += e->c;
+      }
+    }
+    postlude(out,glo_ptr,p_true,p_false,total);
   }
-  postlude(out,glo_ptr,p_true,p_false,total);
-#endif
   free_global(glo_ptr);
 #ifdef DYNALLOC
 #ifdef HAVE_FAULT_HANDLER
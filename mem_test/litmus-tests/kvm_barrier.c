@@ -0,0 +1,247 @@
+/** @file
+ * Copyright (c) 2024, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#include <libcflat.h>
+#include <asm/processor.h>
+#include <asm/setup.h>
+#include <asm/smp.h>
+#include "utils.h"
+
+/* Timebase start delay, must exceed the release latency of the barrier */
+#define BARRIER_TB_NS 2000
+
+static const char *barrier_names[barrier_max] = {
+  [barrier_sense] = "sense",
+  [barrier_dissemination] = "dissemination",
+  [barrier_tree] = "tree",
+  [barrier_timebase] = "timebase",
+};
+
+const char *barrier_name(barrier_kind_t k) {
+  return k < barrier_max ? barrier_names[k] : "?" ;
+}
+
+int barrier_parse(const char *s) {
+  for (int k = 0 ; k < barrier_max ; k++) {
+    if (strcmp(s,barrier_names[k]) == 0) return k ;
+  }
+  return -1 ;
+}
+
+static inline uint64_t counter(void) {
+  isb() ;
+  return read_sysreg(cntvct_el0) ;
+}
+
+void barrier_init(barrier_t *p,barrier_kind_t k,int n,barrier_node_t *node) {
+  p->n = p->c = n ;
+  p->sense = 0 ;
+  p->kind = k ;
+  p->node = node ;
+  p->rounds = 0 ;
+  while ((1 << p->rounds) < n) p->rounds++ ;
+  if (p->rounds > BARRIER_ROUNDS_MAX) fatal("barrier_init: too many threads") ;
+  if (node == NULL && (k == barrier_dissemination || k == barrier_tree)) {
+    fatal("barrier_init: no node array") ;
+  }
+  for (int i = 0 ; node && i < n ; i++) {
+    memset(&node[i],0,sizeof(node[i])) ;
+    node[i].sense = 1 ;
+  }
+  p->tb = 0 ;
+  p->delta = (get_cntfrq()*BARRIER_TB_NS)/1000000000 ;
+  if (p->delta < 1) p->delta = 1 ;
+}
+
+/* Litmus7 centralised barrier, see C version in barrier_timebase_wait */
+static void barrier_sense_wait(barrier_t *p) {
+  int sense = p->sense ;
+  int r1,r3 ;
+asm __volatile (
+"dmb sy\n"
+"0:\n\t"
+"ldxr %w[r1],%[c]\n\t"
+"sub %w[r1],%w[r1],#1\n\t"
+"stxr %w[r3],%w[r1],%[c]\n\t"
+"cbnz %w[r3],0b\n\t"
+"cmp %w[r1],wzr\n\t"
+"ble 2f\n\t"
+"dmb sy\n"
+"1:\n\t"
+"ldr %w[r1],%[s]\n\t"
+"cmp %w[r1],%w[ms]\n\t"
+"beq 1b\n\t"
+"b 3f\n"
+"2:\n\t"
+"dmb sy\n\t"
+"ldr %w[r1],%[n]\n\t"
+"str %w[r1],%[c]\n\t"
+"mov %w[r3],#1\n\t"
+"dmb sy\n\t"
+"sub %w[ms],%w[r3],%w[ms]\n\t"
+"str %w[ms],%[s]\n"
+"3:\n\t"
+: [r1] "=&r" (r1), [r3] "=&r" (r3)
+: [c] "m" (p->c), [s] "m" (p->sense), [ms] "r" (sense), [n] "m" (p->n)
+: "memory") ;
+}
+
+/*
+  Per index state is updated before signalling, so that the next
+  thread to use the index sees it once the episode completes.
+*/
+static void barrier_dissemination_wait(barrier_t *p,int id) {
+  barrier_node_t *me = &p->node[id] ;
+  int parity = me->parity, sense = me->sense ;
+
+  if (parity) me->sense = 1-sense ;
+  me->parity = 1-parity ;
+  for (int r = 0 ; r < p->rounds ; r++) {
+    barrier_node_t *partner = &p->node[(id+(1 << r)) % p->n] ;
+    __atomic_store_n(&partner->flag[parity][r],sense,__ATOMIC_RELEASE) ;
+    while (__atomic_load_n(&me->flag[parity][r],__ATOMIC_ACQUIRE) != sense) ;
+  }
+}
+
+static void barrier_tree_wait(barrier_t *p,int id) {
+  barrier_node_t *me = &p->node[id] ;
+  int sense = me->sense ;
+  int c0 = 2*id+1, c1 = 2*id+2 ;
+
+  me->sense = 1-sense ;
+  if (c0 < p->n) while (__atomic_load_n(&p->node[c0].arrive,__ATOMIC_ACQUIRE) != sense) ;
+  if (c1 < p->n) while (__atomic_load_n(&p->node[c1].arrive,__ATOMIC_ACQUIRE) != sense) ;
+  if (id > 0) {
+    __atomic_store_n(&me->arrive,sense,__ATOMIC_RELEASE) ;
+    while (__atomic_load_n(&me->wake,__ATOMIC_ACQUIRE) != sense) ;
+  }
+  if (c0 < p->n) __atomic_store_n(&p->node[c0].wake,sense,__ATOMIC_RELEASE) ;
+  if (c1 < p->n) __atomic_store_n(&p->node[c1].wake,sense,__ATOMIC_RELEASE) ;
+}
+
+/*
+  The last thread to arrive sets the start time before releasing the
+  others. The next episode cannot overwrite it before all threads
+  have read it, since they all have to arrive first.
+*/
+static void barrier_timebase_wait(barrier_t *p) {
+  int sense = p->sense ;
+  __sync_synchronize() ;
+  int rem = __sync_add_and_fetch(&p->c,-1) ;
+  if (rem > 0) {
+    while (p->sense == sense) ;
+    __sync_synchronize() ;
+  } else {
+    p->c = p->n ;
+    p->tb = counter()+p->delta ;
+    __sync_synchronize() ;
+    p->sense = 1-sense ;
+    __sync_synchronize() ;
+  }
+  uint64_t tb = p->tb ;
+  while (counter() < tb) ;
+}
+
+void barrier_wait(barrier_t *p,int id) {
+  switch (p->kind) {
+  case barrier_dissemination:
+    barrier_dissemination_wait(p,id) ;
+    break ;
+  case barrier_tree:
+    barrier_tree_wait(p,id) ;
+    break ;
+  case barrier_timebase:
+    barrier_timebase_wait(p) ;
+    break ;
+  default:
+    barrier_sense_wait(p) ;
+    break ;
+  }
+  asm __volatile__ ("dsb sy" ::: "memory") ;
+}
+
+/******************/
+/* Microbenchmark */
+/******************/
+
+#define BENCH_SAMPLES 256
+
+static struct {
+  barrier_t b ;
+  int nthr,iters ;
+  uint64_t ticks ;
+  uint64_t *stamp ; /* BENCH_SAMPLES exit times per thread */
+} bench ;
+
+static void bench_thread(void *_a) {
+  int id = smp_processor_id() ;
+  if (id >= bench.nthr) return ;
+  barrier_wait(&bench.b,id) ;
+  uint64_t t0 = counter() ;
+  for (int k = 0 ; k < bench.iters ; k++) barrier_wait(&bench.b,id) ;
+  uint64_t t1 = counter() ;
+  if (id == 0) bench.ticks = t1-t0 ;
+  for (int k = 0 ; k < BENCH_SAMPLES ; k++) {
+    barrier_wait(&bench.b,id) ;
+    bench.stamp[k*bench.nthr+id] = counter() ;
+  }
+}
+
+static uint64_t ticks_ns(uint64_t t,uint64_t freq) {
+  return freq > 0 ? (t*1000000000)/freq : 0 ;
+}
+
+void barrier_bench(int nthr,int iters) {
+  uint64_t freq = get_cntfrq() ;
+
+  if (nthr > nr_cpus) nthr = nr_cpus ;
+  if (nthr < 1) nthr = 1 ;
+  if (iters < 1) iters = 1 ;
+  barrier_node_t *node = memalign_check(CACHE_LINE_MAX,nthr*sizeof(*node)) ;
+  bench.stamp = memalign_check(CACHE_LINE_MAX,BENCH_SAMPLES*nthr*sizeof(uint64_t)) ;
+  bench.nthr = nthr ;
+  bench.iters = iters ;
+  for (barrier_kind_t k = 0 ; k < barrier_max ; k++) {
+    barrier_init(&bench.b,k,nthr,node) ;
+    on_cpus(bench_thread,NULL) ;
+    uint64_t sum = 0, worst = 0 ;
+    for (int s = 0 ; s < BENCH_SAMPLES ; s++) {
+      uint64_t *t = &bench.stamp[s*nthr] ;
+      uint64_t lo = t[0], hi = t[0] ;
+      for (int i = 1 ; i < nthr ; i++) {
+        if (t[i] < lo) lo = t[i] ;
+        if (t[i] > hi) hi = t[i] ;
+      }
+      sum += hi-lo ;
+      if (hi-lo > worst) worst = hi-lo ;
+    }
+    printf("Barrier %s: %d PEs, latency %" PRIu64 " ns, skew avg %" PRIu64 " ns, max %" PRIu64 " ns\n",
+           barrier_name(k),nthr,ticks_ns(bench.ticks,freq)/iters,
+           ticks_ns(sum/BENCH_SAMPLES,freq),ticks_ns(worst,freq)) ;
+  }
+  free(bench.stamp) ;
+  free(node) ;
+}
+
+int barrier_bench_main(int argc,char **argv) {
+  opt_t def = { 0, 1, 10000, nr_cpus, 1, 0, 0, } ;
+  opt_t d = def ;
+  (void)parse_opt(argc,argv,&def,&d) ;
+  if (!d.bench) return 0 ;
+  barrier_bench(d.avail,d.size_of_test) ;
+  return 1 ;
+}
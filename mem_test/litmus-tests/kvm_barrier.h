@@ -0,0 +1,86 @@
+/** @file
+ * Copyright (c) 2024, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#ifndef _KVM_BARRIER_H
+#define _KVM_BARRIER_H 1
+
+/*
+  Thread barriers.
+
+  All threads of a test synchronise with barrier_wait before and after
+  every iteration. Participants are numbered 0..n-1 by the caller, each
+  index is used by exactly one thread per barrier episode, although the
+  thread that uses a given index may change from one episode to the next.
+
+  - sense: centralised sense-reversing barrier on one shared counter.
+  - dissemination: log2(n) rounds of pairwise signalling, no shared counter.
+  - tree: binary combining tree for arrival, binary tree for wakeup.
+  - timebase: centralised arrival, then all threads leave together when
+    the generic counter reaches a start time chosen by the last arriver.
+
+  Included from utils.h, after CACHE_LINE_MAX.
+*/
+
+typedef enum {
+  barrier_sense,
+  barrier_dissemination,
+  barrier_tree,
+  barrier_timebase,
+  barrier_max,
+} barrier_kind_t;
+
+/* Dissemination rounds, enough for 1 << BARRIER_ROUNDS_MAX threads */
+#define BARRIER_ROUNDS_MAX 12
+
+/* Per participant state, written by one or two threads only */
+typedef struct {
+  int flag[2][BARRIER_ROUNDS_MAX] ; /* dissemination, set by partners */
+  int arrive,wake ;                 /* tree, set by self and parent */
+  int sense,parity ;                /* private */
+} __attribute__((aligned(CACHE_LINE_MAX))) barrier_node_t ;
+
+typedef struct {
+  volatile int c,sense ;
+  int n ;
+  barrier_kind_t kind ;
+  int rounds ;
+  volatile uint64_t tb ; /* timebase: start time of current episode */
+  uint64_t delta ;       /* timebase: start delay in counter ticks */
+  barrier_node_t *node ; /* n participants */
+} barrier_t ;
+
+const char *barrier_name(barrier_kind_t k) ;
+
+/* Parse a barrier name, -1 on error */
+int barrier_parse(const char *s) ;
+
+/* Node array may be NULL for the sense and timebase kinds */
+void barrier_init(barrier_t *p,barrier_kind_t k,int n,barrier_node_t *node) ;
+
+void barrier_wait(barrier_t *p,int id) ;
+
+/*
+  Microbenchmark: for every barrier kind, latency of a barrier episode
+  and skew of the exit times of nthr PEs, measured with the generic
+  counter over iters episodes.
+*/
+void barrier_bench(int nthr,int iters) ;
+
+/* Run barrier_bench when +bench is given in litmus options */
+int barrier_bench_main(int argc,char **argv) ;
+
+#endif
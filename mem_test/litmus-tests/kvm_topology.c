@@ -0,0 +1,191 @@
+/** @file
+ * Copyright (c) 2024, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#include <libcflat.h>
+#include <asm/processor.h>
+#include <asm/setup.h>
+#include "kvm_topology.h"
+
+/*
+  Topology is derived from the MPIDR_EL1 affinity fields of every PE,
+  the way Linux does in the absence of a PPTT: when MPIDR_EL1.MT is set,
+  Aff0 is the thread, Aff1 the core, Aff2 the cluster and Aff3 the
+  socket; otherwise Aff0 is the core, Aff1 the cluster and Aff2/Aff3
+  the socket.
+*/
+
+typedef enum { lvl_thread, lvl_core, lvl_cluster, lvl_socket, lvl_system, } lvl_t;
+
+#define MPIDR_MT (1UL << 24)
+
+static uint64_t aff(uint64_t mpidr,int n) {
+  int shift = n < 3 ? 8*n : 32 ;
+  return (mpidr >> shift) & 0xff ;
+}
+
+/* Identifier of the topology domain of level l that contains PE cpu */
+static uint64_t topo_id(int cpu,lvl_t l,int mt) {
+  uint64_t mpidr = cpus[cpu] ;
+  uint64_t f[lvl_system] ;
+
+  if (mt) {
+    f[lvl_thread] = aff(mpidr,0) ;
+    f[lvl_core] = aff(mpidr,1) ;
+    f[lvl_cluster] = aff(mpidr,2) ;
+    f[lvl_socket] = aff(mpidr,3) ;
+  } else {
+    f[lvl_thread] = 0 ;
+    f[lvl_core] = aff(mpidr,0) ;
+    f[lvl_cluster] = aff(mpidr,1) ;
+    f[lvl_socket] = aff(mpidr,2) | (aff(mpidr,3) << 8) ;
+  }
+  uint64_t r = 0 ;
+  for (int k = lvl_system-1 ; k >= (int)l ; k--) r = (r << 16) | f[k] ;
+  return r ;
+}
+
+/* For each strategy, threads share the 'same' domain and differ at 'diff' */
+static const struct { lvl_t same, diff; const char *name; } strategy[place_max] = {
+  [place_any] = { lvl_system, lvl_thread, "any", },
+  [place_smt] = { lvl_core, lvl_thread, "smt", },
+  [place_cluster] = { lvl_cluster, lvl_core, "cluster", },
+  [place_xcluster] = { lvl_socket, lvl_cluster, "xcluster", },
+  [place_xsocket] = { lvl_system, lvl_socket, "xsocket", },
+};
+
+const char *place_name(place_t p) {
+  return p < place_max ? strategy[p].name : "?" ;
+}
+
+int place_parse(const char *s) {
+  int r = 0 ;
+  while (*s) {
+    int len = 0 ;
+    while (s[len] && s[len] != ',') len++ ;
+    if (len == 3 && strncmp(s,"all",3) == 0) {
+      r |= PLACE_ALL ;
+    } else {
+      int k ;
+      for (k = 0 ; k < place_max ; k++) {
+        const char *n = strategy[k].name ;
+        if ((int)strlen(n) == len && strncmp(s,n,len) == 0) break ;
+      }
+      if (k >= place_max) return -1 ;
+      r |= 1 << k ;
+    }
+    s += len ;
+    if (*s == ',') s++ ;
+  }
+  return r ;
+}
+
+/* Current placement */
+static int slot_of[NR_CPUS] ;
+static int cpu_of[NR_CPUS] ;
+
+/* Work arrays: representative PE of domain and of bucket, free PEs per bucket */
+static int dom[NR_CPUS], rep[NR_CPUS], nfree[NR_CPUS], used[NR_CPUS] ;
+
+static int rep_of(int cpu,lvl_t l,int mt) {
+  uint64_t id = topo_id(cpu,l,mt) ;
+  for (int k = 0 ; k < cpu ; k++) {
+    if (topo_id(k,l,mt) == id) return k ;
+  }
+  return cpu ;
+}
+
+int place_cpus(place_t p,int nthr,int ngroups) {
+  int mt = (read_sysreg(mpidr_el1) & MPIDR_MT) != 0 ;
+  lvl_t same = strategy[p].same, diff = strategy[p].diff ;
+  int pick[NR_CPUS] ;
+  int n = 0 ;
+
+  for (int c = 0 ; c < NR_CPUS ; c++) {
+    slot_of[c] = cpu_of[c] = -1 ;
+  }
+  if (nthr < 1 || nthr > nr_cpus) return 0 ;
+  for (int c = 0 ; c < nr_cpus ; c++) {
+    dom[c] = rep_of(c,same,mt) ;
+    rep[c] = rep_of(c,diff,mt) ;
+    nfree[c] = 0 ;
+    used[c] = 0 ;
+  }
+  for (int c = 0 ; c < nr_cpus ; c++) nfree[rep[c]]++ ;
+
+  /* Fill each domain in turn, taking one PE from the nthr fullest buckets */
+  for (int d = 0 ; d < nr_cpus && n < ngroups ; d++) {
+    if (dom[d] != d) continue ;
+    while (n < ngroups) {
+      int t ;
+      for (t = 0 ; t < nthr ; t++) {
+        int best = -1 ;
+        for (int c = d ; c < nr_cpus ; c++) {
+          if (dom[c] != d || used[c]) continue ;
+          int taken = 0 ;
+          for (int j = 0 ; j < t ; j++) taken |= rep[pick[j]] == rep[c] ;
+          if (taken) continue ;
+          if (best < 0 || nfree[rep[c]] > nfree[rep[best]]) best = c ;
+        }
+        if (best < 0) break ;
+        pick[t] = best ;
+        used[best] = 1 ;
+        nfree[rep[best]]-- ;
+      }
+      if (t < nthr) {
+        /* Domain exhausted, give back partial group */
+        for (int j = 0 ; j < t ; j++) {
+          used[pick[j]] = 0 ;
+          nfree[rep[pick[j]]]++ ;
+        }
+        break ;
+      }
+      for (t = 0 ; t < nthr ; t++) {
+        int slot = n*nthr+t ;
+        slot_of[pick[t]] = slot ;
+        cpu_of[slot] = pick[t] ;
+      }
+      n++ ;
+    }
+  }
+  return n ;
+}
+
+int place_avail(void) {
+  return nr_cpus < NR_CPUS ? nr_cpus : NR_CPUS ;
+}
+
+int place_slot(int cpu) {
+  return 0 <= cpu && cpu < NR_CPUS ? slot_of[cpu] : -1 ;
+}
+
+int place_cpu(int slot) {
+  return 0 <= slot && slot < NR_CPUS ? cpu_of[slot] : -1 ;
+}
+
+void place_pp(place_t p,int nthr,int ngroups,int verbose) {
+  printf("Placement %s: %d instance(s) of %d thread(s)",place_name(p),ngroups,nthr) ;
+  if (verbose) {
+    for (int k = 0 ; k < ngroups ; k++) {
+      printf(k == 0 ? ", PEs " : " ") ;
+      for (int t = 0 ; t < nthr ; t++) {
+        printf(t == 0 ? "[%d" : ",%d",cpu_of[k*nthr+t]) ;
+      }
+      printf("]") ;
+    }
+  }
+  printf("\n") ;
+}
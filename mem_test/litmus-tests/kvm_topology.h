@@ -0,0 +1,66 @@
+/** @file
+ * Copyright (c) 2024, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#ifndef _KVM_TOPOLOGY_H
+#define _KVM_TOPOLOGY_H 1
+
+/*
+  Thread placement.
+
+  A test instance runs its N_n threads on a group of PEs. A placement
+  strategy selects which PEs form a group, so that same-core, same-cluster,
+  cross-cluster and cross-socket interactions can be exercised on purpose.
+  Groups are disjoint, threads are numbered by 'slot': slot k runs thread
+  (k % nthr) of instance (k / nthr).
+*/
+
+typedef enum {
+  place_any,      /* First PEs, no topology constraint */
+  place_smt,      /* All threads on the same core */
+  place_cluster,  /* Same cluster, distinct cores */
+  place_xcluster, /* Same socket, distinct clusters */
+  place_xsocket,  /* Distinct sockets */
+  place_max,
+} place_t;
+
+#define PLACE_ALL ((1 << place_max)-1)
+
+const char *place_name(place_t p) ;
+
+/* Parse a comma separated list of strategy names, -1 on error */
+int place_parse(const char *s) ;
+
+/*
+  Compute groups of nthr PEs for strategy p, at most ngroups of them.
+  Returns the number of groups placed, 0 when the topology cannot
+  satisfy the strategy.
+*/
+int place_cpus(place_t p,int nthr,int ngroups) ;
+
+/* Number of PEs a placement can use, the default for -a */
+int place_avail(void) ;
+
+/* Slot of PE cpu in the current placement, -1 when not placed */
+int place_slot(int cpu) ;
+
+/* PE that runs slot in the current placement */
+int place_cpu(int slot) ;
+
+/* Dump current placement */
+void place_pp(place_t p,int nthr,int ngroups,int verbose) ;
+
+#endif
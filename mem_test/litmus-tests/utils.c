@@ -63,6 +63,14 @@ void *do_align(void *p,size_t sz) {
   return (void *)x ;
 }
 
+#ifdef KVM
+void *memalign_check(size_t align,size_t sz) {
+  void *r = memalign(align,sz) ;
+  if (!r) fatal("memalign");
+  return r ;
+}
+#endif
+
 #ifdef DYNALLOC
 void* malloc_check(size_t sz) {
   void *r = malloc(sz) ;
@@ -160,6 +168,46 @@ double tsc_millions(tsc_t t) {
 }
 #endif
 
+/**************/
+/* Statistics */
+/**************/
+
+static uint64_t isqrt(uint64_t x) {
+  uint64_t r = 0, b = (uint64_t)1 << 62 ;
+  while (b > x) b >>= 2 ;
+  while (b) {
+    if (x >= r+b) { x -= r+b ; r = (r >> 1)+b ; }
+    else r >>= 1 ;
+    b >>= 2 ;
+  }
+  return r ;
+}
+
+/*
+  Integer arithmetic only, with z=1.96 scaled by 100 and z^2 by 10000:
+  centre = (c+z^2/2)/(n+z^2), half = z*sqrt(c(n-c)/n+z^2/4)/(n+z^2)
+*/
+void wilson_ppm(uint64_t c,uint64_t n,uint64_t *lo,uint64_t *hi) {
+  if (n == 0) { *lo = 0 ; *hi = 1000000 ; return ; }
+  /* Keep all products within 64 bits, halving counts this large barely widens the interval */
+  while (n > ((uint64_t)1 << 32)) { c >>= 1 ; n >>= 1 ; }
+  uint64_t d = n*10000+38416 ;
+  uint64_t m = c*10000+19208 ;
+  uint64_t r = (m%d)*1000 ;
+  uint64_t centre = (m/d)*1000000 + (r/d)*1000 + ((r%d)*1000)/d ;
+  uint64_t q = c*(n-c) ;
+  uint64_t v = (q/n)*1000000 + ((q%n)*1000000)/n + 960400 ;
+  uint64_t half = (196*isqrt(v)*100000)/d ;
+  *lo = centre > half ? centre-half : 0 ;
+  *hi = centre+half < 1000000 ? centre+half : 1000000 ;
+}
+
+void pp_rate(uint64_t c,uint64_t n) {
+  uint64_t lo,hi ;
+  wilson_ppm(c,n,&lo,&hi) ;
+  printf("%7" PRIu64 "ppm [%" PRIu64 ",%" PRIu64 "]",n > 0 ? (c*1000000)/n : 0,lo,hi) ;
+}
+
 /**********/
 /* Pre-Si */
 /**********/
@@ -169,6 +217,9 @@ static void usage_opt(char *prog,opt_t *d) {
   fprintf(stderr,"%s","  -v      be verbose\n") ;
   fprintf(stderr,"%s","  -q      be quiet\n") ;
   fprintf(stderr,"  -a <n>  consider that <n> cores are available (default %d)\n",d->avail) ;
+#ifdef KVM
+  fprintf(stderr,"          up to all PEs, running <n>/threads instances in parallel\n") ;
+#endif
   fprintf(stderr,"  -n <n>  run n tests concurrently (default %d)\n",d->n_exe) ;
   fprintf(stderr,"  -r <n>  perform n external runs (default %d)\n",d->max_run) ;
   fprintf(stderr,"  -s <n>  perform n internal runs (default %d)\n",d->size_of_test) ;
@@ -176,6 +227,14 @@ static void usage_opt(char *prog,opt_t *d) {
     fprintf(stderr,"  -tb <n> time base delay  (default %d)\n",d->delay) ;
   }
   fprintf(stderr,"  +fix    do not shuffle threads\n");
+  fprintf(stderr,"  -t <n>  run for n seconds instead of a fixed number of runs\n") ;
+  fprintf(stderr,"  -c <n>  stop once outcome rates are known within n ppm (95%% confidence)\n") ;
+#ifdef KVM
+  fprintf(stderr,"%s","  -p <l>  thread placements, comma separated list of\n") ;
+  fprintf(stderr,"%s","          any,smt,cluster,xcluster,xsocket,all (default any)\n") ;
+#endif
+  fprintf(stderr,"%s","  -b <k>  barrier, one of sense,dissemination,tree,timebase (default sense)\n") ;
+  fprintf(stderr,"%s","  +bench  measure barrier latency and start skew before running tests\n") ;
   exit(2) ;
 }
 
@@ -220,8 +279,32 @@ char **parse_opt(int argc,char **argv,opt_t *d, opt_t *p) {
       if (!*argv) usage_opt(prog,d) ;
       p->delay = argint_opt(prog,argv[0],d) ;
       if (p->delay < 1) p->delay = 1 ;
+    } else if (strcmp(*argv,"-t") == 0) {
+      --argc ; ++argv ;
+      if (!*argv) usage_opt(prog,d) ;
+      p->budget = argint_opt(prog,argv[0],d) ;
+      if (p->budget < 0) p->budget = 0 ;
+    } else if (strcmp(*argv,"-c") == 0) {
+      --argc ; ++argv ;
+      if (!*argv) usage_opt(prog,d) ;
+      p->ci = argint_opt(prog,argv[0],d) ;
+      if (p->ci < 0) p->ci = 0 ;
     } else if (strcmp(*argv,"+fix") == 0) {
       p->fix = 1 ;
+    } else if (strcmp(*argv,"-b") == 0) {
+      --argc ; ++argv ;
+      if (!*argv) usage_opt(prog,d) ;
+      p->barrier = barrier_parse(argv[0]) ;
+      if (p->barrier < 0) usage_opt(prog,d) ;
+    } else if (strcmp(*argv,"+bench") == 0) {
+      p->bench = 1 ;
+#ifdef KVM
+    } else if (strcmp(*argv,"-p") == 0) {
+      --argc ; ++argv ;
+      if (!*argv) usage_opt(prog,d) ;
+      p->place = place_parse(argv[0]) ;
+      if (p->place <= 0) usage_opt(prog,d) ;
+#endif
     } else usage_opt(prog,d);
   }
 }
@@ -293,3 +376,7 @@ void interval_shuffle(st_t *seed,int *p,size_t sz) {
     p[j] = tmp ;
   }
 }
+
+void interval_shuffle_groups(st_t *seed,int *p,size_t sz,size_t n) {
+  for (size_t k=0 ; k+n <= sz ; k += n) interval_shuffle(seed,p+k,n) ;
+}
@@ -29,6 +29,12 @@ typedef void FILE;
 #define noinline __attribute__((noinline))
 #endif
 
+#include <asm/setup.h>
+#include "kvm_topology.h"
+
+/* Capacity in PEs, instances of a test can spread over all of them */
+#define AVAIL_MAX NR_CPUS
+
 #else
 #include <pthread.h>
 #include <string.h>
@@ -45,12 +51,20 @@ void errexit(const char *msg,int e) ;
 
 int max(int n,int m) ;
 
+/* Upper bound of cache line size, isolates per-thread data */
+#define CACHE_LINE_MAX 128
+
+#include "kvm_barrier.h"
+
 void *do_align(void *p, size_t sz) ;
 
-#ifdef DYNALLOC
 #ifdef KVM
 #include <alloc.h>
+/* Aligned allocation, fatal on failure */
+void *memalign_check(size_t align,size_t sz) ;
 #endif
+
+#ifdef DYNALLOC
 /* Dynamic memory allocation, KVM style */
 void *malloc_check(size_t sz) ;
 #endif
@@ -89,6 +103,19 @@ double tsc_millions(tsc_t t) ;
 #endif
 
 
+/**************/
+/* Statistics */
+/**************/
+
+/* Run count for time or confidence bounded tests */
+#define NRUNS_MAX 0x7fffffff
+
+/* 95% Wilson score interval of c outcomes out of n, in parts per million */
+void wilson_ppm(uint64_t c,uint64_t n,uint64_t *lo,uint64_t *hi) ;
+
+/* Dump rate of c outcomes out of n, with its confidence interval */
+void pp_rate(uint64_t c,uint64_t n) ;
+
 /**********/
 /* Pre-Si */
 /**********/
@@ -101,6 +128,11 @@ typedef struct {
   int n_exe ;
   int delay ;
   int fix ;
+  int place ; /* Mask of placement strategies, 0 for default */
+  int budget ; /* Time budget in seconds, 0 for fixed number of runs */
+  int ci ; /* Target confidence interval half-width in ppm, 0 for none */
+  int barrier ; /* Barrier kind, see kvm_barrier.h */
+  int bench ; /* Run barrier microbenchmark */
 } opt_t ;
 
 char **parse_opt(int argc,char **argv,opt_t *def, opt_t *p) ;
@@ -130,5 +162,7 @@ void munmap_exec(void *p,size_t sz) ;
 #include "litmus_rand.h"
 void interval_init(int *p,size_t sz) ;
 void interval_shuffle(st_t *seed,int *p,size_t sz) ;
+/* Shuffle inside consecutive groups of n elements */
+void interval_shuffle_groups(st_t *seed,int *p,size_t sz,size_t n) ;
 
 #endif
@@ -0,0 +1,183 @@
+/** @file
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "val/common/include/acs_val.h"
+#include "val/common/include/acs_pe.h"
+#include "val/common/include/acs_memory.h"
+#include "val/common/include/acs_mpam.h"
+#include "val/common/include/acs_mpam_reg.h"
+#include "val/mpam/include/mpam_val_interface.h"
+
+#define TEST_NUM   ACS_MPAM_CACHE_TEST_NUM_BASE + 8
+#define TEST_RULE  ""
+#define TEST_DESC  "Check CSU Occupancy Profile of LLC    "
+
+#define PARTITION_PERCENTAGE 50   // CPOR/CCAP limit of the test PARTID
+#define LIMIT_TOLERANCE      10   // Occupancy allowed above the limit, percent of LLC
+#define ACCURACY_PERCENTAGE  50   // Min occupancy for fills well within the limit
+
+/* Fill steps in percent of the LLC size */
+static const uint32_t fill_steps[] = {10, 25, 50, 75, 100, 125, 150};
+
+#define NUM_STEPS  (sizeof(fill_steps) / sizeof(fill_steps[0]))
+
+static void payload(void)
+{
+    uint32_t msc_node_cnt = val_mpam_get_msc_count();
+    uint32_t rsrc_node_cnt;
+    uint32_t msc_index;
+    uint32_t rsrc_index;
+    uint32_t llc_index;
+    uint32_t i;
+    uint32_t status;
+    uint32_t tested_cnt = 0;
+    uint16_t test_partid = 7; //Selecting distinct partid
+    uint64_t cache_identifier;
+    uint64_t cache_size;
+    uint64_t limit;
+    MPAM_CSU_POINT pt[NUM_STEPS];
+    uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
+
+    /* Get the Index for LLC */
+    llc_index = val_cache_get_llc_index();
+    if (llc_index == CACHE_TABLE_EMPTY) {
+        val_print(ACS_PRINT_ERR, "\n       Cache info table empty", 0);
+        val_set_status(index, RESULT_SKIP(TEST_NUM, 01));
+        return;
+    }
+
+    /* Get the cache identifier and size of LLC */
+    cache_identifier = val_cache_get_info(CACHE_ID, llc_index);
+    cache_size = val_cache_get_info(CACHE_SIZE, llc_index);
+    if ((cache_identifier == INVALID_CACHE_INFO) || (cache_size == INVALID_CACHE_INFO)) {
+        val_print(ACS_PRINT_ERR, "\n       LLC invalid in PPTT", 0);
+        val_set_status(index, RESULT_SKIP(TEST_NUM, 02));
+        return;
+    }
+
+    for (msc_index = 0; msc_index < msc_node_cnt; msc_index++)
+        test_partid = GET_MIN_VALUE(test_partid, val_mpam_get_max_partid(msc_index));
+
+    val_print(ACS_PRINT_DEBUG, "\n       Test PARTID = %d", test_partid);
+    val_print(ACS_PRINT_DEBUG, "\n       LLC Size = 0x%llx", cache_size);
+
+    /* occupancy allowed for the PARTID, with tolerance for replacement policy */
+    limit = cache_size * (PARTITION_PERCENTAGE + LIMIT_TOLERANCE) / 100;
+
+    for (msc_index = 0; msc_index < msc_node_cnt; msc_index++) {
+
+      rsrc_node_cnt = val_mpam_get_info(MPAM_MSC_RSRC_COUNT, msc_index, 0);
+      for (rsrc_index = 0; rsrc_index < rsrc_node_cnt; rsrc_index++) {
+
+        if (val_mpam_get_info(MPAM_MSC_RSRC_TYPE, msc_index, rsrc_index) != MPAM_RSRC_TYPE_PE_CACHE)
+          continue;
+
+        if (val_mpam_get_info(MPAM_MSC_RSRC_DESC1, msc_index, rsrc_index) != cache_identifier)
+          continue;
+
+        /* Select resource instance if RIS feature implemented */
+        if (val_mpam_msc_supports_ris(msc_index))
+          val_mpam_memory_configure_ris_sel(msc_index, rsrc_index);
+
+        if (!val_mpam_supports_csumon(msc_index))
+          continue;
+
+        /* Limit the PARTID with the cache partitioning the node supports */
+        if (val_mpam_supports_cpor(msc_index)) {
+          val_mpam_configure_cpor(msc_index, test_partid, PARTITION_PERCENTAGE);
+          if (val_mpam_supports_ccap(msc_index))
+            val_mpam_configure_ccap(msc_index, test_partid, SOFTLIMIT_DIS, 100);
+        }
+        else if (val_mpam_supports_ccap(msc_index))
+          val_mpam_configure_ccap(msc_index, test_partid, SOFTLIMIT_DIS, PARTITION_PERCENTAGE);
+        else
+          continue;
+
+        for (i = 0; i < NUM_STEPS; i++)
+          pt[i].fill_pct = fill_steps[i];
+
+        status = val_mpam_csu_profile(msc_index, llc_index, test_partid, DEFAULT_PMG,
+                                      pt, NUM_STEPS);
+
+        /* Restore the partitioning of the PARTID */
+        if (val_mpam_supports_cpor(msc_index))
+          val_mpam_configure_cpor(msc_index, test_partid, 100);
+        if (val_mpam_supports_ccap(msc_index))
+          val_mpam_configure_ccap(msc_index, test_partid, SOFTLIMIT_DIS, 100);
+
+        if (status == ACS_STATUS_SKIP)
+          continue;
+
+        if (status != ACS_STATUS_PASS) {
+          val_set_status(index, RESULT_FAIL(TEST_NUM, 01));
+          return;
+        }
+
+        for (i = 0; i < NUM_STEPS; i++) {
+          if (pt[i].flags & MPAM_SAMPLE_NRDY) {
+            val_print(ACS_PRINT_ERR, "\n       CSU monitor not ready, fill %d%%", pt[i].fill_pct);
+            val_set_status(index, RESULT_FAIL(TEST_NUM, 02));
+            return;
+          }
+
+          /* Occupancy must stay within the partition limit */
+          if (pt[i].csu > limit) {
+            val_print(ACS_PRINT_ERR, "\n       Occupancy above limit, fill %d%%", pt[i].fill_pct);
+            val_set_status(index, RESULT_FAIL(TEST_NUM, 03));
+            return;
+          }
+
+          /* Fills well within the limit must be visible to the monitor */
+          if ((pt[i].fill_pct * 2 <= PARTITION_PERCENTAGE) &&
+              (pt[i].csu < pt[i].buf_size * ACCURACY_PERCENTAGE / 100)) {
+            val_print(ACS_PRINT_ERR, "\n       Occupancy too low, fill %d%%", pt[i].fill_pct);
+            val_set_status(index, RESULT_FAIL(TEST_NUM, 04));
+            return;
+          }
+        }
+
+        tested_cnt++;
+      }
+    }
+
+    if (tested_cnt == 0) {
+        val_print(ACS_PRINT_DEBUG, "\n       No LLC node with CSU monitor and CPOR/CCAP", 0);
+        val_set_status(index, RESULT_SKIP(TEST_NUM, 03));
+        return;
+    }
+
+    val_set_status(index, RESULT_PASS(TEST_NUM, 01));
+    return;
+}
+
+uint32_t monitor005_entry(void)
+{
+    uint32_t status = ACS_STATUS_FAIL;
+    uint32_t num_pe = 1;
+
+    status = val_initialize_test(TEST_NUM, TEST_DESC, num_pe);
+
+    /* This check is when user is forcing us to skip this test */
+    if (status != ACS_STATUS_SKIP)
+        val_run_test_payload(TEST_NUM, num_pe, payload, 0);
+
+    /* get the result from all PE and check for failure */
+    status = val_check_for_error(TEST_NUM, num_pe, TEST_RULE);
+    val_report_status(0, ACS_END(TEST_NUM), TEST_RULE);
+
+    return status;
+}
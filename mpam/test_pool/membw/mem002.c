@@ -168,7 +168,8 @@ void static payload_secondary()
 
     /* Generate memory bandwidth contention via PE traffic */
     while (contend_flag) {
-        val_memcpy((void *)src_buf, (void *)dest_buf, buf_size);
+        val_mpam_mem_traffic(MPAM_TRAFFIC_COPY, (void *)src_buf, (void *)dest_buf, buf_size,
+                             MPAM_TRAFFIC_NON_TEMPORAL);
         val_data_cache_ops_by_va((addr_t)&contend_flag, INVALIDATE);
     }
 
@@ -372,7 +373,8 @@ payload_primary(void)
                 start_count = val_mpam_memory_mbwumon_read_count(msc_index);
                 val_print(ACS_PRINT_TEST, "\n       Start Count = 0x%llx", start_count);
                 /* perform memory operation */
-                val_memcpy((void *)src_buf, (void *)dest_buf, buf_size);
+                val_mpam_mem_traffic(MPAM_TRAFFIC_COPY, (void *)src_buf, (void *)dest_buf,
+                                     buf_size, 0);
 
                 end_count = val_mpam_memory_mbwumon_read_count(msc_index);
                 val_print(ACS_PRINT_TEST, "\n       End Count = 0x%llx", end_count);
@@ -427,7 +429,8 @@ payload_primary(void)
                 val_print(ACS_PRINT_TEST, "\n       Start Count = 0x%llx", start_count);
 
                 /* perform memory operation */
-                val_memcpy((void *)src_buf, (void *)dest_buf, buf_size);
+                val_mpam_mem_traffic(MPAM_TRAFFIC_COPY, (void *)src_buf, (void *)dest_buf,
+                                     buf_size, 0);
                 end_count = val_mpam_memory_mbwumon_read_count(msc_index);
                 val_print(ACS_PRINT_TEST, "\n       End Count = 0x%llx", end_count);
 
@@ -287,7 +287,7 @@ void payload(void)
                 val_print(ACS_PRINT_TEST, "\n        Start count is %llx", start_count);
 
                 /* perform memory operation */
-                val_memcpy(src_buf, dest_buf, buf_size);
+                val_mpam_mem_traffic(MPAM_TRAFFIC_COPY, src_buf, dest_buf, buf_size, 0);
 
                 while (nrdy_timeout) {
                     --nrdy_timeout;
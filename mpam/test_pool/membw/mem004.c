@@ -0,0 +1,164 @@
+/** @file
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "val/common/include/acs_val.h"
+#include "val/common/include/acs_pe.h"
+#include "val/common/include/acs_mpam.h"
+#include "val/common/include/acs_memory.h"
+#include "val/common/include/acs_mpam_reg.h"
+#include "val/mpam/include/mpam_val_interface.h"
+
+#define TEST_NUM   ACS_MPAM_MEMORY_TEST_NUM_BASE  +  4
+#define TEST_DESC  "Check MBWMAX Under Contention         "
+#define TEST_RULE  ""
+
+#define CONT_BUF_SIZE       SIZE_1G   // Per PE buffer size
+#define CONT_PE_PER_CLASS   2         // PEs generating traffic for each PARTID
+#define CONT_WINDOW_US      100000    // MBWU measurement window
+#define CONT_SAMPLE_US      5000      // MBWU timeline sampling period
+#define LIMITED_BW_PCT      10        // MBWMAX of the limited PARTID
+#define ISOLATION_MAX_PCT   75        // Max per PE share of limited vs reference PARTID
+
+static
+void payload(void)
+{
+
+    uint32_t pe_index;
+    uint32_t msc_index;
+    uint32_t rsrc_index;
+    uint32_t rsrc_node_cnt;
+    uint32_t status;
+    uint32_t tested_cnt = 0;
+    uint16_t minmax_partid;
+    uint16_t limited_partid;
+    uint32_t total_nodes = val_mpam_get_msc_count();
+    MPAM_CONT_CLASS cls[2];
+
+    pe_index = val_pe_get_index_mpid(val_pe_get_mpid());
+
+    /* Compute the min partition id supported among all MPAM nodes */
+    minmax_partid = DEFAULT_PARTID_MAX;
+    for (msc_index = 0; msc_index < total_nodes; msc_index++)
+        minmax_partid = GET_MIN_VALUE(minmax_partid, val_mpam_get_max_partid(msc_index));
+
+    if (minmax_partid == 0) {
+        val_print(ACS_PRINT_TEST, "\n       Test needs two PARTIDs", 0);
+        val_set_status(pe_index, RESULT_SKIP(TEST_NUM, 01));
+        return;
+    }
+    limited_partid = minmax_partid - 1;
+
+    for (msc_index = 0; msc_index < total_nodes; msc_index++) {
+
+        rsrc_node_cnt = val_mpam_get_info(MPAM_MSC_RSRC_COUNT, msc_index, 0);
+        for (rsrc_index = 0; rsrc_index < rsrc_node_cnt; rsrc_index++) {
+
+            if (val_mpam_get_info(MPAM_MSC_RSRC_TYPE, msc_index, rsrc_index)
+                                                            != MPAM_RSRC_TYPE_MEMORY)
+                continue;
+
+            /* Select Resource within an MSC */
+            if (val_mpam_msc_supports_ris(msc_index))
+                val_mpam_memory_configure_ris_sel(msc_index, rsrc_index);
+
+            if (!val_mpam_msc_supports_mbw_max(msc_index))
+                continue;
+
+            val_print(ACS_PRINT_DEBUG, "\n       msc index  = %d", msc_index);
+
+            /* Only MBWMAX partitioning differs between the two PARTIDs */
+            if (val_mpam_msc_supports_mbwpbm(msc_index)) {
+                val_mpam_configure_mbwpbm(msc_index, minmax_partid, 100);
+                val_mpam_configure_mbwpbm(msc_index, limited_partid, 100);
+            }
+            if (val_mpam_msc_supports_mbw_min(msc_index)) {
+                val_mpam_msc_configure_mbwmin(msc_index, minmax_partid, 0);
+                val_mpam_msc_configure_mbwmin(msc_index, limited_partid, 0);
+            }
+            val_mpam_msc_configure_mbwmax(msc_index, minmax_partid, HARDLIMIT_DIS, 100);
+            val_mpam_msc_configure_mbwmax(msc_index, limited_partid, HARDLIMIT_EN,
+                                          LIMITED_BW_PCT);
+
+            cls[0].partid = limited_partid;
+            cls[0].pmg = DEFAULT_PMG;
+            cls[0].num_pe = CONT_PE_PER_CLASS;
+            cls[0].mode = MPAM_TRAFFIC_COPY;
+            cls[1].partid = minmax_partid;
+            cls[1].pmg = DEFAULT_PMG;
+            cls[1].num_pe = CONT_PE_PER_CLASS;
+            cls[1].mode = MPAM_TRAFFIC_COPY;
+
+            val_mpam_contention_set_sampling(CONT_SAMPLE_US);
+            status = val_mpam_contention_run(msc_index, rsrc_index, cls, 2, CONT_BUF_SIZE,
+                                             CONT_WINDOW_US, TEST_NUM);
+            val_mpam_contention_set_sampling(0);
+
+            /* Restore MBWMAX partitioning of the limited PARTID */
+            val_mpam_msc_configure_mbwmax(msc_index, limited_partid, HARDLIMIT_DIS, 100);
+
+            if (status == ACS_STATUS_SKIP)
+                continue;
+
+            if (status != ACS_STATUS_PASS) {
+                val_print(ACS_PRINT_ERR, "\n       Contention run failed for msc_index : %d",
+                          msc_index);
+                val_set_status(pe_index, RESULT_FAIL(TEST_NUM, 01));
+                return;
+            }
+
+            if (val_mpam_contention_check_ratio(&cls[0], &cls[1], ISOLATION_MAX_PCT)
+                != ACS_STATUS_PASS) {
+                val_print(ACS_PRINT_ERR, "\n       MBWMAX not enforced for msc_index : %d",
+                          msc_index);
+                val_set_status(pe_index, RESULT_FAIL(TEST_NUM, 02));
+                return;
+            }
+
+            tested_cnt++;
+        }
+    }
+
+    if (tested_cnt == 0) {
+        val_print(ACS_PRINT_TEST,
+                  "\n       No MBWMAX memory node with enough PEs and MBWU monitors", 0);
+        val_set_status(pe_index, RESULT_SKIP(TEST_NUM, 02));
+        return;
+    }
+
+    val_set_status(pe_index, RESULT_PASS(TEST_NUM, 01));
+    return;
+}
+
+uint32_t
+mem004_entry(void)
+{
+
+    uint32_t status = ACS_STATUS_FAIL;
+    uint32_t num_pe = 1;
+
+    status = val_initialize_test(TEST_NUM, TEST_DESC, num_pe);
+
+    if (status != ACS_STATUS_SKIP)
+      val_run_test_payload(TEST_NUM, num_pe, payload, 0);
+
+    /* get the result from all PE and check for failure */
+    status = val_check_for_error(TEST_NUM, num_pe, TEST_RULE);
+
+    val_report_status(0, ACS_END(TEST_NUM), NULL);
+
+    return status;
+}
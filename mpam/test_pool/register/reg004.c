@@ -0,0 +1,127 @@
+/** @file
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "val/common/include/acs_val.h"
+#include "val/common/include/acs_pe.h"
+#include "val/common/include/acs_memory.h"
+#include "val/common/include/acs_mpam.h"
+#include "val/common/include/acs_mpam_reg.h"
+#include "val/mpam/include/mpam_val_interface.h"
+
+#define TEST_NUM   ACS_MPAM_REGISTER_TEST_NUM_BASE + 4
+#define TEST_RULE  ""
+#define TEST_DESC  "Check PARTID Configuration Sweep      "
+
+#define SWEEP_BURST_CNT   8         // PARTIDs exercised with traffic per configuration
+#define SWEEP_BURST_SIZE  SIZE_1M   // Traffic burst size
+
+/* Configurations swept over every PARTID, controls absent on a node are skipped */
+static const uint32_t sweep_list[][2] = {
+    {MPAM_SWEEP_CPOR,   25},
+    {MPAM_SWEEP_CPOR,   50},
+    {MPAM_SWEEP_CPOR,   100},
+    {MPAM_SWEEP_CCAP,   25},
+    {MPAM_SWEEP_CCAP,   50},
+    {MPAM_SWEEP_CCAP,   100},
+    {MPAM_SWEEP_MBWPBM, 25},
+    {MPAM_SWEEP_MBWPBM, 100},
+    {MPAM_SWEEP_MBWMAX, 25},
+    {MPAM_SWEEP_MBWMAX, 50},
+    {MPAM_SWEEP_MBWMAX, 100},
+    {MPAM_SWEEP_MBWMIN, 50}
+};
+
+#define NUM_SWEEP_CFG  (sizeof(sweep_list) / sizeof(sweep_list[0]))
+
+static void payload(void)
+{
+
+    uint32_t pe_index;
+    uint32_t msc_index;
+    uint32_t rsrc_index;
+    uint32_t rsrc_node_cnt;
+    uint32_t total_nodes;
+    uint32_t status;
+    uint32_t i;
+    uint32_t swept = 0;
+    uint32_t test_fail = 0;
+    MPAM_SWEEP_CFG cfg[NUM_SWEEP_CFG];
+
+    pe_index = val_pe_get_index_mpid(val_pe_get_mpid());
+
+    total_nodes = val_mpam_get_msc_count();
+
+    for (msc_index = 0; msc_index < total_nodes; msc_index++) {
+
+      rsrc_node_cnt = val_mpam_get_info(MPAM_MSC_RSRC_COUNT, msc_index, 0);
+      for (rsrc_index = 0; rsrc_index < rsrc_node_cnt; rsrc_index++) {
+
+        /* Select resource instance if RIS feature implemented */
+        if (val_mpam_msc_supports_ris(msc_index))
+          val_mpam_memory_configure_ris_sel(msc_index, rsrc_index);
+
+        for (i = 0; i < NUM_SWEEP_CFG; i++) {
+          cfg[i].ctrl = sweep_list[i][0];
+          cfg[i].pct = sweep_list[i][1];
+        }
+
+        status = val_mpam_partition_sweep(msc_index, rsrc_index, cfg, NUM_SWEEP_CFG,
+                                          SWEEP_BURST_CNT, SWEEP_BURST_SIZE);
+        if (status == ACS_STATUS_SKIP)
+          continue;
+
+        if (status != ACS_STATUS_PASS) {
+          val_print(ACS_PRINT_ERR, "\n       Inconsistent PARTID configuration, msc %d",
+                    msc_index);
+          test_fail++;
+        }
+
+        swept++;
+      }
+    }
+
+    if (swept == 0) {
+      val_print(ACS_PRINT_DEBUG, "\n       No MSC with partitioning controls", 0);
+      val_set_status(pe_index, RESULT_SKIP(TEST_NUM, 01));
+      return;
+    }
+
+    if (test_fail)
+      val_set_status(pe_index, RESULT_FAIL(TEST_NUM, 01));
+    else
+      val_set_status(pe_index, RESULT_PASS(TEST_NUM, 01));
+    return;
+}
+
+uint32_t reg004_entry(void)
+{
+
+    uint32_t status = ACS_STATUS_FAIL;
+    uint32_t num_pe = 1;
+
+    status = val_initialize_test(TEST_NUM, TEST_DESC, num_pe);
+
+    if (status != ACS_STATUS_SKIP)
+      val_run_test_payload(TEST_NUM, num_pe, payload, 0);
+
+    /* get the result from all PE and check for failure */
+    status = val_check_for_error(TEST_NUM, num_pe, TEST_RULE);
+
+    val_report_status(0, ACS_END(TEST_NUM), NULL);
+
+    return status;
+}
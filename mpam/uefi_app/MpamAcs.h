@@ -40,4 +40,5 @@
                                       /*[24 B Each + 8 B Header]*/
 #define PCC_INFO_TBL_SZ        262144 /*Supports maximum of 234 PCC info entries*/
                                       /*[112 B Each + 4B Header]*/
+#define TIMER_INFO_TBL_SZ      2048   /*Supports max 4 system timers*/
 #endif
@@ -44,6 +44,7 @@ UINT64  g_stack_pointer;
 UINT64  g_exception_ret_addr;
 UINT64  g_ret_addr;
 UINT32  g_print_mmio;
+UINT32  g_el1physkip = FALSE;
 UINT32  g_curr_module;
 UINT32  g_enable_module;
 UINT32  *g_execute_tests;
@@ -131,6 +132,17 @@ createSratInfoTable(
   val_srat_create_info_table(SratInfoTable);
 }
 
+VOID
+createTimerInfoTable(
+)
+{
+  UINT64 *TimerInfoTable;
+
+  TimerInfoTable = val_aligned_alloc(SIZE_4K, TIMER_INFO_TBL_SZ);
+
+  val_timer_create_info_table(TimerInfoTable);
+}
+
 VOID
 createPccInfoTable(
 )
@@ -163,6 +175,7 @@ FreeMpamAcsMem (
     val_hmat_free_info_table();
     val_srat_free_info_table();
     val_pcc_free_info_table();
+    val_timer_free_info_table();
     val_free_shared_mem();
 }
 
@@ -400,6 +413,9 @@ ShellAppMain (
 
     createCacheInfoTable();
 
+    /* bounds the PCC command complete wait */
+    createTimerInfoTable();
+
     /* required before calling createMpamInfoTable() */
     createPccInfoTable();
 
@@ -233,6 +233,9 @@ pal_iovirt_create_info_table(IOVIRT_INFO_TABLE *IoVirtTable)
           case IOVIRT_NODE_SMMU_V3:
              block->data.smmu.base = platform_node_type.smmu[k].base;
              block->data.smmu.arch_major_rev = 3;
+             /* SMMU interrupts are not described by the platform config */
+             block->data.smmu.event_gsiv = 0;
+             block->data.smmu.gerr_gsiv = 0;
              block->num_data_map = platform_iovirt_cfg.num_map[i];
              IoVirtTable->num_smmus++;
              k++;
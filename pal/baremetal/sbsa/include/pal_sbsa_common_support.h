@@ -324,6 +324,13 @@ typedef struct {
   uint64_t                         cmd_complete_update_preserve;
                                                             /* command complete update preserve */
   uint64_t                         cmd_complete_update_set; /* command complete update set mask */
+  GENERIC_ADDRESS_STRUCTURE        error_status_reg;        /* error status register */
+  uint64_t                         error_status_mask;       /* error status mask */
+  uint32_t                         platform_intr;           /* platform interrupt GSIV, 0 if none */
+  GENERIC_ADDRESS_STRUCTURE        platform_intr_ack_reg;   /* platform interrupt ack register */
+  uint64_t                         platform_intr_ack_preserve;
+                                                            /* platform interrupt ack preserve */
+  uint64_t                         platform_intr_ack_set;   /* platform interrupt ack set mask */
 } PCC_SUBSPACE_TYPE_3;
 
 typedef union {
@@ -127,6 +127,11 @@ pal_pcc_create_info_table(PCC_INFO_TABLE *PccInfoTable)
           = platform_pcc_cfg.pcc_info[i].type_spec_info.pcc_ss_type_3.doorbell_write;
         curr_entry->type_spec_info.pcc_ss_type_3.min_req_turnaround_usec
           = platform_pcc_cfg.pcc_info[i].type_spec_info.pcc_ss_type_3.min_req_turnaround_usec;
+        /* no error status register, command completion is the only status */
+        curr_entry->type_spec_info.pcc_ss_type_3.error_status_reg.addr = 0;
+        curr_entry->type_spec_info.pcc_ss_type_3.error_status_mask = 0;
+        /* no platform interrupt, command completion is polled */
+        curr_entry->type_spec_info.pcc_ss_type_3.platform_intr = 0;
     }
     curr_entry++;
    }
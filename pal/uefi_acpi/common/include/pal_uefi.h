@@ -620,6 +620,15 @@ typedef struct {
   UINT64                            cmd_complete_update_preserve;
                                                              /* command complete update preserve */
   UINT64                            cmd_complete_update_set; /* command complete update set mask */
+  EFI_ACPI_6_5_GENERIC_ADDRESS_STRUCTURE
+                                    error_status_reg;        /* error status register */
+  UINT64                            error_status_mask;       /* error status mask */
+  UINT32                            platform_intr;           /* platform interrupt GSIV, 0 if none */
+  EFI_ACPI_6_5_GENERIC_ADDRESS_STRUCTURE
+                                    platform_intr_ack_reg;   /* platform interrupt ack register */
+  UINT64                            platform_intr_ack_preserve;
+                                                             /* platform interrupt ack preserve */
+  UINT64                            platform_intr_ack_set;   /* platform interrupt ack set mask */
 } PCC_SUBSPACE_TYPE_3;
 
 typedef union {
@@ -109,6 +109,20 @@ pal_pcc_store_info(UINT32 subspace_idx)
         ptr_to_pcc_ss_type_3->doorbell_write            =  pcct_type_3->DoorbellWrite;
         ptr_to_pcc_ss_type_3->cmd_complete_chk_mask     =  pcct_type_3->CommandCompleteCheckMask;
         ptr_to_pcc_ss_type_3->cmd_complete_update_set   =  pcct_type_3->CommandCompleteUpdateSet;
+        ptr_to_pcc_ss_type_3->error_status_reg          =  pcct_type_3->ErrorStatusRegister;
+        ptr_to_pcc_ss_type_3->error_status_mask         =  pcct_type_3->ErrorStatusMask;
+
+        /* platform interrupt is only valid when PCCT flags report it */
+        if (pcct->Flags & EFI_ACPI_6_5_PCCT_FLAGS_PLATFORM_INTERRUPT) {
+            ptr_to_pcc_ss_type_3->platform_intr         =  pcct_type_3->PlatformInterrupt;
+            ptr_to_pcc_ss_type_3->platform_intr_ack_reg
+                        = pcct_type_3->PlatformInterruptAckRegister;
+            ptr_to_pcc_ss_type_3->platform_intr_ack_preserve
+                                            =  pcct_type_3->PlatformInterruptAckPreserve;
+            ptr_to_pcc_ss_type_3->platform_intr_ack_set =  pcct_type_3->PlatformInterruptAckSet;
+        } else {
+            ptr_to_pcc_ss_type_3->platform_intr         =  0;
+        }
         g_pcc_info_table->subspace_cnt++;
 
         break;
@@ -308,6 +308,8 @@ iort_add_block(IORT_TABLE *iort, IORT_NODE *iort_node, IOVIRT_INFO_TABLE *IoVirt
     case IOVIRT_NODE_SMMU_V3:
       (*data).smmu.base = ((IORT_SMMU *)node_data)->base_address;
       (*data).smmu.arch_major_rev = 3;
+      (*data).smmu.event_gsiv = ((IORT_SMMU_V3 *)node_data)->event_gsiv;
+      (*data).smmu.gerr_gsiv = ((IORT_SMMU_V3 *)node_data)->gerr_gsiv;
       count = &IoVirtTable->num_smmus;
       break;
     case IOVIRT_NODE_PMCG:
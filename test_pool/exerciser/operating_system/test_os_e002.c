@@ -110,6 +110,7 @@ create_va_pa_mapping (uint64_t txn_va, uint64_t txn_pa,
   master = *smmu_master;
 
   val_memory_set(&master, sizeof(master), 0);
+  val_memory_set(pgt_desc, sizeof(*pgt_desc), 0);
   val_memory_set(mem_desc_array, sizeof(mem_desc_array), 0);
   mem_desc = &mem_desc_array[0];
 
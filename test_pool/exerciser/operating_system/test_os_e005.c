@@ -66,6 +66,32 @@ clear_dram_buf(void *buf, uint32_t size)
   val_pe_cache_clean_invalidate_range((uint64_t)buf, (uint64_t)size);
 }
 
+/*
+ * Drain the SMMU event queue and return 1 if the exerciser stream raised any
+ * event since the counters were cleared.
+ */
+static
+uint32_t
+check_smmu_events(smmu_master_attributes_t *master)
+{
+  smmu_event_t evt;
+
+  if (val_smmu_evtq_drain(master->smmu_index, &evt, 1) == 0)
+      return 0;
+
+  if (val_smmu_evtq_get_count(master->smmu_index, master->streamid, SMMU_EVT_ANY) == 0)
+      return 0;
+
+  val_print(ACS_PRINT_ERR, "\n       SMMU events for PASID 0x%x", master->substreamid);
+  val_print(ACS_PRINT_ERR, " : %d",
+            val_smmu_evtq_get_count(master->smmu_index, master->streamid, SMMU_EVT_ANY));
+  val_print(ACS_PRINT_ERR, ", translation faults %d",
+            val_smmu_evtq_get_count(master->smmu_index, master->streamid,
+                                    SMMU_EVT_F_TRANSLATION));
+  val_print(ACS_PRINT_ERR, ", first event 0x%x", evt.id);
+  return 1;
+}
+
 /*
  * For each exerciser behind an SMMU,
  * Create a mapping of 1 IOVA region to 2 PA regions, via SMMU
@@ -109,6 +135,7 @@ payload(void)
 
   /* Initialize DMA master and memory descriptors */
   val_memory_set(&master, sizeof(master), 0);
+  val_memory_set(&pgt_desc, sizeof(pgt_desc), 0);
   val_memory_set(mem_desc_array, sizeof(mem_desc_array), 0);
   mem_desc = &mem_desc_array[0];
   e_valid_cnt = 0;
@@ -270,6 +297,10 @@ payload(void)
 
         dram_buf_in_iova = mem_desc->virtual_address;
         dram_buf_out_iova = dram_buf_in_iova + (test_data_blk_size / 2);
+
+        /* Start counting SMMU events from a drained queue */
+        val_smmu_evtq_drain(master.smmu_index, NULL, 0);
+        val_smmu_evtq_clear_stats(master.smmu_index);
     }
 
     write_test_data(dram_buf_pasid1_in_virt, dma_len);
@@ -300,6 +331,9 @@ payload(void)
     /* Trigger DMA from exerciser memory to output buffer*/
     val_exerciser_ops(START_DMA, EDMA_FROM_DEVICE, instance);
 
+    if (check_smmu_events(&master))
+        goto test_fail;
+
     if (val_memory_compare(dram_buf_pasid1_in_virt, dram_buf_pasid1_out_virt, dma_len)) {
         val_print(ACS_PRINT_ERR, "\n       Data Comparision failure for Exerciser %4x", instance);
         goto test_fail;
@@ -380,13 +414,29 @@ payload(void)
         goto test_fail;
     }
 
+    if (check_smmu_events(&master))
+        goto test_fail;
+
     if (val_memory_compare(dram_buf_pasid2_in_virt, dram_buf_pasid2_out_virt, dma_len)) {
         val_print(ACS_PRINT_ERR, "\n       Data Comparison failure for Exerciser %4x", instance);
         goto test_fail;
     }
 
+    val_print(ACS_PRINT_DEBUG, "\n       SMMU stream table memory 0x%llx bytes",
+              val_smmu_get_info(SMMU_STRTAB_MEM_SIZE, master.smmu_index));
+    val_print(ACS_PRINT_DEBUG, "\n       SMMU CD table blocks allocated %lld",
+              val_smmu_get_info(SMMU_CDTAB_POOL_ALLOCS, master.smmu_index));
+
     val_smmu_unmap(master);
     val_smmu_disable(master.smmu_index);
+
+    /* Release both pasid tables, the next exerciser builds its own */
+    pgt_desc.pgt_base = pgt_base_pasid1;
+    val_pgt_destroy(pgt_desc);
+    pgt_base_pasid1 = 0;
+    pgt_desc.pgt_base = pgt_base_pasid2;
+    val_pgt_destroy(pgt_desc);
+    pgt_base_pasid2 = 0;
   }
   if (e_valid_cnt) {
     val_set_status(pe_index, RESULT_PASS (TEST_NUM, 1));
@@ -400,8 +450,14 @@ test_fail:
 
 test_clean:
   val_memory_free_pages(dram_buf_base_virt, TEST_DATA_NUM_PAGES * 2);
-  if ((pgt_base_pasid1 != 0) || (pgt_base_pasid2 != 0))
+  if (pgt_base_pasid1 != 0)
+  {
+    pgt_desc.pgt_base = pgt_base_pasid1;
+    val_pgt_destroy(pgt_desc);
+  }
+  if (pgt_base_pasid2 != 0)
   {
+    pgt_desc.pgt_base = pgt_base_pasid2;
     val_pgt_destroy(pgt_desc);
   }
 }
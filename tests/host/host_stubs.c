@@ -0,0 +1,230 @@
+/** @file
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include <stdarg.h>
+
+#include "host_stubs.h"
+#include "common/include/acs_pe.h"
+
+uint32_t host_page_size = 0x1000;
+int64_t  host_allocs_live;
+int64_t  host_pages_live;
+int64_t  host_pages_fail_after = -1;
+uint64_t host_delay_us;
+uint32_t host_failures;
+uint32_t host_tlbi_count;
+
+uint32_t (*host_mmio_read_hook)(addr_t addr);
+void (*host_mmio_write_hook)(addr_t addr, uint64_t data, uint32_t size);
+
+uint32_t g_num_smmus;
+
+uint32_t host_gic_fail_intid;
+
+#define HOST_GIC_ISR_MAX 16
+
+static struct {
+    uint32_t int_id;
+    void (*isr)(void);
+} host_gic_isr_table[HOST_GIC_ISR_MAX];
+
+void val_print(uint32_t level, char8_t *string, uint64_t data)
+{
+    if (getenv("HOST_VERBOSE") && (level >= ACS_PRINT_DEBUG))
+        printf(string, data);
+}
+
+void *val_memory_alloc(uint32_t size)
+{
+    void *p = malloc(size);
+
+    if (p)
+        host_allocs_live++;
+    return p;
+}
+
+void *val_memory_calloc(uint32_t num, uint32_t size)
+{
+    void *p = calloc(num, size);
+
+    if (p)
+        host_allocs_live++;
+    return p;
+}
+
+void val_memory_free(void *addr)
+{
+    if (addr)
+        host_allocs_live--;
+    free(addr);
+}
+
+void val_memory_set(void *buf, uint32_t size, uint8_t value)
+{
+    memset(buf, value, size);
+}
+
+void *val_memcpy(void *dest_buffer, void *src_buffer, uint32_t len)
+{
+    return memcpy(dest_buffer, src_buffer, len);
+}
+
+void *val_memory_virt_to_phys(void *va)
+{
+    return va;
+}
+
+void *val_memory_phys_to_virt(uint64_t pa)
+{
+    return (void *)pa;
+}
+
+uint32_t val_memory_page_size(void)
+{
+    return host_page_size;
+}
+
+void *val_memory_alloc_pages(uint32_t num_pages)
+{
+    void *p;
+
+    if (host_pages_fail_after == 0)
+        return NULL;
+    if (host_pages_fail_after > 0)
+        host_pages_fail_after--;
+
+    p = aligned_alloc(host_page_size, (size_t)num_pages * host_page_size);
+
+    if (p)
+        host_pages_live += num_pages;
+    return p;
+}
+
+void val_memory_free_pages(void *page_base, uint32_t num_pages)
+{
+    if (page_base)
+        host_pages_live -= num_pages;
+    free(page_base);
+}
+
+uint32_t val_mmio_read(addr_t addr)
+{
+    if (host_mmio_read_hook)
+        return host_mmio_read_hook(addr);
+    return *(volatile uint32_t *)addr;
+}
+
+uint64_t val_mmio_read64(addr_t addr)
+{
+    return *(volatile uint64_t *)addr;
+}
+
+void val_mmio_write(addr_t addr, uint32_t data)
+{
+    if (host_mmio_write_hook)
+        host_mmio_write_hook(addr, data, 4);
+    else
+        *(volatile uint32_t *)addr = data;
+}
+
+void val_mmio_write64(addr_t addr, uint64_t data)
+{
+    if (host_mmio_write_hook)
+        host_mmio_write_hook(addr, data, 8);
+    else
+        *(volatile uint64_t *)addr = data;
+}
+
+uint64_t val_time_delay_ms(uint64_t time_ms)
+{
+    /* The PAL delay takes microseconds */
+    host_delay_us += time_ms;
+    return 0;
+}
+
+void ArmExecuteMemoryBarrier(void)
+{
+    __sync_synchronize();
+}
+
+void val_mem_issue_dsb(void)
+{
+    __sync_synchronize();
+}
+
+void val_mem_issue_tlbi(void)
+{
+    host_tlbi_count++;
+    __sync_synchronize();
+}
+
+uint64_t val_pe_get_mpid(void)
+{
+    return 0;
+}
+
+uint32_t val_gic_install_isr(uint32_t int_id, void (*isr)(void))
+{
+    uint32_t i;
+
+    if (int_id == host_gic_fail_intid)
+        return 1;
+
+    for (i = 0; i < HOST_GIC_ISR_MAX; i++) {
+        if ((host_gic_isr_table[i].isr == NULL) || (host_gic_isr_table[i].int_id == int_id)) {
+            host_gic_isr_table[i].int_id = int_id;
+            host_gic_isr_table[i].isr = isr;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void (*host_gic_isr(uint32_t int_id))(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < HOST_GIC_ISR_MAX; i++) {
+        if ((host_gic_isr_table[i].isr != NULL) && (host_gic_isr_table[i].int_id == int_id))
+            return host_gic_isr_table[i].isr;
+    }
+    return NULL;
+}
+
+uint32_t val_gic_route_interrupt_to_pe(uint32_t int_id, uint64_t mpidr)
+{
+    (void)int_id;
+    (void)mpidr;
+    return 0;
+}
+
+uint32_t val_gic_end_of_interrupt(uint32_t int_id)
+{
+    (void)int_id;
+    return 0;
+}
+
+void val_gic_free_irq(uint32_t irq_num, uint32_t mapped_irq_num)
+{
+    uint32_t i;
+
+    (void)mapped_irq_num;
+    for (i = 0; i < HOST_GIC_ISR_MAX; i++) {
+        if (host_gic_isr_table[i].int_id == irq_num)
+            host_gic_isr_table[i].isr = NULL;
+    }
+}
@@ -0,0 +1,54 @@
+/** @file
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __HOST_STUBS_H__
+#define __HOST_STUBS_H__
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common/include/acs_val.h"
+#include "common/include/acs_common.h"
+#include "common/include/acs_memory.h"
+#include "common/include/val_interface.h"
+
+/* Host replacements for the VAL services used by the code under test */
+extern uint32_t host_page_size;
+extern int64_t  host_allocs_live;
+extern int64_t  host_pages_live;
+extern int64_t  host_pages_fail_after;  /* page allocations left before failing, -1 never */
+extern uint64_t host_delay_us;
+extern uint32_t host_failures;
+extern uint32_t host_tlbi_count;        /* TLB invalidations issued */
+
+/* MMIO accesses go to plain memory unless a device model installs hooks */
+extern uint32_t (*host_mmio_read_hook)(addr_t addr);
+extern void (*host_mmio_write_hook)(addr_t addr, uint64_t data, uint32_t size);
+
+/* Handlers installed with val_gic_install_isr, installing host_gic_fail_intid fails */
+extern uint32_t host_gic_fail_intid;
+void (*host_gic_isr(uint32_t int_id))(void);
+
+#define HOST_CHECK(cond)                                                    \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            host_failures++;                                                \
+        }                                                                   \
+    } while (0)
+
+#endif /* __HOST_STUBS_H__ */
@@ -0,0 +1,205 @@
+/** @file
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include <time.h>
+
+#include "host_stubs.h"
+#include "val/common/src/acs_mpam.c"
+
+/* Synthetic platform: MSCs with 1 to 4 resources each, one register page per MSC */
+#define HOST_MSC_COUNT     512
+#define HOST_MSC_REG_SIZE  0x1000
+
+static uint8_t *host_msc_regs;
+
+static uint32_t host_msc_rsrc_count(uint32_t i)
+{
+    return 1 + (i % 4);
+}
+
+static uint32_t host_mpam_table_size(void)
+{
+    uint32_t i, size = sizeof(MPAM_INFO_TABLE);
+
+    for (i = 0; i < HOST_MSC_COUNT; i++)
+        size += sizeof(MPAM_MSC_NODE) + host_msc_rsrc_count(i) * sizeof(MPAM_RESOURCE_NODE);
+    return size;
+}
+
+void pal_mpam_create_info_table(MPAM_INFO_TABLE *MpamTable)
+{
+    MPAM_MSC_NODE *msc = &MpamTable->msc_node[0];
+    uint32_t i, r;
+
+    MpamTable->msc_count = HOST_MSC_COUNT;
+    for (i = 0; i < HOST_MSC_COUNT; i++, msc = MPAM_NEXT_MSC(msc)) {
+        msc->intrf_type = MPAM_INTERFACE_TYPE_MMIO;
+        msc->identifier = 0x1000 + i;
+        msc->msc_base_addr = (uint64_t)(host_msc_regs + (uint64_t)i * HOST_MSC_REG_SIZE);
+        msc->msc_addr_len = HOST_MSC_REG_SIZE;
+        msc->max_nrdy = i;
+        msc->rsrc_count = host_msc_rsrc_count(i);
+        for (r = 0; r < msc->rsrc_count; r++) {
+            msc->rsrc_node[r].ris_index = r;
+            msc->rsrc_node[r].locator_type = (i + r) % 5;
+            msc->rsrc_node[r].descriptor1 = ((uint64_t)i << 8) | r;
+        }
+    }
+}
+
+void pal_mem_free_aligned(void *buffer)
+{
+    free(buffer);
+}
+
+uint32_t val_mmu_update_entry(uint64_t address, uint32_t size)
+{
+    (void)address;
+    (void)size;
+    return 0;
+}
+
+/* Not reached by the MMIO MSCs of the synthetic table */
+void *val_pcc_cmd_response(uint32_t subspace_id, uint32_t command, void *data, uint32_t data_size)
+{
+    (void)subspace_id;
+    (void)command;
+    (void)data;
+    (void)data_size;
+    return NULL;
+}
+
+void pal_hmat_create_info_table(HMAT_INFO_TABLE *HmatTable) { (void)HmatTable; }
+void pal_srat_create_info_table(SRAT_INFO_TABLE *SratTable) { (void)SratTable; }
+void *pal_mem_alloc_at_address(uint64_t mem_base, uint64_t size)
+{
+    (void)mem_base;
+    (void)size;
+    return NULL;
+}
+void pal_mem_free_at_address(uint64_t mem_base, uint64_t size) { (void)mem_base; (void)size; }
+void pal_pe_data_cache_ops_by_va(uint64_t addr, uint32_t type) { (void)addr; (void)type; }
+uint32_t val_pe_get_index_mpid(uint64_t mpid) { (void)mpid; return 0; }
+void val_report_status(uint32_t id, uint32_t status, char8_t *ruleid)
+{
+    (void)id;
+    (void)status;
+    (void)ruleid;
+}
+uint64_t ArmArchTimerReadReg(ARM_ARCH_TIMER_REGS Reg) { (void)Reg; return 0; }
+uint64_t AA64ReadMpamidr(void) { return 0; }
+uint64_t AA64ReadMpam1(void) { return 0; }
+uint64_t AA64ReadMpam2(void) { return 0; }
+void AA64WriteMpam1(uint64_t write_data) { (void)write_data; }
+void AA64WriteMpam2(uint64_t write_data) { (void)write_data; }
+void AA64MemTrafficCopy(void *dst, void *src, uint64_t len, uint64_t non_temporal)
+{
+    (void)non_temporal;
+    memcpy(dst, src, len);
+}
+uint64_t AA64MemTrafficRead(void *src, uint64_t len, uint64_t non_temporal)
+{
+    (void)src;
+    (void)non_temporal;
+    return len;
+}
+void AA64MemTrafficWrite(void *dst, uint64_t len, uint64_t pattern, uint64_t non_temporal)
+{
+    (void)non_temporal;
+    memset(dst, (int)pattern, len);
+}
+
+static uint64_t host_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* Time a sweep of MSC base and resource lookups, in ns per lookup */
+static uint64_t host_lookup_sweep(uint32_t reps, uint64_t *sum)
+{
+    uint64_t start = host_now_ns();
+    uint32_t rep, i;
+
+    for (rep = 0; rep < reps; rep++) {
+        for (i = 0; i < HOST_MSC_COUNT; i++) {
+            *sum += val_mpam_get_info(MPAM_MSC_BASE_ADDR, i, 0);
+            *sum += val_mpam_get_info(MPAM_MSC_RSRC_DESC1, i, host_msc_rsrc_count(i) - 1);
+        }
+    }
+
+    return (host_now_ns() - start) / ((uint64_t)reps * HOST_MSC_COUNT * 2);
+}
+
+/* Every getter agrees with the synthetic table, the index gives the same answers as the walk */
+static void test_msc_discovery(void)
+{
+    uint64_t *table, indexed_ns, walked_ns, sum_indexed = 0, sum_walked = 0;
+    MPAM_MSC_NODE **index;
+    uint32_t i, r;
+
+    host_msc_regs = calloc(HOST_MSC_COUNT, HOST_MSC_REG_SIZE);
+    table = calloc(1, host_mpam_table_size());
+    for (i = 0; i < HOST_MSC_COUNT; i++)
+        *(uint32_t *)(host_msc_regs + (uint64_t)i * HOST_MSC_REG_SIZE + REG_MPAMF_AIDR) = i;
+
+    val_mpam_create_info_table(table);
+    HOST_CHECK(val_mpam_get_msc_count() == HOST_MSC_COUNT);
+    HOST_CHECK(g_mpam_msc_index != NULL);
+
+    for (i = 0; i < HOST_MSC_COUNT && !host_failures; i++) {
+        HOST_CHECK(val_mpam_get_info(MPAM_MSC_ID, i, 0) == 0x1000 + i);
+        HOST_CHECK(val_mpam_get_info(MPAM_MSC_NRDY, i, 0) == i);
+        HOST_CHECK(val_mpam_get_info(MPAM_MSC_RSRC_COUNT, i, 0) == host_msc_rsrc_count(i));
+        for (r = 0; r < host_msc_rsrc_count(i); r++) {
+            HOST_CHECK(val_mpam_get_info(MPAM_MSC_RSRC_RIS, i, r) == r);
+            HOST_CHECK(val_mpam_get_info(MPAM_MSC_RSRC_TYPE, i, r) == (i + r) % 5);
+            HOST_CHECK(val_mpam_get_info(MPAM_MSC_RSRC_DESC1, i, r) == (((uint64_t)i << 8) | r));
+        }
+        HOST_CHECK(val_mpam_get_info(MPAM_MSC_RSRC_RIS, i, r) == MPAM_INVALID_INFO);
+        HOST_CHECK(val_mpam_mmr_read(i, REG_MPAMF_AIDR) == i);
+    }
+
+    /* Out of range MSC indexes are rejected before any lookup */
+    HOST_CHECK(val_mpam_get_info(MPAM_MSC_BASE_ADDR, HOST_MSC_COUNT, 0) == 0);
+
+    /* Same sweep through the index and through the table walk fallback */
+    indexed_ns = host_lookup_sweep(200, &sum_indexed);
+    index = g_mpam_msc_index;
+    g_mpam_msc_index = NULL;
+    walked_ns = host_lookup_sweep(20, &sum_walked);
+    g_mpam_msc_index = index;
+    HOST_CHECK(sum_indexed == 10 * sum_walked);
+    HOST_CHECK(indexed_ns < walked_ns);
+    printf("  mpam msc lookup: %u MSCs, %llu ns indexed, %llu ns walked\n", HOST_MSC_COUNT,
+           (unsigned long long)indexed_ns, (unsigned long long)walked_ns);
+
+    val_mpam_free_info_table();
+    HOST_CHECK(g_mpam_msc_index == NULL);
+    HOST_CHECK(host_allocs_live == 0);
+    free(host_msc_regs);
+}
+
+int main(void)
+{
+    test_msc_discovery();
+
+    printf("test_mpam: %s\n", host_failures ? "FAILED" : "PASSED");
+    return host_failures ? 1 : 0;
+}
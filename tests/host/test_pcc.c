@@ -0,0 +1,376 @@
+/** @file
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "host_stubs.h"
+#include "val/common/src/acs_pcc.c"
+
+/* PCC type 3 subspace model: a shared memory region and four registers. The platform
+   completes a command host_pcc_latency ticks after the doorbell, and echoes the first
+   word of the parameters incremented by one. Time is the generic counter, which moves
+   by one tick per read, or the host delay when CNTFRQ reads as zero. */
+#define HOST_PCC_SS_ID       5
+#define HOST_PCC_SHMEM_SIZE  0x1000
+#define HOST_PCC_NEVER       (~0ull)
+
+enum { HOST_PCC_DOORBELL, HOST_PCC_CMD_COMPLETE, HOST_PCC_ERROR, HOST_PCC_INTR_ACK,
+       HOST_PCC_NUM_REGS };
+
+static uint64_t host_pcc_shmem[HOST_PCC_SHMEM_SIZE / 8];
+static uint32_t host_pcc_regs[HOST_PCC_NUM_REGS];
+
+static uint64_t host_cntfrq = 1000000;
+static uint64_t host_cntpct;
+static uint64_t host_pcc_latency;
+static uint64_t host_pcc_done_at = HOST_PCC_NEVER;
+static uint32_t host_pcc_fail_cmd;     /* complete the next command with an error */
+static uint32_t host_pcc_doorbells;
+static uint32_t host_pcc_polls;
+static uint32_t host_pcc_turnaround = 1000;
+static uint32_t host_pcc_intr;         /* subspace signals completion by interrupt */
+static uint32_t host_pcc_irq_pending;
+static uint32_t host_pcc_wfis;
+
+/* EL1 physical timer, as armed by val_timer_set_phy_el1 */
+#define HOST_TIMER_INTID     30
+static uint64_t host_timer_at = HOST_PCC_NEVER;
+
+uint32_t g_el1physkip;
+
+static uint64_t host_pcc_now(void)
+{
+    return host_cntfrq ? host_cntpct : host_delay_us;
+}
+
+static int host_pcc_reg(addr_t addr)
+{
+    if ((addr < (addr_t)host_pcc_regs) || (addr >= (addr_t)&host_pcc_regs[HOST_PCC_NUM_REGS]))
+        return -1;
+    return (uint32_t *)addr - host_pcc_regs;
+}
+
+/* The platform side of a doorbell, run once the command latency has elapsed */
+static void host_pcc_complete(void)
+{
+    uint32_t *comm = (uint32_t *)((uint8_t *)host_pcc_shmem + PCC_TY3_COMM_SPACE);
+
+    host_pcc_done_at = HOST_PCC_NEVER;
+    comm[0]++;
+    host_pcc_regs[HOST_PCC_ERROR] = host_pcc_fail_cmd ? 0x1 : 0;
+    host_pcc_fail_cmd = 0;
+    host_pcc_regs[HOST_PCC_CMD_COMPLETE] |= 0x1;
+    if (host_pcc_intr)
+        host_pcc_irq_pending = 1;
+}
+
+static uint32_t host_pcc_read(addr_t addr)
+{
+    int reg = host_pcc_reg(addr);
+
+    if (reg < 0)
+        return *(volatile uint32_t *)addr;
+
+    if (reg == HOST_PCC_CMD_COMPLETE) {
+        host_pcc_polls++;
+        if (host_pcc_now() >= host_pcc_done_at)
+            host_pcc_complete();
+    }
+    return host_pcc_regs[reg];
+}
+
+static void host_pcc_write(addr_t addr, uint64_t data, uint32_t size)
+{
+    int reg = host_pcc_reg(addr);
+
+    if (reg < 0) {
+        if (size == 8)
+            *(volatile uint64_t *)addr = data;
+        else
+            *(volatile uint32_t *)addr = (uint32_t)data;
+        return;
+    }
+
+    host_pcc_regs[reg] = (uint32_t)data;
+    if ((reg == HOST_PCC_DOORBELL) && (data & 0x1)) {
+        host_pcc_doorbells++;
+        host_pcc_regs[HOST_PCC_DOORBELL] = 0;
+        if (host_pcc_latency != HOST_PCC_NEVER)
+            host_pcc_done_at = host_pcc_now() + host_pcc_latency;
+    }
+}
+
+void pal_pcc_create_info_table(PCC_INFO_TABLE *PccInfoTable)
+{
+    PCC_SUBSPACE_TYPE_3 *ss = &PccInfoTable->pcc_info[0].type_spec_info.pcc_ss_type_3;
+
+    PccInfoTable->subspace_cnt = 1;
+    PccInfoTable->pcc_info[0].subspace_idx = HOST_PCC_SS_ID;
+    PccInfoTable->pcc_info[0].subspace_type = 3;
+
+    memset(ss, 0, sizeof(*ss));
+    ss->base_addr = (uint64_t)host_pcc_shmem;
+    ss->doorbell_reg.addr = (uint64_t)&host_pcc_regs[HOST_PCC_DOORBELL];
+    ss->doorbell_preserve = ~0x1ull;
+    ss->doorbell_write = 0x1;
+    ss->min_req_turnaround_usec = host_pcc_turnaround;
+    ss->cmd_complete_chk_reg.addr = (uint64_t)&host_pcc_regs[HOST_PCC_CMD_COMPLETE];
+    ss->cmd_complete_chk_mask = 0x1;
+    ss->cmd_complete_update_reg.addr = (uint64_t)&host_pcc_regs[HOST_PCC_CMD_COMPLETE];
+    ss->cmd_complete_update_preserve = ~0x1ull;
+    ss->cmd_complete_update_set = 0;
+    ss->error_status_reg.addr = (uint64_t)&host_pcc_regs[HOST_PCC_ERROR];
+    ss->error_status_mask = 0x1;
+    ss->platform_intr = host_pcc_intr ? 100 : 0;
+}
+
+void pal_mem_free_aligned(void *buffer)
+{
+    free(buffer);
+}
+
+uint64_t ArmArchTimerReadReg(ARM_ARCH_TIMER_REGS Reg)
+{
+    if (Reg == CntFrq)
+        return host_cntfrq;
+    if (Reg == CntPct)
+        return host_cntpct++;
+    return 0;
+}
+
+uint64_t val_timer_get_info(TIMER_INFO_e info_type, uint64_t instance)
+{
+    (void)instance;
+    return (info_type == TIMER_INFO_PHY_EL1_INTID) ? HOST_TIMER_INTID : 0;
+}
+
+void val_timer_set_phy_el1(uint64_t timeout)
+{
+    host_timer_at = timeout ? host_cntpct + timeout : HOST_PCC_NEVER;
+}
+
+/* IRQs are unmasked again: a pending completion interrupt is taken */
+uint64_t AA64ReadDaif(void) { return 0; }
+void AA64WriteDaif(uint64_t daif)
+{
+    (void)daif;
+    if (host_pcc_irq_pending) {
+        host_pcc_irq_pending = 0;
+        pcc_intr_handler();
+    }
+}
+void AA64MaskIrq(void) { }
+
+/* Sleep until the platform completes the command or the timer fires, whichever is first.
+   Nothing else wakes the PE. */
+void ArmCallWFI(void)
+{
+    uint64_t wake = host_timer_at;
+
+    host_pcc_wfis++;
+    if (host_pcc_done_at < wake)
+        wake = host_pcc_done_at;
+    HOST_CHECK(wake != HOST_PCC_NEVER);
+    if (wake == HOST_PCC_NEVER)
+        return;
+
+    if (wake > host_cntpct)
+        host_cntpct = wake;
+    if (host_cntpct >= host_pcc_done_at)
+        host_pcc_complete();
+}
+
+static void host_pcc_start(uint64_t latency)
+{
+    uint64_t *table = calloc(1, sizeof(PCC_INFO_TABLE) + sizeof(PCC_INFO));
+
+    memset(host_pcc_shmem, 0, sizeof(host_pcc_shmem));
+    memset(host_pcc_regs, 0, sizeof(host_pcc_regs));
+    host_pcc_regs[HOST_PCC_CMD_COMPLETE] = 0x1;
+    host_pcc_latency = latency;
+    host_pcc_done_at = HOST_PCC_NEVER;
+    host_pcc_fail_cmd = 0;
+    host_pcc_doorbells = 0;
+    host_pcc_polls = 0;
+    host_pcc_irq_pending = 0;
+    host_pcc_wfis = 0;
+    host_mmio_read_hook = host_pcc_read;
+    host_mmio_write_hook = host_pcc_write;
+
+    val_pcc_create_info_table(table);
+}
+
+static void host_pcc_stop(void)
+{
+    val_pcc_free_info_table();
+    host_mmio_read_hook = NULL;
+    host_mmio_write_hook = NULL;
+    host_cntfrq = 1000000;
+    host_pcc_turnaround = 1000;
+    host_pcc_intr = 0;
+    g_el1physkip = 0;
+}
+
+/* Post one command and return the platform response, or ~0 if the command failed */
+static uint32_t host_pcc_cmd(uint32_t data)
+{
+    uint32_t *resp = val_pcc_cmd_response(HOST_PCC_SS_ID, 0x1, &data, sizeof(data));
+
+    return resp ? *resp : ~0u;
+}
+
+/* The wait returns on the first poll that sees the command complete */
+static void test_pcc_wait_early(void)
+{
+    PCC_SUBSPACE_TYPE_3 *ss;
+    uint64_t start;
+
+    host_pcc_start(10);
+    ss = pcc_get_ss_type_3(HOST_PCC_SS_ID);
+    HOST_CHECK(ss != NULL);
+
+    /* Already owned by OSPM: a single poll */
+    HOST_CHECK(pcc_wait_cmd_complete(ss, 0) == ACS_STATUS_PASS);
+    HOST_CHECK(host_pcc_polls == 1);
+
+    /* Completion 10 ticks after the doorbell, well inside the 3000 tick timeout */
+    start = host_cntpct;
+    HOST_CHECK(host_pcc_cmd(41) == 42);
+    HOST_CHECK(host_pcc_doorbells == 1);
+    HOST_CHECK(host_cntpct - start < 3 * 10 + 10);
+    printf("  pcc wait early: completed after %llu ticks, %u polls (timeout %u ticks)\n",
+           (unsigned long long)(host_cntpct - start), host_pcc_polls,
+           3 * host_pcc_turnaround);
+
+    host_pcc_stop();
+}
+
+/* A command the platform never completes fails once three turnaround times have passed */
+static void test_pcc_wait_timeout(void)
+{
+    PCC_SUBSPACE_TYPE_3 *ss;
+    uint64_t start, elapsed;
+
+    host_pcc_start(HOST_PCC_NEVER);
+    HOST_CHECK(host_pcc_cmd(1) == ~0u);
+    HOST_CHECK(host_pcc_doorbells == 1);
+
+    /* Still owned by the platform: the next command is not posted */
+    HOST_CHECK(host_pcc_cmd(1) == ~0u);
+    HOST_CHECK(host_pcc_doorbells == 1);
+
+    ss = pcc_get_ss_type_3(HOST_PCC_SS_ID);
+    start = host_cntpct;
+    HOST_CHECK(pcc_wait_cmd_complete(ss, 0) == ACS_STATUS_FAIL);
+    elapsed = host_cntpct - start;
+    HOST_CHECK(elapsed >= 3 * host_pcc_turnaround && elapsed <= 3 * host_pcc_turnaround + 4);
+    host_pcc_stop();
+
+    /* A zero turnaround time gets the minimum timeout */
+    host_pcc_turnaround = 0;
+    host_pcc_start(HOST_PCC_NEVER);
+    HOST_CHECK(host_pcc_cmd(1) == ~0u);
+    ss = pcc_get_ss_type_3(HOST_PCC_SS_ID);
+    start = host_cntpct;
+    HOST_CHECK(pcc_wait_cmd_complete(ss, 0) == ACS_STATUS_FAIL);
+    HOST_CHECK(host_cntpct - start >= PCC_CMD_TIMEOUT_MIN_US);
+    host_pcc_stop();
+
+    /* Without a counter frequency the wait counts 1us delays */
+    host_cntfrq = 0;
+    host_pcc_start(HOST_PCC_NEVER);
+    host_delay_us = 0;
+    HOST_CHECK(host_pcc_cmd(1) == ~0u);
+    HOST_CHECK(host_delay_us >= 3 * host_pcc_turnaround &&
+               host_delay_us <= 3 * host_pcc_turnaround + 1);
+    host_pcc_stop();
+
+    host_cntfrq = 0;
+    host_pcc_start(5);
+    host_delay_us = 0;
+    HOST_CHECK(host_pcc_cmd(7) == 8);
+    HOST_CHECK(host_delay_us <= 6);
+    host_pcc_stop();
+}
+
+/* A command completed with the error status bit set fails, the next one is unaffected */
+static void test_pcc_wait_error(void)
+{
+    PCC_SUBSPACE_TYPE_3 *ss;
+
+    host_pcc_start(3);
+    host_pcc_fail_cmd = 1;
+    HOST_CHECK(host_pcc_cmd(1) == ~0u);
+    HOST_CHECK(host_pcc_regs[HOST_PCC_ERROR] == 0x1);
+
+    ss = pcc_get_ss_type_3(HOST_PCC_SS_ID);
+    HOST_CHECK(pcc_wait_cmd_complete(ss, 0) == ACS_STATUS_ERR);
+
+    /* The earlier error does not block ownership of the subspace */
+    HOST_CHECK(host_pcc_cmd(9) == 10);
+    HOST_CHECK(host_pcc_doorbells == 2);
+    HOST_CHECK(pcc_wait_cmd_complete(ss, 0) == ACS_STATUS_PASS);
+
+    host_pcc_stop();
+}
+
+/* With the platform interrupt the PE sleeps in WFI, and the armed timer bounds each sleep */
+static void test_pcc_wait_intr(void)
+{
+    uint64_t start, elapsed;
+
+    /* Woken by the completion interrupt */
+    host_pcc_intr = 1;
+    host_pcc_start(50);
+    start = host_cntpct;
+    HOST_CHECK(host_pcc_cmd(41) == 42);
+    HOST_CHECK(host_pcc_wfis == 1);
+    HOST_CHECK(g_pcc_intr_done == 1);
+    HOST_CHECK(host_cntpct - start < 50 + 10);
+    HOST_CHECK(host_timer_at == HOST_PCC_NEVER);
+    host_pcc_stop();
+
+    /* No completion and no other interrupt: the timer ends the wait at the timeout */
+    host_pcc_intr = 1;
+    host_pcc_start(HOST_PCC_NEVER);
+    start = host_cntpct;
+    HOST_CHECK(host_pcc_cmd(1) == ~0u);
+    elapsed = host_cntpct - start;
+    HOST_CHECK(elapsed >= 3 * host_pcc_turnaround && elapsed <= 3 * host_pcc_turnaround + 10);
+    HOST_CHECK(host_pcc_wfis >= 1 && host_pcc_wfis <= 2);
+    HOST_CHECK(host_timer_at == HOST_PCC_NEVER);
+    printf("  pcc wait intr: timed out after %llu ticks, %u WFIs (timeout %u ticks)\n",
+           (unsigned long long)elapsed, host_pcc_wfis, 3 * host_pcc_turnaround);
+    host_pcc_stop();
+
+    /* The EL1 physical timer is not usable: the wait polls */
+    host_pcc_intr = 1;
+    g_el1physkip = 1;
+    host_pcc_start(20);
+    HOST_CHECK(host_pcc_cmd(5) == 6);
+    HOST_CHECK(host_pcc_wfis == 0);
+    host_pcc_stop();
+}
+
+int main(void)
+{
+    test_pcc_wait_early();
+    test_pcc_wait_timeout();
+    test_pcc_wait_error();
+    test_pcc_wait_intr();
+
+    printf("test_pcc: %s\n", host_failures ? "FAILED" : "PASSED");
+    return host_failures ? 1 : 0;
+}
@@ -0,0 +1,737 @@
+/** @file
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "host_stubs.h"
+#include "val/common/src/acs_pgt.c"
+
+#define TEST_IAS  48
+#define TEST_OAS  48
+
+static uint32_t host_rand_state = 1;
+
+static uint32_t host_rand(void)
+{
+    host_rand_state = host_rand_state * 1103515245 + 12345;
+    return (host_rand_state >> 16) & 0x7fff;
+}
+
+static uint32_t host_granule_log2(void)
+{
+    return log2_page_size(host_page_size);
+}
+
+static void host_pgt_desc(pgt_descriptor_t *pgt_desc, uint32_t ias, uint32_t oas)
+{
+    memset(pgt_desc, 0, sizeof(*pgt_desc));
+    pgt_desc->ias = ias;
+    pgt_desc->oas = oas;
+    pgt_desc->tcr.tsz = 64 - ias;
+    pgt_desc->tcr.tg_size_log2 = host_granule_log2();
+}
+
+/* Translation levels for an input size, as val_pgt_create counts them */
+static uint32_t host_levels(uint32_t ias)
+{
+    uint32_t pg = host_granule_log2(), bpl = pg - 3;
+
+    return (ias - pg + bpl - 1) / bpl;
+}
+
+/* Reference walk written from the architecture, independent of acs_pgt.c */
+static int ref_walk(uint64_t root, uint32_t ias, uint64_t va, uint64_t *pa, uint64_t *desc)
+{
+    uint32_t pg = host_granule_log2(), bpl = pg - 3;
+    uint32_t levels = host_levels(ias);
+    uint32_t level = 4 - levels, rem = (levels - 1) * bpl + pg, bits = ias - rem;
+    uint64_t oa_mask = ((0x1ull << 48) - 1) & ~((0x1ull << pg) - 1);
+    uint64_t *table = (uint64_t *)root, entry;
+
+    while (1) {
+        entry = table[(va >> rem) & ((0x1ull << bits) - 1)];
+        if (!(entry & 1))
+            return -1;
+        if ((level == 3) || ((entry & 3) == 1)) {
+            *pa = (entry & oa_mask & ~((0x1ull << rem) - 1)) | (va & ((0x1ull << rem) - 1));
+            *desc = entry;
+            return level;
+        }
+        table = (uint64_t *)(entry & oa_mask);
+        level++;
+        rem -= bpl;
+        bits = bpl;
+    }
+}
+
+static uint32_t ref_count_tables(uint64_t *table, uint32_t level, uint32_t bits)
+{
+    uint32_t pg = host_granule_log2(), count = 1;
+    uint64_t i, oa_mask = ((0x1ull << 48) - 1) & ~((0x1ull << pg) - 1);
+
+    if (level == 3)
+        return count;
+
+    for (i = 0; i < (0x1ull << bits); i++) {
+        if ((table[i] & 3) == 3)
+            count += ref_count_tables((uint64_t *)(table[i] & oa_mask), level + 1, pg - 3);
+    }
+
+    return count;
+}
+
+/* Copy of a table hierarchy from plain pages, as other software would build it */
+static uint64_t *ref_copy_tables(uint64_t *table, uint32_t level, uint32_t bits)
+{
+    uint32_t pg = host_granule_log2();
+    uint64_t i, oa_mask = ((0x1ull << 48) - 1) & ~((0x1ull << pg) - 1);
+    uint64_t *copy = val_memory_alloc_pages(1), *next;
+
+    memcpy(copy, table, host_page_size);
+    for (i = 0; level < 3 && i < (0x1ull << bits); i++) {
+        if ((copy[i] & 3) == 3) {
+            next = ref_copy_tables((uint64_t *)(copy[i] & oa_mask), level + 1, pg - 3);
+            copy[i] = (copy[i] & ~oa_mask) | (uint64_t)next;
+        }
+    }
+
+    return copy;
+}
+
+static uint32_t ref_tables(uint64_t root, uint32_t ias)
+{
+    uint32_t pg = host_granule_log2(), bpl = pg - 3;
+    uint32_t levels = host_levels(ias);
+
+    return ref_count_tables((uint64_t *)root, 4 - levels, ias - ((levels - 1) * bpl + pg));
+}
+
+/* Table pages held by the pool and by the tables not yet destroyed */
+static int64_t host_pgt_held_pages(void)
+{
+    int64_t held = pgt_pool_free_count;
+    uint32_t i;
+
+    for (i = 0; i < PGT_CACHE_MAX; i++) {
+        if (pgt_cache[i].pgt_base)
+            held += ref_tables(pgt_cache[i].pgt_base, pgt_cache[i].ias);
+    }
+
+    return held;
+}
+
+/* Check the output address and attributes of every sampled page of the regions */
+static void ref_check_regions(pgt_descriptor_t *pgt_desc, memory_region_descriptor_t *mem_desc)
+{
+    uint32_t pg = host_granule_log2(), level, run, k;
+    uint64_t off, step, va, pa, desc, attr, run_size, run_base, pa0, desc0, pak, desck;
+    memory_region_descriptor_t *md;
+
+    for (md = mem_desc; md->length; md++) {
+        step = ((md->length / 997) | ((0x1ull << pg) - 1)) + 1;
+        for (off = 0; off < md->length; off += step) {
+            va = md->virtual_address + off;
+            level = ref_walk(pgt_desc->pgt_base, pgt_desc->ias, va, &pa, &desc);
+            HOST_CHECK((int)level >= 0);
+            HOST_CHECK(pa == md->physical_address + off);
+            HOST_CHECK((desc & PGT_DESC_ATTRIBUTES_MASK & ~PGT_ENTRY_CONTIG_MASK) ==
+                       md->attributes);
+            HOST_CHECK(val_pgt_get_attributes(*pgt_desc, va, &attr) == 0);
+            HOST_CHECK(attr == md->attributes);
+            if (host_failures)
+                return;
+
+            if (!(desc & PGT_ENTRY_CONTIG_MASK))
+                continue;
+
+            /* Every entry of a contiguous run maps the next block of one output range */
+            run = pgt_contig_entries(host_page_size, level);
+            run_size = (uint64_t)run << (pg + (3 - level) * (pg - 3));
+            run_base = va & ~(run_size - 1);
+            ref_walk(pgt_desc->pgt_base, pgt_desc->ias, run_base, &pa0, &desc0);
+            for (k = 0; k < run; k++) {
+                ref_walk(pgt_desc->pgt_base, pgt_desc->ias, run_base + k * (run_size / run),
+                         &pak, &desck);
+                HOST_CHECK(desck & PGT_ENTRY_CONTIG_MASK);
+                HOST_CHECK(pak == pa0 + k * (run_size / run));
+                HOST_CHECK((desck & PGT_DESC_ATTRIBUTES_MASK) ==
+                           (desc0 & PGT_DESC_ATTRIBUTES_MASK));
+            }
+        }
+    }
+}
+
+/* Up to three page aligned regions with random sizes, alignments and output offsets */
+static void host_random_regions(memory_region_descriptor_t *mem_desc)
+{
+    uint32_t pg = host_granule_log2(), r, num = 1 + host_rand() % 3;
+    uint64_t va = 0, align;
+
+    memset(mem_desc, 0, sizeof(memory_region_descriptor_t) * (PGT_CACHE_MAX_REGIONS + 1));
+    for (r = 0; r < num; r++) {
+        align = 0x1ull << (pg + host_rand() % 20);
+        va += ((uint64_t)(host_rand() % 64) << pg) + align;
+        va &= ~(align - 1);
+        mem_desc[r].virtual_address = va;
+        mem_desc[r].physical_address = (va + ((uint64_t)(host_rand() % 4) << (pg + host_rand() % 12))) &
+                                       ((0x1ull << (TEST_OAS - 1)) - 1);
+        mem_desc[r].length = (uint64_t)(1 + host_rand() % 4096) << pg;
+        if (host_rand() % 4 == 0)
+            mem_desc[r].length <<= 8;
+        mem_desc[r].attributes = ((uint64_t)(r + 1) << 2) | (0x1ull << 10);
+        va += mem_desc[r].length;
+    }
+}
+
+static void test_pgt_build(void)
+{
+    memory_region_descriptor_t mem_desc[PGT_CACHE_MAX_REGIONS + 1];
+    pgt_descriptor_t pgt_desc;
+    uint32_t i;
+
+    for (i = 0; i < 300 && !host_failures; i++) {
+        host_random_regions(mem_desc);
+        host_pgt_desc(&pgt_desc, TEST_IAS, TEST_OAS);
+        HOST_CHECK(val_pgt_create(mem_desc, &pgt_desc) == 0);
+        ref_check_regions(&pgt_desc, mem_desc);
+        val_pgt_destroy(pgt_desc);
+    }
+
+    HOST_CHECK(host_pages_live == host_pgt_held_pages());
+}
+
+/* A block or contiguous run written over a table descriptor frees the old subtable */
+static void test_pgt_overwrite_table(void)
+{
+    memory_region_descriptor_t mem_desc[2];
+    pgt_descriptor_t pgt_desc;
+    uint32_t pg = host_granule_log2();
+    uint64_t block = 0x1ull << (2 * pg - 3), pa, desc;
+    int64_t pages;
+
+    memset(mem_desc, 0, sizeof(mem_desc));
+    host_pgt_desc(&pgt_desc, TEST_IAS, TEST_OAS);
+
+    /* Pages in 40 level 2 entries, the output offset rules out blocks */
+    mem_desc[0].virtual_address = 64 * block;
+    mem_desc[0].physical_address = 64 * block + (0x1ull << pg);
+    mem_desc[0].length = 40 * block - (0x1ull << pg);
+    mem_desc[0].attributes = (0x1ull << 2) | (0x1ull << 10);
+    HOST_CHECK(val_pgt_create(mem_desc, &pgt_desc) == 0);
+    HOST_CHECK(ref_walk(pgt_desc.pgt_base, TEST_IAS, 64 * block, &pa, &desc) == 3);
+    pages = host_pages_live - pgt_pool_free_count;
+
+    /* Blocks over the same range, as contiguous runs where aligned */
+    mem_desc[0].physical_address = 128 * block;
+    mem_desc[0].length = 40 * block;
+    mem_desc[0].attributes = (0x2ull << 2) | (0x1ull << 10);
+    HOST_CHECK(val_pgt_create(mem_desc, &pgt_desc) == 0);
+    ref_check_regions(&pgt_desc, mem_desc);
+    HOST_CHECK(ref_walk(pgt_desc.pgt_base, TEST_IAS, 64 * block, &pa, &desc) == 2);
+    HOST_CHECK(host_pages_live - pgt_pool_free_count == pages - 40);
+    HOST_CHECK(ref_tables(pgt_desc.pgt_base, TEST_IAS) == host_levels(TEST_IAS) - 1);
+
+    val_pgt_destroy(pgt_desc);
+    HOST_CHECK(host_pages_live == host_pgt_held_pages());
+}
+
+/* A failed build releases every table it allocated */
+static void test_pgt_alloc_failure(void)
+{
+    memory_region_descriptor_t mem_desc[3];
+    pgt_descriptor_t pgt_desc;
+    uint32_t pg = host_granule_log2(), n, failed = 0;
+
+    memset(mem_desc, 0, sizeof(mem_desc));
+    mem_desc[0].virtual_address = 0x1ull << 40;
+    mem_desc[0].physical_address = 0x1000ull << pg;
+    mem_desc[0].length = 0x41ull << pg;
+    mem_desc[0].attributes = (0x3ull << 2) | (0x1ull << 10);
+    mem_desc[1].virtual_address = 0x3ull << 41;
+    mem_desc[1].physical_address = 0x2000ull << pg;
+    mem_desc[1].length = 0x7ull << pg;
+    mem_desc[1].attributes = (0x4ull << 2) | (0x1ull << 10);
+
+    val_pgt_release();
+    for (n = 0; n < 16; n++) {
+        host_pgt_desc(&pgt_desc, TEST_IAS, TEST_OAS);
+        host_pages_fail_after = n;
+        if (val_pgt_create(mem_desc, &pgt_desc)) {
+            failed++;
+            HOST_CHECK(host_pages_live == host_pgt_held_pages());
+        } else {
+            val_pgt_destroy(pgt_desc);
+        }
+        host_pages_fail_after = -1;
+        val_pgt_release();
+    }
+
+    HOST_CHECK(failed > 2);
+    HOST_CHECK(host_pages_live == host_pgt_held_pages());
+}
+
+/* Splitting a block keeps output addresses above the input address size */
+static void test_pgt_split_oas(void)
+{
+    memory_region_descriptor_t mem_desc[2];
+    pgt_descriptor_t pgt_desc;
+    uint32_t pg = host_granule_log2(), ias = 2 * pg + 2 * (pg - 3) - 1;
+    uint64_t block = 0x1ull << (2 * pg - 3), pa, desc, high = 0x1ull << 44;
+
+    memset(mem_desc, 0, sizeof(mem_desc));
+    host_pgt_desc(&pgt_desc, ias, TEST_OAS);
+
+    mem_desc[0].virtual_address = block;
+    mem_desc[0].physical_address = high;
+    mem_desc[0].length = block;
+    mem_desc[0].attributes = (0x1ull << 2) | (0x1ull << 10);
+    HOST_CHECK(val_pgt_create(mem_desc, &pgt_desc) == 0);
+    HOST_CHECK(ref_walk(pgt_desc.pgt_base, ias, block, &pa, &desc) == 2);
+
+    mem_desc[0].virtual_address = block + (0x1ull << pg);
+    mem_desc[0].physical_address = 0x1ull << 40;
+    mem_desc[0].length = 0x1ull << pg;
+    HOST_CHECK(val_pgt_create(mem_desc, &pgt_desc) == 0);
+
+    HOST_CHECK(ref_walk(pgt_desc.pgt_base, ias, block + 2 * (0x1ull << pg), &pa, &desc) == 3);
+    HOST_CHECK(pa == high + 2 * (0x1ull << pg));
+    HOST_CHECK(ref_walk(pgt_desc.pgt_base, ias, block + (0x1ull << pg), &pa, &desc) == 3);
+    HOST_CHECK(pa == (0x1ull << 40));
+
+    val_pgt_destroy(pgt_desc);
+}
+
+/* Tables val_pgt_create did not allocate, like the live TTBR0 tables, keep their blocks
+   and contiguous runs, and valid entries are replaced with break-before-make */
+static void test_pgt_update_live(void)
+{
+    memory_region_descriptor_t mem_desc[2];
+    pgt_descriptor_t fw, live;
+    uint32_t pg = host_granule_log2(), levels = host_levels(TEST_IAS), tlbi = host_tlbi_count;
+    uint64_t block = 0x1ull << (2 * pg - 3), va = 64 * block, pa, desc;
+
+    memset(mem_desc, 0, sizeof(mem_desc));
+    host_pgt_desc(&fw, TEST_IAS, TEST_OAS);
+
+    /* Firmware tables: a copy of a contiguous run of blocks, built by other software */
+    mem_desc[0].virtual_address = va;
+    mem_desc[0].physical_address = 128 * block;
+    mem_desc[0].length = 32 * block;
+    mem_desc[0].attributes = (0x1ull << 2) | (0x1ull << 10);
+    HOST_CHECK(val_pgt_create(mem_desc, &fw) == 0);
+    live = fw;
+    live.pgt_base = (uint64_t)ref_copy_tables((uint64_t *)fw.pgt_base, 4 - levels,
+                                              TEST_IAS - ((levels - 1) * (pg - 3) + pg));
+    val_pgt_destroy(fw);
+    HOST_CHECK(live.pgt_base != 0);
+    HOST_CHECK(ref_walk(live.pgt_base, TEST_IAS, va + block, &pa, &desc) == 2);
+    HOST_CHECK(desc & PGT_ENTRY_CONTIG_MASK);
+    HOST_CHECK(host_tlbi_count == tlbi);
+    if (host_failures)
+        return;
+
+    /* A page in a block: the block is replaced by a table without splitting it */
+    mem_desc[0].virtual_address = va + block + (0x1ull << pg);
+    mem_desc[0].physical_address = 0x1ull << 40;
+    mem_desc[0].length = 0x1ull << pg;
+    HOST_CHECK(val_pgt_create(mem_desc, &live) == 0);
+    HOST_CHECK(host_tlbi_count == tlbi + 1);
+    HOST_CHECK(ref_walk(live.pgt_base, TEST_IAS, mem_desc[0].virtual_address, &pa, &desc) == 3);
+    HOST_CHECK(pa == mem_desc[0].physical_address && !(desc & PGT_ENTRY_CONTIG_MASK));
+    HOST_CHECK(ref_walk(live.pgt_base, TEST_IAS, va + block, &pa, &desc) < 0);
+
+    /* The rest of the run keeps its contiguous hint */
+    HOST_CHECK(ref_walk(live.pgt_base, TEST_IAS, va, &pa, &desc) == 2);
+    HOST_CHECK(pa == 128 * block && (desc & PGT_ENTRY_CONTIG_MASK));
+
+    /* Invalid entries are written directly, valid pages are broken first */
+    mem_desc[0].virtual_address = va + block;
+    mem_desc[0].physical_address = 0x2ull << 40;
+    HOST_CHECK(val_pgt_create(mem_desc, &live) == 0);
+    HOST_CHECK(host_tlbi_count == tlbi + 1);
+    mem_desc[0].physical_address = 0x3ull << 40;
+    HOST_CHECK(val_pgt_create(mem_desc, &live) == 0);
+    HOST_CHECK(host_tlbi_count == tlbi + 2);
+    HOST_CHECK(ref_walk(live.pgt_base, TEST_IAS, va + block, &pa, &desc) == 3);
+    HOST_CHECK(pa == mem_desc[0].physical_address);
+
+    pgt_free_tables(live.pgt_base, live.ias, live.oas);
+    HOST_CHECK(host_pages_live == host_pgt_held_pages());
+}
+
+/* Attributes from a walk of the tables, bypassing the walk cache */
+static uint32_t host_walk_attr(pgt_descriptor_t *pgt_desc, uint64_t va, uint64_t *attr)
+{
+    pgt_walk_cache_entry_t walk;
+
+    if (pgt_walk(pgt_desc, va, &walk))
+        return ACS_STATUS_ERR;
+
+    *attr = PGT_DESC_ATTRIBUTES(walk.desc[walk.depth - 1]) & ~PGT_ENTRY_CONTIG_MASK;
+    return 0;
+}
+
+/* Cached lookups, single and ranged, agree with full walks on random layouts */
+static void test_pgt_walk_cache_random(void)
+{
+    memory_region_descriptor_t mem_desc[PGT_CACHE_MAX_REGIONS + 1], *md;
+    pgt_descriptor_t pgt_desc;
+    uint32_t pg = host_granule_log2(), i, q, k, num, status, ref_status;
+    uint64_t va, attr, ref_attr, range[64];
+    uint32_t cached = 0;
+
+    for (i = 0; i < 50 && !host_failures; i++) {
+        host_random_regions(mem_desc);
+        host_pgt_desc(&pgt_desc, TEST_IAS, TEST_OAS);
+        HOST_CHECK(val_pgt_create(mem_desc, &pgt_desc) == 0);
+        num = pgt_cache_num_regions(mem_desc);
+
+        for (q = 0; q < 2000 && !host_failures; q++) {
+            /* Addresses around a region, some of them unmapped */
+            md = &mem_desc[host_rand() % num];
+            va = md->virtual_address - (md->length >> 3) +
+                 ((((uint64_t)host_rand() << 15) | host_rand()) % (md->length + (md->length >> 2)));
+            va &= ~((0x1ull << pg) - 1);
+
+            status = val_pgt_get_attributes(pgt_desc, va, &attr);
+            ref_status = host_walk_attr(&pgt_desc, va, &ref_attr);
+            HOST_CHECK(status == ref_status);
+            HOST_CHECK(status || attr == ref_attr);
+
+            status = val_pgt_get_attributes_range(pgt_desc, va, 64, range);
+            for (k = 0, ref_status = 0; k < 64 && !ref_status; k++)
+                ref_status = host_walk_attr(&pgt_desc, va + ((uint64_t)k << pg), &ref_attr) ||
+                             (range[k] != ref_attr);
+            HOST_CHECK(!status == !ref_status);
+        }
+
+        for (k = 0; k < PGT_WALK_CACHE_SIZE; k++)
+            cached += (pgt_walk_cache[k].size_log2 != 0);
+        val_pgt_destroy(pgt_desc);
+    }
+
+    HOST_CHECK(cached != 0);
+}
+
+/* Descriptors changed behind the VAL, at the leaf or above it, are never served stale */
+static void test_pgt_walk_cache_external(void)
+{
+    memory_region_descriptor_t mem_desc[2];
+    pgt_descriptor_t pgt_desc;
+    pgt_walk_cache_entry_t walk;
+    uint32_t pg = host_granule_log2(), run = pgt_contig_entries(host_page_size, 3), k;
+    uint64_t block = 0x1ull << (2 * pg - 3), run_size = (uint64_t)run << pg;
+    uint64_t va, attr, saved, *table_desc, *copy, *table;
+
+    memset(mem_desc, 0, sizeof(mem_desc));
+    host_pgt_desc(&pgt_desc, TEST_IAS, TEST_OAS);
+
+    /* Two contiguous runs of pages */
+    mem_desc[0].virtual_address = 64 * block;
+    mem_desc[0].physical_address = 128 * block + run_size;
+    mem_desc[0].length = 2 * run_size;
+    mem_desc[0].attributes = (0x1ull << 2) | (0x1ull << 10);
+    HOST_CHECK(val_pgt_create(mem_desc, &pgt_desc) == 0);
+    va = mem_desc[0].virtual_address;
+    HOST_CHECK(pgt_walk(&pgt_desc, va, &walk) == 0);
+    HOST_CHECK(walk.size_log2 > walk.leaf_log2);
+    if (host_failures)
+        return;
+
+    /* Another entry of the cached run */
+    HOST_CHECK(val_pgt_get_attributes(pgt_desc, va, &attr) == 0 && attr == mem_desc[0].attributes);
+    table = walk.slot[walk.depth - 1];
+    saved = table[5];
+    table[5] = (saved & ~(0x7ull << 2)) | (0x5ull << 2);
+    HOST_CHECK(val_pgt_get_attributes(pgt_desc, va + (5ull << pg), &attr) == 0);
+    HOST_CHECK(attr == ((0x5ull << 2) | (0x1ull << 10)));
+    table[5] = saved;
+    HOST_CHECK(val_pgt_get_attributes(pgt_desc, va + (5ull << pg), &attr) == 0);
+    HOST_CHECK(attr == mem_desc[0].attributes);
+
+    /* The table descriptor above the leaf points to a copy with other attributes */
+    table_desc = walk.slot[walk.depth - 2];
+    copy = val_memory_alloc_pages(1);
+    memcpy(copy, table, host_page_size);
+    for (k = 0; k < (host_page_size >> 3); k++) {
+        if (copy[k])
+            copy[k] = (copy[k] & ~(0x7ull << 2)) | (0x3ull << 2);
+    }
+    saved = *table_desc;
+    *table_desc = (saved & ~pgt_addr_mask) | ((uint64_t)copy & pgt_addr_mask);
+    HOST_CHECK(val_pgt_get_attributes(pgt_desc, va, &attr) == 0);
+    HOST_CHECK(attr == ((0x3ull << 2) | (0x1ull << 10)));
+    HOST_CHECK(val_pgt_get_attributes_range(pgt_desc, va, 1, &attr) == 0);
+    HOST_CHECK(attr == ((0x3ull << 2) | (0x1ull << 10)));
+
+    /* The table descriptor is invalidated */
+    *table_desc = 0;
+    HOST_CHECK(val_pgt_get_attributes(pgt_desc, va, &attr) != 0);
+    *table_desc = saved;
+    HOST_CHECK(val_pgt_get_attributes(pgt_desc, va + run_size, &attr) == 0);
+    HOST_CHECK(attr == mem_desc[0].attributes);
+
+    val_memory_free_pages(copy, 1);
+    val_pgt_destroy(pgt_desc);
+}
+
+/* Ranged lookups over blocks, contiguous runs and pages, stopping at unmapped pages */
+static void test_pgt_get_attributes_range(void)
+{
+    memory_region_descriptor_t mem_desc[3];
+    pgt_descriptor_t pgt_desc;
+    uint32_t pg = host_granule_log2(), k;
+    uint64_t block = 0x1ull << (2 * pg - 3), va = 64 * block, page = 0x1ull << pg;
+    uint64_t attr1 = (0x1ull << 2) | (0x1ull << 10), attr2 = (0x2ull << 2) | (0x1ull << 10);
+    uint64_t range[8];
+
+    memset(mem_desc, 0, sizeof(mem_desc));
+    host_pgt_desc(&pgt_desc, TEST_IAS, TEST_OAS);
+
+    /* Two blocks, then three pages with other attributes, then nothing */
+    mem_desc[0].virtual_address = va;
+    mem_desc[0].physical_address = 128 * block;
+    mem_desc[0].length = 2 * block;
+    mem_desc[0].attributes = attr1;
+    mem_desc[1].virtual_address = va + 2 * block;
+    mem_desc[1].physical_address = 256 * block + page;
+    mem_desc[1].length = 3 * page;
+    mem_desc[1].attributes = attr2;
+    HOST_CHECK(val_pgt_create(mem_desc, &pgt_desc) == 0);
+
+    /* An unaligned start is rounded down to its page */
+    memset(range, 0, sizeof(range));
+    HOST_CHECK(val_pgt_get_attributes_range(pgt_desc, va + 2 * block - 2 * page + 1, 5,
+                                            range) == 0);
+    for (k = 0; k < 5; k++)
+        HOST_CHECK(range[k] == (k < 2 ? attr1 : attr2));
+    HOST_CHECK(range[5] == 0);
+
+    /* Every page of the first block */
+    for (k = 0; k < 8; k++)
+        range[k] = 0;
+    HOST_CHECK(val_pgt_get_attributes_range(pgt_desc, va + block - 4 * page, 8, range) == 0);
+    for (k = 0; k < 8; k++)
+        HOST_CHECK(range[k] == attr1);
+
+    /* A range running past the last page, or starting unmapped, fails */
+    HOST_CHECK(val_pgt_get_attributes_range(pgt_desc, va + 2 * block, 4, range) != 0);
+    HOST_CHECK(val_pgt_get_attributes_range(pgt_desc, va - page, 1, range) != 0);
+    HOST_CHECK(val_pgt_get_attributes_range(pgt_desc, va, 0, NULL) != 0);
+    HOST_CHECK(val_pgt_get_attributes_range(pgt_desc, va, 0, range) == 0);
+
+    val_pgt_destroy(pgt_desc);
+}
+
+/* Walks of tables val_pgt_create did not allocate are never cached */
+static void test_pgt_walk_cache_foreign(void)
+{
+    memory_region_descriptor_t mem_desc[2];
+    pgt_descriptor_t pgt_desc, fw;
+    uint32_t pg = host_granule_log2(), levels = host_levels(TEST_IAS), k;
+    uint64_t va = 0x1ull << 30, attr;
+
+    memset(mem_desc, 0, sizeof(mem_desc));
+    host_pgt_desc(&pgt_desc, TEST_IAS, TEST_OAS);
+    mem_desc[0].virtual_address = va;
+    mem_desc[0].physical_address = 0x1ull << 32;
+    mem_desc[0].length = 64ull << pg;
+    mem_desc[0].attributes = (0x1ull << 2) | (0x1ull << 10);
+    HOST_CHECK(val_pgt_create(mem_desc, &pgt_desc) == 0);
+    fw = pgt_desc;
+    fw.pgt_base = (uint64_t)ref_copy_tables((uint64_t *)pgt_desc.pgt_base, 4 - levels,
+                                            TEST_IAS - ((levels - 1) * (pg - 3) + pg));
+
+    for (k = 0; k < 64; k++) {
+        HOST_CHECK(val_pgt_get_attributes(fw, va + ((uint64_t)k << pg), &attr) == 0);
+        HOST_CHECK(attr == mem_desc[0].attributes);
+        HOST_CHECK(val_pgt_get_attributes(pgt_desc, va + ((uint64_t)k << pg), &attr) == 0);
+    }
+    HOST_CHECK(val_pgt_get_attributes_range(fw, va, 64, NULL) != 0);
+
+    for (k = 0; k < PGT_WALK_CACHE_SIZE; k++)
+        HOST_CHECK(!pgt_walk_cache[k].size_log2 || pgt_walk_cache[k].pgt_base != fw.pgt_base);
+
+    /* Forgotten tables stop being cached */
+    val_pgt_release();
+    for (k = 0; k < PGT_WALK_CACHE_SIZE; k++)
+        HOST_CHECK(!pgt_walk_cache[k].size_log2);
+    HOST_CHECK(val_pgt_get_attributes(pgt_desc, va, &attr) == 0);
+    for (k = 0; k < PGT_WALK_CACHE_SIZE; k++)
+        HOST_CHECK(!pgt_walk_cache[k].size_log2);
+
+    pgt_free_tables(fw.pgt_base, fw.ias, fw.oas);
+    val_pgt_destroy(pgt_desc);
+}
+
+/* Identical requests share tables only when asked to, and shared tables are never updated */
+static void test_pgt_share(void)
+{
+    memory_region_descriptor_t mem_desc[2], update[2];
+    pgt_descriptor_t first, second, third, other;
+    pgt_cache_entry_t *entry;
+    uint32_t pg = host_granule_log2();
+    uint64_t base, pa, desc;
+
+    memset(mem_desc, 0, sizeof(mem_desc));
+    mem_desc[0].virtual_address = 0x1ull << (pg + 8);
+    mem_desc[0].physical_address = 0x1ull << (pg + 12);
+    mem_desc[0].length = 16ull << pg;
+    mem_desc[0].attributes = (0x1ull << 2) | (0x1ull << 10);
+    update[0] = mem_desc[0];
+    update[0].physical_address += 0x1ull << (pg + 10);
+    update[0].length = 0x1ull << pg;
+    update[1].length = 0;
+
+    /* Without the flag every request gets its own tables */
+    host_pgt_desc(&first, TEST_IAS, TEST_OAS);
+    host_pgt_desc(&second, TEST_IAS, TEST_OAS);
+    HOST_CHECK(val_pgt_create(mem_desc, &first) == 0);
+    second.flags = PGT_FLAG_SHARE;
+    HOST_CHECK(val_pgt_create(mem_desc, &second) == 0);
+    HOST_CHECK(first.pgt_base != second.pgt_base);
+
+    /* Sharing requests with other translation attributes get their own tables */
+    host_pgt_desc(&third, TEST_IAS, TEST_OAS);
+    third.flags = PGT_FLAG_SHARE;
+    third.mair = 0xff;
+    HOST_CHECK(val_pgt_create(mem_desc, &third) == 0);
+    HOST_CHECK(third.pgt_base != second.pgt_base);
+    host_pgt_desc(&other, TEST_IAS, TEST_OAS);
+    other.flags = PGT_FLAG_SHARE;
+    other.stage = PGT_STAGE2;
+    HOST_CHECK(val_pgt_create(mem_desc, &other) == 0);
+    HOST_CHECK(other.pgt_base != second.pgt_base && other.pgt_base != third.pgt_base);
+    val_pgt_destroy(other);
+    val_pgt_destroy(third);
+
+    /* A sharing request with the same attributes shares the tables */
+    host_pgt_desc(&third, TEST_IAS, TEST_OAS);
+    third.flags = PGT_FLAG_SHARE;
+    HOST_CHECK(val_pgt_create(mem_desc, &third) == 0);
+    HOST_CHECK(third.pgt_base == second.pgt_base);
+    entry = pgt_cache_find_base(second.pgt_base);
+    HOST_CHECK(entry && entry->refcount == 2);
+    if (host_failures)
+        return;
+
+    /* Shared tables are not updated, the other user still sees the original mapping */
+    base = second.pgt_base;
+    HOST_CHECK(val_pgt_create(update, &second) != 0);
+    HOST_CHECK(second.pgt_base == base);
+    ref_walk(base, TEST_IAS, update[0].virtual_address, &pa, &desc);
+    HOST_CHECK(pa == update[0].physical_address - (0x1ull << (pg + 10)));
+
+    /* A single user updates in place, and the tables stop being shared */
+    val_pgt_destroy(third);
+    HOST_CHECK(entry->refcount == 1);
+    HOST_CHECK(val_pgt_create(update, &second) == 0);
+    HOST_CHECK(second.pgt_base == base);
+    ref_walk(base, TEST_IAS, update[0].virtual_address, &pa, &desc);
+    HOST_CHECK(pa == update[0].physical_address);
+    host_pgt_desc(&third, TEST_IAS, TEST_OAS);
+    third.flags = PGT_FLAG_SHARE;
+    HOST_CHECK(val_pgt_create(mem_desc, &third) == 0);
+    HOST_CHECK(third.pgt_base != base);
+
+    /* The last user frees the tables, nothing is left for later requests */
+    val_pgt_destroy(first);
+    val_pgt_destroy(second);
+    val_pgt_destroy(third);
+    HOST_CHECK(pgt_cache_find_base(base) == NULL);
+    HOST_CHECK(host_pages_live == host_pgt_held_pages());
+}
+
+/* Teardown forgets the tables not destroyed */
+static void test_pgt_release_leaked(void)
+{
+    memory_region_descriptor_t mem_desc[2];
+    pgt_descriptor_t leaked, next;
+    uint32_t pg = host_granule_log2();
+
+    memset(mem_desc, 0, sizeof(mem_desc));
+    mem_desc[0].virtual_address = 0x1ull << (pg + 8);
+    mem_desc[0].physical_address = 0x1ull << (pg + 12);
+    mem_desc[0].length = 16ull << pg;
+    mem_desc[0].attributes = (0x1ull << 2) | (0x1ull << 10);
+
+    host_pgt_desc(&leaked, TEST_IAS, TEST_OAS);
+    leaked.flags = PGT_FLAG_SHARE;
+    HOST_CHECK(val_pgt_create(mem_desc, &leaked) == 0);
+    val_pgt_release();
+    HOST_CHECK(pgt_cache_find_base(leaked.pgt_base) == NULL);
+
+    next = leaked;
+    next.pgt_base = 0;
+    HOST_CHECK(val_pgt_create(mem_desc, &next) == 0);
+    HOST_CHECK(next.pgt_base != leaked.pgt_base);
+
+    val_pgt_destroy(next);
+    val_pgt_destroy(leaked);
+}
+
+/* Teardown frees the pooled pages */
+static void test_pgt_release(void)
+{
+    val_pgt_release();
+    HOST_CHECK(pgt_pool_free_count == 0);
+    HOST_CHECK(host_pages_live == 0);
+}
+
+/* The VAL page size is fixed for a run, so each granule gets its own process */
+static int run_granule(uint32_t granule)
+{
+    host_page_size = granule;
+
+    test_pgt_build();
+    test_pgt_overwrite_table();
+    test_pgt_alloc_failure();
+    test_pgt_split_oas();
+    test_pgt_update_live();
+    test_pgt_share();
+    test_pgt_release_leaked();
+    test_pgt_walk_cache_random();
+    test_pgt_walk_cache_external();
+    test_pgt_walk_cache_foreign();
+    test_pgt_get_attributes_range();
+    test_pgt_release();
+
+    printf("  pgt %2uK granule: %s\n", granule >> 10, host_failures ? "FAILED" : "ok");
+    return host_failures ? 1 : 0;
+}
+
+int main(void)
+{
+    static const uint32_t granules[] = {PAGE_SIZE_4K, PAGE_SIZE_16K, PAGE_SIZE_64K};
+    uint32_t i;
+    int status, failed = 0;
+    pid_t pid;
+
+    for (i = 0; i < sizeof(granules) / sizeof(granules[0]); i++) {
+        fflush(stdout);
+        pid = fork();
+        if (pid == 0)
+            exit(run_granule(granules[i]));
+        if ((pid < 0) || (waitpid(pid, &status, 0) != pid) ||
+            !WIFEXITED(status) || WEXITSTATUS(status))
+            failed = 1;
+    }
+
+    printf("test_pgt: %s\n", failed ? "FAILED" : "PASSED");
+    return failed;
+}
@@ -0,0 +1,760 @@
+/** @file
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "host_stubs.h"
+#include "val/common/sys_arch_src/smmu_v3/smmu_v3.c"
+
+/* Register model of a single SMMUv3, commands complete as soon as PROD is written */
+#define HOST_SMMU_REG_SIZE    (2 * SMMU_PAGE1_BASE_OFFSET)
+#define HOST_SMMU_CMD_LOG     1024
+#define HOST_SMMU_CMDQS       8
+#define HOST_SMMU_EVNTQS      7
+
+typedef struct {
+    uint8_t  *regs;
+    uint32_t evt_gsiv;
+    uint32_t gerr_gsiv;
+    uint32_t prod_writes;
+    uint32_t cons_reads;
+    uint32_t msi_writes;
+    uint32_t evtq_cons_writes;
+    uint32_t op_count[256];
+    uint32_t num_cmds;
+    uint64_t cmd_log[HOST_SMMU_CMD_LOG][CMDQ_DWORDS_PER_ENT];
+} host_smmu_t;
+
+static host_smmu_t host_smmu;
+
+static uint32_t *host_smmu_reg(uint32_t offset)
+{
+    return (uint32_t *)(host_smmu.regs + offset);
+}
+
+static int host_smmu_owns(addr_t addr)
+{
+    return (addr >= (addr_t)host_smmu.regs) &&
+           (addr < (addr_t)host_smmu.regs + HOST_SMMU_REG_SIZE);
+}
+
+static void host_smmu_exec(uint64_t *cmd)
+{
+    uint32_t op = BITFIELD_GET(CMDQ_0_OP, cmd[0]);
+    uint64_t msi_addr;
+
+    host_smmu.op_count[op]++;
+    if (host_smmu.num_cmds < HOST_SMMU_CMD_LOG) {
+        host_smmu.cmd_log[host_smmu.num_cmds][0] = cmd[0];
+        host_smmu.cmd_log[host_smmu.num_cmds][1] = cmd[1];
+    }
+    host_smmu.num_cmds++;
+
+    if ((op == CMDQ_OP_CMD_SYNC) &&
+        (BITFIELD_GET(CMDQ_SYNC_0_CS, cmd[0]) == CMDQ_SYNC_0_CS_IRQ)) {
+        msi_addr = cmd[1] & (CMDQ_SYNC_1_MSIADDR_MASK << CMDQ_SYNC_1_MSIADDR_SHIFT);
+        *(volatile uint32_t *)msi_addr = (uint32_t)BITFIELD_GET(CMDQ_SYNC_0_MSIDATA, cmd[0]);
+        host_smmu.msi_writes++;
+    }
+}
+
+static void host_smmu_consume(uint32_t prod)
+{
+    uint64_t base = *(uint64_t *)host_smmu_reg(SMMU_CMDQ_BASE_OFFSET);
+    uint32_t log2nent = BITFIELD_GET(QUEUE_BASE_LOG2SIZE, base);
+    uint32_t wrap_mask = (0x1u << (log2nent + 1)) - 1;
+    uint32_t cons = *host_smmu_reg(SMMU_CMDQ_CONS_OFFSET) & wrap_mask;
+    uint64_t *queue = (uint64_t *)(base & (QUEUE_BASE_ADDR_MASK << QUEUE_BASE_ADDR_SHIFT));
+
+    while (cons != (prod & wrap_mask)) {
+        host_smmu_exec(&queue[(cons & ((0x1u << log2nent) - 1)) * CMDQ_DWORDS_PER_ENT]);
+        cons = (cons + 1) & wrap_mask;
+    }
+
+    *host_smmu_reg(SMMU_CMDQ_CONS_OFFSET) = cons;
+}
+
+static uint32_t host_smmu_read(addr_t addr)
+{
+    if (!host_smmu_owns(addr))
+        return *(volatile uint32_t *)addr;
+
+    if (addr - (addr_t)host_smmu.regs == SMMU_CMDQ_CONS_OFFSET)
+        host_smmu.cons_reads++;
+
+    return *(uint32_t *)addr;
+}
+
+static void host_smmu_write(addr_t addr, uint64_t data, uint32_t size)
+{
+    uint32_t offset;
+
+    if (size == 8)
+        *(volatile uint64_t *)addr = data;
+    else
+        *(volatile uint32_t *)addr = (uint32_t)data;
+
+    if (!host_smmu_owns(addr))
+        return;
+
+    offset = addr - (addr_t)host_smmu.regs;
+    switch (offset) {
+    case SMMU_CR0_OFFSET:
+        *host_smmu_reg(SMMU_CR0ACK_OFFSET) = (uint32_t)data;
+        break;
+    case SMMU_IRQ_CTRL_OFFSET:
+        *host_smmu_reg(SMMU_IRQ_CTRLACK_OFFSET) = (uint32_t)data;
+        break;
+    case SMMU_CMDQ_PROD_OFFSET:
+        host_smmu.prod_writes++;
+        host_smmu_consume((uint32_t)data);
+        break;
+    case SMMU_PAGE1_BASE_OFFSET + SMMU_EVNTQ_CONS_OFFSET:
+        host_smmu.evtq_cons_writes++;
+        break;
+    default:
+        break;
+    }
+}
+
+uint64_t val_iovirt_get_smmu_info(SMMU_INFO_e type, uint32_t index)
+{
+    switch (type) {
+    case SMMU_NUM_CTRL:
+        return 1;
+    case SMMU_CTRL_ARCH_MAJOR_REV:
+        return 3;
+    case SMMU_CTRL_BASE:
+        return (uint64_t)host_smmu.regs;
+    case SMMU_CTRL_EVENT_GSIV:
+        return host_smmu.evt_gsiv;
+    case SMMU_CTRL_GERR_GSIV:
+        return host_smmu.gerr_gsiv;
+    default:
+        return 0;
+    }
+}
+
+static void host_smmu_clear_counts(void)
+{
+    host_smmu.prod_writes = 0;
+    host_smmu.cons_reads = 0;
+    host_smmu.msi_writes = 0;
+    host_smmu.evtq_cons_writes = 0;
+    host_smmu.num_cmds = 0;
+    memset(host_smmu.op_count, 0, sizeof(host_smmu.op_count));
+}
+
+/* Bring up the VAL SMMU driver on a fresh register model */
+static int host_smmu_start(uint32_t idr0, uint32_t idr3, uint32_t sid_bits)
+{
+    if (host_smmu.regs == NULL)
+        host_smmu.regs = aligned_alloc(SMMU_PAGE1_BASE_OFFSET, HOST_SMMU_REG_SIZE);
+    memset(host_smmu.regs, 0, HOST_SMMU_REG_SIZE);
+
+    *host_smmu_reg(SMMU_IDR0_OFFSET) = BITFIELD_SET(IDR0_ST_LEVEL, IDR0_ST_LEVEL_2LVL) |
+                                       BITFIELD_SET(IDR0_TTF, IDR0_TTF_AARCH64) |
+                                       IDR0_S1P | IDR0_S2P | IDR0_CD2L | idr0;
+    *host_smmu_reg(SMMU_IDR1_OFFSET) = BITFIELD_SET(IDR1_CMDQS, HOST_SMMU_CMDQS) |
+                                       BITFIELD_SET(IDR1_EVNTQS, HOST_SMMU_EVNTQS) |
+                                       BITFIELD_SET(IDR1_SSIDSIZE, 8) |
+                                       BITFIELD_SET(IDR1_SIDSIZE, sid_bits);
+    *host_smmu_reg(SMMU_IDR3_OFFSET) = idr3;
+    *host_smmu_reg(SMMU_IDR5_OFFSET) = BITFIELD_SET(IDR5_OAS, 5);
+
+    host_mmio_read_hook = host_smmu_read;
+    host_mmio_write_hook = host_smmu_write;
+    host_smmu_clear_counts();
+
+    return val_smmu_init();
+}
+
+static void host_smmu_stop(void)
+{
+    val_smmu_stop();
+    host_mmio_read_hook = NULL;
+    host_mmio_write_hook = NULL;
+}
+
+/* Submit num TLBI_NSNH_ALL commands behind one CMD_SYNC */
+static void host_cmdq_submit(uint32_t num)
+{
+    smmu_cmdq_batch_t batch = { .num = 0 };
+    uint32_t i;
+
+    for (i = 0; i < num; i++)
+        smmu_cmdq_batch_add(&g_smmu[0], &batch, CMDQ_OP_TLBI_NSNH_ALL);
+    smmu_cmdq_batch_submit(&g_smmu[0], &batch);
+}
+
+static void test_cmdq_batch(void)
+{
+    static const uint32_t sizes[] = {1, 8, 15, 64};
+    smmu_cmd_queue_t *cmdq;
+    uint32_t i, num, cap;
+
+    /* IO-coherent SMMU with MSIs completes CMD_SYNC through memory */
+    HOST_CHECK(host_smmu_start(IDR0_MSI | IDR0_COHACC, 0, 16) == 0);
+    cmdq = &g_smmu[0].cmdq;
+    HOST_CHECK(cmdq->sync_ptr != NULL);
+    cap = smmu_cmdq_batch_cap(&g_smmu[0]);
+
+    printf("  cmdq batch: cmds  PROD writes  CONS reads  (per command before batching: 1 and >= 1)\n");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        num = sizes[i];
+        host_smmu_clear_counts();
+        host_cmdq_submit(num);
+        printf("  cmdq batch: %4u  %11u  %10u\n", num, host_smmu.prod_writes, host_smmu.cons_reads);
+        HOST_CHECK(host_smmu.prod_writes == (num + 1 + cap - 1) / cap);
+        HOST_CHECK(host_smmu.cons_reads == 0);
+        HOST_CHECK(host_smmu.op_count[CMDQ_OP_TLBI_NSNH_ALL] == num);
+        HOST_CHECK(host_smmu.op_count[CMDQ_OP_CMD_SYNC] == 1);
+        HOST_CHECK(host_smmu.msi_writes == 1);
+        HOST_CHECK(*(uint32_t *)cmdq->sync_ptr == cmdq->sync_seq);
+    }
+    host_smmu_stop();
+
+    /* Without IO coherency the sync word would share a line, CONS is polled instead */
+    HOST_CHECK(host_smmu_start(IDR0_MSI, 0, 16) == 0);
+    HOST_CHECK(g_smmu[0].cmdq.sync_ptr == NULL);
+    host_smmu_clear_counts();
+    host_cmdq_submit(8);
+    HOST_CHECK(host_smmu.prod_writes == 1);
+    HOST_CHECK(host_smmu.cons_reads >= 1);
+    HOST_CHECK(host_smmu.msi_writes == 0);
+    HOST_CHECK(host_smmu.op_count[CMDQ_OP_CMD_SYNC] == 1);
+    host_smmu_stop();
+
+    HOST_CHECK(host_allocs_live == 0);
+}
+
+/* Longest bucket chain of the master table */
+static uint32_t host_master_max_chain(void)
+{
+    smmu_master_table_t *tbl = &g_smmu_master_table;
+    struct smmu_master_node *node;
+    uint32_t i, len, max = 0;
+
+    for (i = 0; i < (0x1u << tbl->log2size); i++) {
+        for (len = 0, node = tbl->bucket[i]; node != NULL; node = node->next)
+            len++;
+        if (len > max)
+            max = len;
+    }
+
+    return max;
+}
+
+static void test_master_table(void)
+{
+    static smmu_master_t *masters[0x10000];
+    int64_t allocs = host_allocs_live;
+    uint32_t sid, found = 0;
+
+    /* Every StreamID of a 16-bit SMMU plus a second SMMU sharing the low SIDs */
+    for (sid = 0; sid < 0x10000; sid++) {
+        masters[sid] = smmu_master_at(0, sid);
+        HOST_CHECK(masters[sid] != NULL);
+    }
+    for (sid = 0; sid < 0x100; sid++)
+        HOST_CHECK(smmu_master_at(1, sid) != masters[sid]);
+
+    HOST_CHECK(g_smmu_master_table.count == 0x10100);
+    HOST_CHECK(g_smmu_master_table.count <= (0x1u << g_smmu_master_table.log2size));
+    printf("  master table: %u masters, %u buckets, longest chain %u\n",
+           g_smmu_master_table.count, 0x1u << g_smmu_master_table.log2size,
+           host_master_max_chain());
+    HOST_CHECK(host_master_max_chain() <= 8);
+
+    for (sid = 0; sid < 0x10000; sid++)
+        HOST_CHECK(smmu_master_find(0, sid) == masters[sid]);
+    HOST_CHECK(smmu_master_at(0, 0x1234) == masters[0x1234]);
+
+    for (sid = 0; sid < 0x10000; sid += 2)
+        smmu_master_remove(0, sid);
+    for (sid = 0; sid < 0x10000; sid++)
+        found += (smmu_master_find(0, sid) != NULL);
+    HOST_CHECK(found == 0x8000);
+    HOST_CHECK(smmu_master_find(0, 0x1235) == masters[0x1235]);
+    HOST_CHECK(smmu_master_find(0, 0x1234) == NULL);
+    HOST_CHECK(smmu_master_find(1, 0x80) != NULL);
+
+    smmu_master_table_free();
+    HOST_CHECK(smmu_master_find(0, 1) == NULL);
+    HOST_CHECK(host_allocs_live == allocs);
+}
+
+/* Check the logged TLBIs cover exactly pages pages from iova, return the command count */
+static uint32_t host_tlbi_check(uint64_t iova, uint64_t pages, uint32_t shift, uint32_t ril)
+{
+    uint64_t addr = iova, covered = 0, num;
+    uint32_t i, cmds = 0;
+    uint64_t *cmd;
+
+    for (i = 0; (i < host_smmu.num_cmds) && (i < HOST_SMMU_CMD_LOG); i++) {
+        cmd = host_smmu.cmd_log[i];
+        if (BITFIELD_GET(CMDQ_0_OP, cmd[0]) != CMDQ_OP_TLBI_NH_VA)
+            continue;
+        HOST_CHECK((cmd[1] & CMDQ_TLBI_1_VA_MASK) == addr);
+        num = 1;
+        if (ril) {
+            num = (BITFIELD_GET(CMDQ_TLBI_0_NUM, cmd[0]) + 1) <<
+                  BITFIELD_GET(CMDQ_TLBI_0_SCALE, cmd[0]);
+            HOST_CHECK(BITFIELD_GET(CMDQ_TLBI_1_TG, cmd[1]) == ((shift - 10) >> 1));
+        }
+        addr += num << shift;
+        covered += num;
+        cmds++;
+    }
+
+    HOST_CHECK(covered == pages);
+    return cmds;
+}
+
+static void test_tlbi_range(void)
+{
+    static const uint64_t sizes[] = {1, 33, 64, 1000, 0x12345, 0x100000};
+    smmu_master_t master;
+    uint64_t iova = 0x40000000, pages;
+    uint32_t i, ril, per_page;
+
+    memset(&master, 0, sizeof(master));
+    master.page_shift = 12;
+    master.stage = SMMU_STAGE_S1;
+    master.stage1_config.cd.asid = 5;
+
+    printf("  tlbi range: pages    cmds w/o RIL  cmds with RIL  (CMD_SYNC included)\n");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        pages = sizes[i];
+        for (ril = 0; ril < 2; ril++) {
+            HOST_CHECK(host_smmu_start(IDR0_MSI | IDR0_COHACC, ril ? IDR3_RIL : 0, 16) == 0);
+            master.smmu = &g_smmu[0];
+            host_smmu_clear_counts();
+            smmu_master_tlbi_range(&master, iova, pages << master.page_shift);
+            if (!ril) {
+                per_page = host_smmu.num_cmds;
+                if (pages <= SMMU_TLBI_PAGE_MAX)
+                    host_tlbi_check(iova, pages, master.page_shift, 0);
+                else
+                    HOST_CHECK(host_smmu.op_count[CMDQ_OP_TLBI_NH_ASID] == 1);
+            } else {
+                host_tlbi_check(iova, pages, master.page_shift, 1);
+                printf("  tlbi range: %8llu  %12u  %13u\n", (unsigned long long)pages,
+                       per_page, host_smmu.num_cmds);
+            }
+            host_smmu_stop();
+        }
+    }
+
+    HOST_CHECK(host_smmu_start(IDR0_MSI | IDR0_COHACC, IDR3_RIL, 16) == 0);
+    master.smmu = &g_smmu[0];
+
+    /* 2^32 pages have their lowest set bit above the 5-bit SCALE field */
+    host_smmu_clear_counts();
+    smmu_master_tlbi_range(&master, 0, 0x1ull << 44);
+    HOST_CHECK(host_tlbi_check(0, 0x1ull << 32, master.page_shift, 1) == 1);
+    HOST_CHECK(BITFIELD_GET(CMDQ_TLBI_0_SCALE, host_smmu.cmd_log[0][0]) ==
+               CMDQ_TLBI_RANGE_SCALE_MAX);
+
+    /* 31 << 31 pages is the largest count a range command can encode */
+    host_smmu_clear_counts();
+    smmu_master_tlbi_range(&master, 0, (uint64_t)CMDQ_TLBI_RANGE_NUM_MAX << 43);
+    HOST_CHECK(host_tlbi_check(0, (uint64_t)CMDQ_TLBI_RANGE_NUM_MAX << 31,
+                               master.page_shift, 1) == 1);
+
+    /* Beyond that the whole ASID is dropped */
+    host_smmu_clear_counts();
+    smmu_master_tlbi_range(&master, 0x1000, 0x1ull << 48);
+    HOST_CHECK(host_smmu.op_count[CMDQ_OP_TLBI_NH_VA] == 0);
+    HOST_CHECK(host_smmu.op_count[CMDQ_OP_TLBI_NH_ASID] == 1);
+
+    host_smmu_stop();
+    HOST_CHECK(host_allocs_live == 0);
+}
+
+static void host_map_attr(smmu_master_attributes_t *attr, pgt_descriptor_t *pgt_desc,
+                          uint32_t sid, uint32_t ssid_bits)
+{
+    memset(attr, 0, sizeof(*attr));
+    memset(pgt_desc, 0, sizeof(*pgt_desc));
+    attr->streamid = sid;
+    attr->ssid_bits = ssid_bits;
+    pgt_desc->pgt_base = 0x80000000;
+    pgt_desc->tcr.tg_size_log2 = 12;
+    pgt_desc->tcr.tsz = 16;
+}
+
+/* L2 stream table memory the span allocator needs for spans spans: chunks of 1, 2, 4, ...
+   STRTAB_L2_POOL_SPANS spans, each with one extra span for alignment */
+static uint64_t host_strtab_l2_size(uint32_t spans, uint32_t *chunks)
+{
+    uint64_t span_size = (1 << STRTAB_SPLIT) * STRTAB_STE_DWORDS * BYTES_PER_DWORD;
+    uint32_t cap = 0, num = 0;
+    uint64_t size = 0;
+
+    for (*chunks = 0; cap < spans; (*chunks)++) {
+        num = (num == 0) ? 1 : num * 2;
+        if (num > STRTAB_L2_POOL_SPANS)
+            num = STRTAB_L2_POOL_SPANS;
+        cap += num;
+        size += (num + 1) * span_size;
+    }
+
+    return size;
+}
+
+/* Map sids_per_span masters in each of spans L2 spans, spread evenly over the SID range */
+static void host_strtab_l2_case(uint32_t spans, uint32_t sids_per_span)
+{
+    smmu_master_attributes_t attr;
+    pgt_descriptor_t pgt_desc;
+    smmu_strtab_config_t *cfg;
+    struct smmu_strtab_l2_chunk *chunk;
+    uint64_t span_size = (1 << STRTAB_SPLIT) * STRTAB_STE_DWORDS * BYTES_PER_DWORD;
+    uint64_t base_size, l2_size;
+    uint32_t i, span, stride, sid, chunks = 0, exp_chunks, populated = 0;
+
+    HOST_CHECK(host_smmu_start(IDR0_MSI | IDR0_COHACC, 0, 16) == 0);
+    cfg = &g_smmu[0].strtab_cfg;
+    base_size = cfg->mem_size;
+    stride = cfg->l1_ent_count / spans;
+
+    /* Every SID is distinct, SID i / spans of span (i % spans) * stride */
+    for (i = 0; i < spans * sids_per_span; i++) {
+        sid = ((i % spans) * stride) << STRTAB_SPLIT | (i / spans);
+        host_map_attr(&attr, &pgt_desc, sid, 0);
+        HOST_CHECK(val_smmu_map(attr, pgt_desc) == 0);
+        HOST_CHECK(smmu_strtab_get_ste_for_sid(&g_smmu[0], sid) != NULL);
+    }
+    HOST_CHECK(g_smmu_master_table.count == spans * sids_per_span);
+
+    for (chunk = cfg->l2_pool; chunk != NULL; chunk = chunk->next)
+        chunks++;
+
+    l2_size = host_strtab_l2_size(spans, &exp_chunks);
+    printf("  strtab l2: %3u spans x %3u SIDs in %2u chunks, 0x%06llx bytes "
+           "(0x%06llx with one block per span)\n", spans, sids_per_span, chunks,
+           (unsigned long long)(cfg->mem_size - base_size),
+           (unsigned long long)(spans * 2 * span_size));
+    HOST_CHECK(cfg->l2_span_count == spans);
+    HOST_CHECK(chunks == exp_chunks);
+    HOST_CHECK(cfg->mem_size - base_size == l2_size);
+    HOST_CHECK(val_smmu_get_info(SMMU_STRTAB_MEM_SIZE, 0) == cfg->mem_size);
+
+    /* Populated spans point at a span aligned L2 table, the others stay invalid */
+    for (span = 0; span < cfg->l1_ent_count; span++) {
+        if ((span % stride) == 0) {
+            populated++;
+            HOST_CHECK(cfg->l1_desc[span].l2desc64 != NULL);
+            HOST_CHECK((cfg->l1_desc[span].l2desc_phys & (span_size - 1)) == 0);
+            HOST_CHECK(BITFIELD_GET(STRTAB_L1_DESC_SPAN, cfg->strtab64[span]) ==
+                       STRTAB_SPLIT + 1);
+        } else {
+            HOST_CHECK(cfg->l1_desc[span].l2desc64 == NULL);
+            HOST_CHECK(cfg->strtab64[span] == 0);
+            HOST_CHECK(smmu_strtab_get_ste_for_sid(&g_smmu[0], span << STRTAB_SPLIT) == NULL);
+            HOST_CHECK(smmu_strtab_get_ste_for_sid(&g_smmu[0],
+                                                   (span << STRTAB_SPLIT) | 0xff) == NULL);
+        }
+    }
+    HOST_CHECK(populated == spans);
+
+    for (i = 0; i < spans * sids_per_span; i++) {
+        host_map_attr(&attr, &pgt_desc, ((i % spans) * stride) << STRTAB_SPLIT | (i / spans), 0);
+        val_smmu_unmap(attr);
+    }
+    HOST_CHECK(g_smmu_master_table.count == 0);
+
+    host_smmu_stop();
+    HOST_CHECK(host_allocs_live == 0);
+}
+
+static void test_strtab_l2_span(void)
+{
+    /* From every SID of one span to one SID in each span of the 16-bit SID range */
+    host_strtab_l2_case(1, 1 << STRTAB_SPLIT);
+    host_strtab_l2_case(4, 32);
+    host_strtab_l2_case(64, 2);
+    host_strtab_l2_case(1 << (16 - STRTAB_SPLIT), 1);
+}
+
+static void test_cdtab_pool(void)
+{
+    static const uint32_t ssid_bits[] = {0, 4, 10, 12};
+    smmu_master_attributes_t attr;
+    pgt_descriptor_t pgt_desc;
+    uint32_t i, allocs = 0, prealloc;
+
+    HOST_CHECK(host_smmu_start(IDR0_MSI | IDR0_COHACC, 0, 16) == 0);
+    prealloc = g_smmu_cdtab_pool.allocs;
+    HOST_CHECK(prealloc == SMMU_CDTAB_POOL_PREALLOC);
+
+    /* Map and unmap linear and two-level CD tables, the pool must stop growing */
+    for (i = 0; i < 4000; i++) {
+        host_map_attr(&attr, &pgt_desc, i % 16, ssid_bits[i % 4]);
+        attr.substreamid = (i * 7) & ((0x1u << ssid_bits[i % 4]) - 1);
+        HOST_CHECK(val_smmu_map(attr, pgt_desc) == 0);
+        val_smmu_unmap(attr);
+        if (i == 3)
+            allocs = g_smmu_cdtab_pool.allocs;
+    }
+
+    printf("  cdtab pool: 4000 map/unmap cycles, %u blocks allocated (%u preallocated)\n",
+           g_smmu_cdtab_pool.allocs, prealloc);
+    HOST_CHECK(g_smmu_cdtab_pool.allocs == allocs);
+    HOST_CHECK(val_smmu_get_info(SMMU_CDTAB_POOL_ALLOCS, 0) == allocs);
+
+    /* Recycled tables come back zeroed */
+    host_map_attr(&attr, &pgt_desc, 1, 12);
+    attr.substreamid = 0x800;
+    HOST_CHECK(val_smmu_map(attr, pgt_desc) == 0);
+    for (i = 0; i < 4; i++) {
+        if (i != (0x800 >> CDTAB_SPLIT))
+            HOST_CHECK(smmu_master_find(0, 1)->stage1_config.cdcfg.cdtab64[i] == 0);
+    }
+    val_smmu_unmap(attr);
+
+    host_smmu_stop();
+    HOST_CHECK(host_allocs_live == 0);
+}
+
+/* Record an event the way the SMMU does, return 0 if the queue is full and the event is lost */
+static uint32_t host_evtq_inject(uint32_t sid, uint32_t id, uint32_t ssid, uint64_t flags1,
+                                 uint64_t addr)
+{
+    uint64_t base = *(uint64_t *)host_smmu_reg(SMMU_EVNTQ_BASE_OFFSET);
+    uint32_t log2nent = BITFIELD_GET(QUEUE_BASE_LOG2SIZE, base);
+    uint32_t wrap_mask = (0x1u << (log2nent + 1)) - 1;
+    uint32_t *prod = host_smmu_reg(SMMU_PAGE1_BASE_OFFSET + SMMU_EVNTQ_PROD_OFFSET);
+    uint32_t cons = *host_smmu_reg(SMMU_PAGE1_BASE_OFFSET + SMMU_EVNTQ_CONS_OFFSET);
+    uint64_t *queue = (uint64_t *)(base & (QUEUE_BASE_ADDR_MASK << QUEUE_BASE_ADDR_SHIFT));
+    uint64_t *rec;
+
+    if (((*prod ^ cons) & wrap_mask) == (0x1u << log2nent)) {
+        /* Signal the overflow unless one is still unacknowledged */
+        if (SMMU_QUEUE_OVF(*prod) == SMMU_QUEUE_OVF(cons))
+            *prod ^= SMMU_QUEUE_OVERFLOW_FLAG;
+        return 0;
+    }
+
+    rec = &queue[(*prod & ((0x1u << log2nent) - 1)) * EVNTQ_DWORDS_PER_ENT];
+    memset(rec, 0, EVNTQ_DWORDS_PER_ENT * BYTES_PER_DWORD);
+    rec[0] = BITFIELD_SET(EVTQ_0_ID, id) | BITFIELD_SET(EVTQ_0_SID, (uint64_t)sid);
+    if (ssid != SMMU_EVT_ANY)
+        rec[0] |= BITFIELD_SET(EVTQ_0_SSID, (uint64_t)ssid) | EVTQ_0_SSV;
+    rec[1] = flags1;
+    rec[2] = addr;
+
+    *prod = SMMU_QUEUE_OVF(*prod) | ((*prod + 1) & wrap_mask);
+    return 1;
+}
+
+static uint32_t host_evtq_prod(void)
+{
+    return *host_smmu_reg(SMMU_PAGE1_BASE_OFFSET + SMMU_EVNTQ_PROD_OFFSET);
+}
+
+static uint32_t host_evtq_cons(void)
+{
+    return *host_smmu_reg(SMMU_PAGE1_BASE_OFFSET + SMMU_EVNTQ_CONS_OFFSET);
+}
+
+static void test_evtq_inject(void)
+{
+    static smmu_event_t events[0x1u << HOST_SMMU_EVNTQS];
+    smmu_dev_t *smmu;
+    uint32_t nent, i, num, round, seq = 0;
+
+    HOST_CHECK(host_smmu_start(IDR0_MSI | IDR0_COHACC, 0, 16) == 0);
+    smmu = &g_smmu[0];
+    nent = 0x1u << smmu->evntq.queue.log2nent;
+    HOST_CHECK(nent == (0x1u << HOST_SMMU_EVNTQS));
+
+    /* Records are decoded field by field, CONS is written once per drain */
+    host_evtq_inject(0x12, SMMU_EVT_F_TRANSLATION, 0x345, EVTQ_1_RNW, 0xdead000);
+    host_evtq_inject(0x13, SMMU_EVT_C_BAD_STE, SMMU_EVT_ANY, EVTQ_1_S2, 0x1000);
+    host_smmu_clear_counts();
+    HOST_CHECK(val_smmu_evtq_drain(0, events, nent) == 2);
+    HOST_CHECK(host_smmu.evtq_cons_writes == 1);
+    HOST_CHECK(host_evtq_cons() == host_evtq_prod());
+    HOST_CHECK(events[0].id == SMMU_EVT_F_TRANSLATION && events[0].sid == 0x12);
+    HOST_CHECK(events[0].ssid == 0x345 && events[0].addr == 0xdead000);
+    HOST_CHECK(events[0].flags == (SMMU_EVT_FLAG_SSV | SMMU_EVT_FLAG_RNW));
+    HOST_CHECK(events[1].id == SMMU_EVT_C_BAD_STE && events[1].sid == 0x13);
+    HOST_CHECK(events[1].flags == SMMU_EVT_FLAG_S2 && events[1].addr == 0x1000);
+
+    /* An empty queue is not written back */
+    HOST_CHECK(val_smmu_evtq_drain(0, events, nent) == 0);
+    HOST_CHECK(host_smmu.evtq_cons_writes == 1);
+
+    /* Per StreamID and per type counters, events beyond max_events are still consumed */
+    val_smmu_evtq_clear_stats(0);
+    for (i = 0; i < 3; i++)
+        host_evtq_inject(1, SMMU_EVT_F_TRANSLATION, SMMU_EVT_ANY, 0, i << 12);
+    for (i = 0; i < 2; i++)
+        host_evtq_inject(1, SMMU_EVT_F_PERMISSION, SMMU_EVT_ANY, 0, i << 12);
+    for (i = 0; i < 4; i++)
+        host_evtq_inject(2, SMMU_EVT_F_TRANSLATION, SMMU_EVT_ANY, 0, i << 12);
+    host_smmu_clear_counts();
+    HOST_CHECK(val_smmu_evtq_drain(0, events, 4) == 9);
+    HOST_CHECK(host_smmu.evtq_cons_writes == 1);
+    HOST_CHECK(events[3].sid == 1 && events[3].id == SMMU_EVT_F_PERMISSION);
+    HOST_CHECK(val_smmu_evtq_get_count(0, 1, SMMU_EVT_F_TRANSLATION) == 3);
+    HOST_CHECK(val_smmu_evtq_get_count(0, 1, SMMU_EVT_F_PERMISSION) == 2);
+    HOST_CHECK(val_smmu_evtq_get_count(0, 1, SMMU_EVT_ANY) == 5);
+    HOST_CHECK(val_smmu_evtq_get_count(0, 2, SMMU_EVT_ANY) == 4);
+    HOST_CHECK(val_smmu_evtq_get_count(0, SMMU_EVT_ANY, SMMU_EVT_F_TRANSLATION) == 7);
+    HOST_CHECK(val_smmu_evtq_get_count(0, SMMU_EVT_ANY, SMMU_EVT_ANY) == 9);
+    HOST_CHECK(val_smmu_evtq_get_count(0, 3, SMMU_EVT_ANY) == 0);
+    val_smmu_evtq_clear_stats(0);
+    HOST_CHECK(val_smmu_evtq_get_count(0, SMMU_EVT_ANY, SMMU_EVT_ANY) == 0);
+
+    /* PROD and CONS wrap several times, events come out in order */
+    for (round = 0; round < 6; round++) {
+        for (i = 0; i < 3 * nent / 4; i++)
+            HOST_CHECK(host_evtq_inject(seq + i, SMMU_EVT_F_ACCESS, SMMU_EVT_ANY, 0, 0) == 1);
+        host_smmu_clear_counts();
+        num = val_smmu_evtq_drain(0, events, nent);
+        HOST_CHECK(num == 3 * nent / 4);
+        for (i = 0; i < num; i++)
+            HOST_CHECK(events[i].sid == seq + i);
+        HOST_CHECK(host_smmu.evtq_cons_writes == 1);
+        HOST_CHECK(host_evtq_cons() == host_evtq_prod());
+        seq += num;
+    }
+    HOST_CHECK(val_smmu_evtq_get_count(0, SMMU_EVT_ANY, SMMU_EVT_F_ACCESS) == seq);
+
+    /* A full queue drops new events and flags an overflow, the drain acknowledges it */
+    for (round = 1; round <= 2; round++) {
+        for (i = 0; i < nent + 5; i++)
+            HOST_CHECK(host_evtq_inject(i, SMMU_EVT_F_ACCESS, SMMU_EVT_ANY, 0, 0) == (i < nent));
+        HOST_CHECK(SMMU_QUEUE_OVF(host_evtq_prod()) != SMMU_QUEUE_OVF(host_evtq_cons()));
+        host_smmu_clear_counts();
+        HOST_CHECK(val_smmu_evtq_drain(0, events, nent) == nent);
+        HOST_CHECK(events[nent - 1].sid == nent - 1);
+        HOST_CHECK(smmu->evt_stats.overflow == round);
+        HOST_CHECK(host_smmu.evtq_cons_writes == 1);
+        HOST_CHECK(host_evtq_cons() == host_evtq_prod());
+        HOST_CHECK(val_smmu_evtq_drain(0, events, nent) == 0);
+        HOST_CHECK(host_smmu.evtq_cons_writes == 1);
+    }
+
+    printf("  evtq inject: %u entries, %u events over %u wraps, overflow acked twice\n",
+           nent, seq, seq / nent);
+    host_smmu_stop();
+    HOST_CHECK(host_allocs_live == 0);
+}
+
+/* Interrupt driven capture: the handler moves events to the capture ring read by the VAL */
+static void test_evtq_irq(void)
+{
+    smmu_event_t events[SMMU_EVT_RING_SIZE];
+    smmu_event_t evt;
+    smmu_dev_t *smmu;
+    uint32_t i, num, round, seq = 0;
+    uint64_t start;
+
+    host_smmu.evt_gsiv = 40;
+    host_smmu.gerr_gsiv = 41;
+    HOST_CHECK(host_smmu_start(IDR0_MSI | IDR0_COHACC, 0, 16) == 0);
+    smmu = &g_smmu[0];
+    HOST_CHECK(val_smmu_irq_enable(0) == 0);
+    HOST_CHECK(smmu->irq_en == (IRQ_CTRL_EVTQ_IRQEN | IRQ_CTRL_GERROR_IRQEN));
+    HOST_CHECK(host_gic_isr(40) == smmu_evtq_isr && host_gic_isr(41) == smmu_gerror_isr);
+
+    /* The ring indexes wrap, events come out in order */
+    for (round = 0; round < 5; round++) {
+        for (i = 0; i < 3 * SMMU_EVT_RING_SIZE / 4; i++)
+            host_evtq_inject(seq + i, SMMU_EVT_F_ACCESS, SMMU_EVT_ANY, 0, 0);
+        host_gic_isr(40)();
+        HOST_CHECK(host_evtq_cons() == host_evtq_prod());
+        num = val_smmu_evtq_drain(0, events, SMMU_EVT_RING_SIZE);
+        HOST_CHECK(num == 3 * SMMU_EVT_RING_SIZE / 4);
+        for (i = 0; i < num; i++)
+            HOST_CHECK(events[i].sid == seq + i);
+        seq += num;
+    }
+    HOST_CHECK(smmu->evt_head == seq && smmu->evt_tail == seq);
+    HOST_CHECK(smmu->evt_ring_dropped == 0);
+
+    /* A full ring keeps the oldest events and counts the dropped ones */
+    for (i = 0; i < SMMU_EVT_RING_SIZE + 3; i++)
+        host_evtq_inject(i, SMMU_EVT_F_ACCESS, SMMU_EVT_ANY, 0, 0);
+    host_gic_isr(40)();
+    HOST_CHECK(smmu->evt_ring_dropped == 3);
+    HOST_CHECK(val_smmu_evtq_get_count(0, SMMU_EVT_ANY, SMMU_EVT_ANY) == seq + i);
+    HOST_CHECK(val_smmu_evtq_drain(0, events, SMMU_EVT_RING_SIZE) == SMMU_EVT_RING_SIZE);
+    HOST_CHECK(events[0].sid == 0 && events[SMMU_EVT_RING_SIZE - 1].sid == SMMU_EVT_RING_SIZE - 1);
+    HOST_CHECK(val_smmu_evtq_drain(0, events, SMMU_EVT_RING_SIZE) == 0);
+
+    /* Waiting discards captured events ahead of the matching one */
+    host_evtq_inject(5, SMMU_EVT_F_TRANSLATION, SMMU_EVT_ANY, 0, 0x5000);
+    host_evtq_inject(6, SMMU_EVT_F_PERMISSION, SMMU_EVT_ANY, 0, 0x6000);
+    host_evtq_inject(7, SMMU_EVT_F_PERMISSION, SMMU_EVT_ANY, 0, 0x7000);
+    host_gic_isr(40)();
+    HOST_CHECK(val_smmu_wait_for_event(0, 6, SMMU_EVT_F_PERMISSION, 10, &evt) == 0);
+    HOST_CHECK(evt.sid == 6 && evt.addr == 0x6000);
+    HOST_CHECK(val_smmu_wait_for_event(0, SMMU_EVT_ANY, SMMU_EVT_F_PERMISSION, 0, &evt) == 0);
+    HOST_CHECK(evt.sid == 7);
+
+    /* Nothing arrives: the wait gives up after its deadline */
+    start = host_delay_us;
+    HOST_CHECK(val_smmu_wait_for_event(0, 5, SMMU_EVT_ANY, 5, NULL) == 1);
+    HOST_CHECK(host_delay_us - start == 5 * ONE_MILLISECOND);
+
+    /* Global errors are acknowledged by the handler and reported once */
+    *host_smmu_reg(SMMU_GERROR_OFFSET) ^= SMMU_GERROR_EVTQ_ABT_ERR;
+    host_gic_isr(41)();
+    HOST_CHECK(*host_smmu_reg(SMMU_GERRORN_OFFSET) == *host_smmu_reg(SMMU_GERROR_OFFSET));
+    HOST_CHECK(val_smmu_gerror_read_clear(0) == SMMU_GERROR_EVTQ_ABT_ERR);
+    HOST_CHECK(val_smmu_gerror_read_clear(0) == 0);
+
+    /* Disarmed, the same calls poll the queue and GERROR */
+    val_smmu_irq_disable(0);
+    HOST_CHECK(host_gic_isr(40) == NULL && host_gic_isr(41) == NULL);
+    host_evtq_inject(9, SMMU_EVT_C_BAD_STE, SMMU_EVT_ANY, 0, 0);
+    HOST_CHECK(val_smmu_wait_for_event(0, 9, SMMU_EVT_C_BAD_STE, 1, &evt) == 0);
+    *host_smmu_reg(SMMU_GERROR_OFFSET) ^= SMMU_GERROR_MSI_EVTQ_ABT_ERR;
+    HOST_CHECK(val_smmu_gerror_read_clear(0) == SMMU_GERROR_MSI_EVTQ_ABT_ERR);
+
+    /* A failed GERROR install releases the event queue interrupt */
+    host_gic_fail_intid = 41;
+    HOST_CHECK(val_smmu_irq_enable(0) == 1);
+    HOST_CHECK(host_gic_isr(40) == NULL);
+    HOST_CHECK(g_smmu_irq_index == ACS_INVALID_INDEX);
+    HOST_CHECK(smmu->irq_en == 0);
+    host_gic_fail_intid = 0;
+
+    printf("  evtq irq: %u events through a %u entry capture ring, %u dropped when full\n",
+           seq, SMMU_EVT_RING_SIZE, smmu->evt_ring_dropped);
+    host_smmu_stop();
+    host_smmu.evt_gsiv = 0;
+    host_smmu.gerr_gsiv = 0;
+    HOST_CHECK(host_allocs_live == 0);
+}
+
+int main(void)
+{
+    test_cmdq_batch();
+    test_master_table();
+    test_tlbi_range();
+    test_strtab_l2_span();
+    test_cdtab_pool();
+    test_evtq_inject();
+    test_evtq_irq();
+
+    printf("test_smmu: %s\n", host_failures ? "FAILED" : "PASSED");
+    return host_failures ? 1 : 0;
+}
@@ -27,6 +27,7 @@
 #include "val/common/include/acs_pe.h"
 #include "val/common/include/acs_val.h"
 #include "val/common/include/acs_memory.h"
+#include "val/common/include/acs_pgt.h"
 
 #include "BsaAcs.h"
 
@@ -68,6 +69,8 @@ extern EFI_HANDLE myImageHandle;
 extern char _textbsa;
 typedef unsigned long efi_status_t;
 efi_status_t  mem_model_execute_tests(EFI_HANDLE myImageHandle, EFI_SYSTEM_TABLE *mySystemTable);
+VOID          mem_model_set_args(CONST CHAR8 *Args);
+#define MEM_MODEL_ARGS_MAX 256
 #endif
 
 #define BSA_LEVEL_PRINT_FORMAT(level, only) ((level > BSA_MAX_LEVEL_SUPPORTED) ? \
@@ -193,6 +196,7 @@ freeBsaAcsMem()
   val_iovirt_free_info_table();
   val_peripheral_free_info_table();
   val_smbios_free_info_table();
+  val_pgt_release();
   val_free_shared_mem();
 }
 
@@ -235,6 +239,15 @@ HelpMsg (
          "-dtb    Enable the execution of dtb dump\n"
          "-sbsa   Enable sbsa requirements for bsa binary\n"
          "-el1physkip Skips EL1 register checks\n"
+#ifdef ENABLE_MEMTEST
+         "-mt     Options for memory model consistency tests, in double quotes\n"
+         "        -a <n> PEs per test, -s <n> test size, -r <n> number of runs\n"
+         "        -p <l> thread placements: any,smt,cluster,xcluster,xsocket,all\n"
+         "        -t <n> run for n seconds, -c <n> stop once rates are within n ppm\n"
+         "        -b <k> barrier: sense,dissemination,tree,timebase\n"
+         "        +bench measure barrier latency and start skew first\n"
+         "        E.g., -mt \"-s 10k -r 100 -p cluster,xcluster\"\n"
+#endif
   );
 }
 
@@ -260,6 +273,9 @@ STATIC CONST SHELL_PARAM_ITEM ParamList[] = {
   {L"-no_crypto_ext", TypeFlag},  // -no_crypto_ext  # Skip tests which have export restrictions
   {L"-mmio", TypeFlag}, // -mmio # Enable pal_mmio prints
   {L"-el1physkip", TypeFlag}, // -el1physkip # Skips EL1 register checks
+#ifdef ENABLE_MEMTEST
+  {L"-mt", TypeValue},   // -mt   # Options for memory model consistency tests
+#endif
   {NULL, TypeMax}
   };
 
@@ -553,6 +569,21 @@ ShellAppMain (
   if (ShellCommandLineGetFlag (ParamPackage, L"-el1physkip")) {
     g_el1physkip = TRUE;
   }
+
+#ifdef ENABLE_MEMTEST
+  // Options with Values
+  CmdLineArg  = ShellCommandLineGetValue (ParamPackage, L"-mt");
+  if (CmdLineArg != NULL) {
+    CHAR8 MemModelArgs[MEM_MODEL_ARGS_MAX];
+
+    if (EFI_ERROR(UnicodeStrToAsciiStrS(CmdLineArg, MemModelArgs, MEM_MODEL_ARGS_MAX))) {
+      Print(L"Invalid parameter passed for -mt\n", 0);
+      HelpMsg();
+      return SHELL_INVALID_PARAMETER;
+    }
+    mem_model_set_args(MemModelArgs);
+  }
+#endif
   //
   // Initialize global counters
   //
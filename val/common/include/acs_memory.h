@@ -39,7 +39,9 @@ void val_memory_free_aligned(void *addr);
 uint32_t val_memory_region_has_52bit_addr(void);
 
 void AA64IssueDSB(void);
+void AA64IssueTlbi(void);
 void val_mem_issue_dsb(void);
+void val_mem_issue_tlbi(void);
 uint32_t val_memory_set_wb_executable(void *addr, uint32_t size);
 
 #endif // __ACS_PERIPHERAL_H__
@@ -69,9 +69,63 @@ typedef enum {
 #define MAX_CPBM_WIDTH      32768
 #define MAX_BWPBM_WIDTH     4096
 
+/* Memory traffic engine, see val_mpam_mem_traffic */
+typedef enum {
+  MPAM_TRAFFIC_READ,
+  MPAM_TRAFFIC_WRITE,
+  MPAM_TRAFFIC_COPY
+} MPAM_TRAFFIC_MODE_e;
+
+#define MPAM_TRAFFIC_NON_TEMPORAL  0x1
+#define MPAM_TRAFFIC_CHUNK         64
+#define MPAM_TRAFFIC_PATTERN       0xA5A5A5A5A5A5A5A5ULL
+
+/* Feature ID registers of an MSC, decoded on first use. Resource specific
+   fields depend on the RIS selection, they are only cached for MSCs without
+   RIS (rsrc_valid set) */
+typedef struct {
+  uint8_t  valid;           /* MSC wide fields decoded */
+  uint8_t  rsrc_valid;      /* resource specific fields decoded */
+  /* MSC wide */
+  uint8_t  version;         /* MPAMF_AIDR */
+  uint8_t  ext_idr;
+  uint8_t  has_ris;
+  uint8_t  ris_max;
+  uint8_t  has_esr;
+  uint8_t  has_extd_esr;
+  uint8_t  has_partid_nrw;
+  uint8_t  pmg_max;
+  uint16_t partid_max;
+  uint16_t intpartid_max;   /* MPAMF_PARTID_NRW_IDR */
+  /* resource specific */
+  uint8_t  has_msmon;
+  uint8_t  has_cpor;
+  uint8_t  has_ccap;
+  uint8_t  has_mbw_part;
+  uint8_t  cmax_wd;         /* MPAMF_CCAP_IDR */
+  uint8_t  bwa_wd;          /* MPAMF_MBW_IDR */
+  uint8_t  mbw_has_min;
+  uint8_t  mbw_has_max;
+  uint8_t  mbw_has_pbm;
+  uint16_t bwpbm_wd;
+  uint16_t cpbm_wd;         /* MPAMF_CPOR_IDR */
+  uint8_t  has_mbwu;        /* MPAMF_MSMON_IDR */
+  uint8_t  has_csu;
+  uint16_t mbwumon_count;   /* MPAMF_MBWUMON_IDR */
+  uint8_t  mbwu_has_long;
+  uint8_t  mbwu_lwd;
+  uint8_t  mbwu_has_rwbw;
+  uint8_t  mbwu_scale;
+  uint8_t  csu_ro;          /* MPAMF_CSUMON_IDR */
+  uint16_t csumon_count;
+} MPAM_MSC_FEATURES;
+
 void val_mpam_reg_write(MPAM_SYS_REGS reg_id, uint64_t write_data);
 uint64_t val_mpam_reg_read(MPAM_SYS_REGS reg_id);
 uint64_t AA64ReadMpamidr(void);
+void AA64MemTrafficCopy(void *dst, void *src, uint64_t len, uint64_t non_temporal);
+uint64_t AA64MemTrafficRead(void *src, uint64_t len, uint64_t non_temporal);
+void AA64MemTrafficWrite(void *dst, uint64_t len, uint64_t pattern, uint64_t non_temporal);
 uint64_t AA64ReadMpam1(void);
 uint64_t AA64ReadMpam2(void);
 void AA64IssueDSB(void);
@@ -137,6 +191,8 @@ uint32_t val_mpam_mmr_read(uint32_t msc_index, uint32_t reg_offset);
 uint64_t val_mpam_mmr_read64(uint32_t msc_index, uint32_t reg_offset);
 void     val_mpam_mmr_write(uint32_t msc_index, uint32_t reg_offset, uint32_t data);
 void     val_mpam_mmr_write64(uint32_t msc_index, uint32_t reg_offset, uint64_t data);
+uint64_t val_mpam_mem_traffic(MPAM_TRAFFIC_MODE_e mode, void *dst, void *src,
+                              uint64_t size, uint32_t flags);
 uint32_t val_mpam_pcc_read(uint32_t msc_index, uint32_t reg_offset);
 void     val_mpam_pcc_write(uint32_t msc_index, uint32_t reg_offset, uint32_t data);
 
@@ -403,6 +403,12 @@ uint64_t AA64ReadTrcidr5(void);
 
 void ArmCallWFI(void);
 
+uint64_t AA64ReadDaif(void);
+
+void AA64WriteDaif(uint64_t daif);
+
+void AA64MaskIrq(void);
+
 void ArmExecuteMemoryBarrier(void);
 
 void val_pe_update_elr(void *context, uint64_t offset);
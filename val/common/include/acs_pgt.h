@@ -21,6 +21,9 @@
 #define PGT_STAGE1 1
 #define PGT_STAGE2 2
 
+/* pgt_descriptor_t flags */
+#define PGT_FLAG_SHARE 0x1  /* new tables may be shared with identical requests */
+
 #define PGT_ENTRY_TABLE_MASK (0x1 << 1)
 #define PGT_ENTRY_VALID_MASK  0x1ULL
 #define PGT_ENTRY_PAGE_MASK  (0x1 << 1)
@@ -31,6 +34,13 @@
 #define PGT_ENTRY_TYPE_BLOCK  0x1
 #define PGT_ENTRY_TYPE_PAGE   0x3
 
+#define PGT_ENTRY_CONTIG_MASK (0x1ull << 52)
+
+/* Entries of a run marked with the contiguous hint */
+#define PGT_CONTIG_ENTRIES_4K      16
+#define PGT_CONTIG_ENTRIES_16K_L3  128
+#define PGT_CONTIG_ENTRIES_DEFAULT 32
+
 #define IS_PGT_ENTRY_PAGE(val)  ((val & PGT_ENTRY_TYPE_MASK) == PGT_ENTRY_TYPE_PAGE)
 #define IS_PGT_ENTRY_BLOCK(val) ((val & PGT_ENTRY_TYPE_MASK) == PGT_ENTRY_TYPE_BLOCK)
 #define IS_PGT_ENTRY_TABLE(val) ((val & PGT_ENTRY_TYPE_MASK) == PGT_ENTRY_TYPE_TABLE)
@@ -65,5 +75,8 @@
 uint32_t val_pgt_create(memory_region_descriptor_t *mem_desc, pgt_descriptor_t *pgt_desc);
 void val_pgt_destroy(pgt_descriptor_t pgt_desc);
 uint64_t val_pgt_get_attributes(pgt_descriptor_t pgt_desc, uint64_t virtual_address, uint64_t *attributes);
+uint64_t val_pgt_get_attributes_range(pgt_descriptor_t pgt_desc, uint64_t virtual_address,
+                                      uint32_t num_pages, uint64_t *attributes);
+void val_pgt_release(void);
 
 #endif
@@ -38,6 +38,61 @@
 #define SMMU_V3_IDR1_PASID_SHIFT   0x6
 #define SMMU_V3_IDR1_PASID_MASK    0x1f
 
+/* SMMUv3 event record types */
+#define SMMU_EVT_F_UUT               0x01
+#define SMMU_EVT_C_BAD_STREAMID      0x02
+#define SMMU_EVT_F_STE_FETCH         0x03
+#define SMMU_EVT_C_BAD_STE           0x04
+#define SMMU_EVT_F_BAD_ATS_TREQ      0x05
+#define SMMU_EVT_F_STREAM_DISABLED   0x06
+#define SMMU_EVT_F_TRANSL_FORBIDDEN  0x07
+#define SMMU_EVT_C_BAD_SUBSTREAMID   0x08
+#define SMMU_EVT_F_CD_FETCH          0x09
+#define SMMU_EVT_C_BAD_CD            0x0A
+#define SMMU_EVT_F_WALK_EABT         0x0B
+#define SMMU_EVT_F_TRANSLATION       0x10
+#define SMMU_EVT_F_ADDR_SIZE         0x11
+#define SMMU_EVT_F_ACCESS            0x12
+#define SMMU_EVT_F_PERMISSION        0x13
+#define SMMU_EVT_F_TLB_CONFLICT      0x20
+#define SMMU_EVT_F_CFG_CONFLICT      0x21
+#define SMMU_EVT_E_PAGE_REQUEST      0x24
+#define SMMU_EVT_F_VMS_FETCH         0x25
+#define SMMU_EVT_ID_MAX              0x26
+
+#define SMMU_EVT_ANY                 0xFFFFFFFF  /* wildcard StreamID or type */
+
+/* Decoded event flags */
+#define SMMU_EVT_FLAG_SSV            0x1   /* ssid valid */
+#define SMMU_EVT_FLAG_RNW            0x2   /* faulting access was a read */
+#define SMMU_EVT_FLAG_S2             0x4   /* fault raised by stage 2 */
+
+typedef struct {
+    uint32_t id;        /* SMMU_EVT_* type */
+    uint32_t sid;
+    uint32_t ssid;
+    uint32_t flags;     /* SMMU_EVT_FLAG_* */
+    uint64_t addr;      /* input address of the faulting access */
+} smmu_event_t;
+
+/* Distinct (StreamID, type) pairs counted per SMMU */
+#define SMMU_EVT_PAIR_MAX            64
+
+typedef struct {
+    uint32_t sid;
+    uint32_t id;
+    uint32_t count;
+} smmu_evt_count_t;
+
+typedef struct {
+    uint32_t total;
+    uint32_t overflow;                  /* EVTQ overflows, events were lost */
+    uint32_t untracked;                 /* events of pairs beyond SMMU_EVT_PAIR_MAX */
+    uint32_t type_cnt[SMMU_EVT_ID_MAX];
+    uint32_t num_pairs;
+    smmu_evt_count_t pair[SMMU_EVT_PAIR_MAX];
+} smmu_evt_stats_t;
+
 uint64_t
 val_smmu_ssid_bits(uint32_t smmu_index);
 
@@ -76,9 +131,34 @@ val_smmu_map(smmu_master_attributes_t master,
 void
 val_smmu_unmap(smmu_master_attributes_t master);
 
+uint32_t
+val_smmu_tlbi_range(smmu_master_attributes_t master, uint64_t iova, uint64_t size);
+
 void
 val_smmu_dump_eventq(void);
 
+uint32_t
+val_smmu_evtq_drain(uint32_t smmu_index, smmu_event_t *events, uint32_t max_events);
+
+uint32_t
+val_smmu_evtq_get_count(uint32_t smmu_index, uint32_t sid, uint32_t id);
+
+void
+val_smmu_evtq_clear_stats(uint32_t smmu_index);
+
+uint32_t
+val_smmu_irq_enable(uint32_t smmu_index);
+
+void
+val_smmu_irq_disable(uint32_t smmu_index);
+
+uint32_t
+val_smmu_wait_for_event(uint32_t smmu_index, uint32_t sid, uint32_t id,
+                        uint32_t timeout_ms, smmu_event_t *event);
+
+uint32_t
+val_smmu_gerror_read_clear(uint32_t smmu_index);
+
 uint32_t val_smmu_config_ste_dcp(smmu_master_attributes_t master, uint32_t value);
 
 #endif
@@ -477,6 +477,8 @@ uint32_t pal_pcie_bar_mem_write(uint32_t bdf, uint64_t address, uint32_t data);
 typedef struct {
   uint32_t arch_major_rev;  ///< Version 1 or 2 or 3
   addr_t base;              ///< SMMU Controller base address
+  uint32_t event_gsiv;      ///< SMMUv3 event queue wired interrupt, 0 if none
+  uint32_t gerr_gsiv;       ///< SMMUv3 global error wired interrupt, 0 if none
 }SMMU_INFO_BLOCK;
 
 typedef struct {
@@ -593,6 +595,7 @@ typedef struct {
     uint64_t mair;
     uint32_t stage;
     PE_TCR_BF tcr;
+    uint32_t flags;
 } pgt_descriptor_t;
 
 typedef struct {
@@ -1127,6 +1130,13 @@ typedef struct {
   uint64_t                         cmd_complete_update_preserve;
                                                             /* command complete update preserve */
   uint64_t                         cmd_complete_update_set; /* command complete update set mask */
+  ACPI_GENERIC_ADDRESS_STRUCTURE   error_status_reg;        /* error status register */
+  uint64_t                         error_status_mask;       /* error status mask */
+  uint32_t                         platform_intr;           /* platform interrupt GSIV, 0 if none */
+  ACPI_GENERIC_ADDRESS_STRUCTURE   platform_intr_ack_reg;   /* platform interrupt ack register */
+  uint64_t                         platform_intr_ack_preserve;
+                                                            /* platform interrupt ack preserve */
+  uint64_t                         platform_intr_ack_set;   /* platform interrupt ack set mask */
 } PCC_SUBSPACE_TYPE_3;
 
 typedef union {
@@ -211,7 +211,11 @@ typedef enum {
   SMMU_IOVIRT_BLOCK,
   SMMU_SSID_BITS,
   SMMU_IN_ADDR_SIZE,
-  SMMU_OUT_ADDR_SIZE
+  SMMU_OUT_ADDR_SIZE,
+  SMMU_CTRL_EVENT_GSIV,
+  SMMU_CTRL_GERR_GSIV,
+  SMMU_STRTAB_MEM_SIZE,
+  SMMU_CDTAB_POOL_ALLOCS
 }SMMU_INFO_e;
 
 typedef enum {
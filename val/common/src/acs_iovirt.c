@@ -65,6 +65,10 @@ val_iovirt_get_smmu_info(SMMU_INFO_e type, uint32_t index)
                       return block->data.smmu.base;
                   case SMMU_IOVIRT_BLOCK:
                       return (uint64_t)block;
+                  case SMMU_CTRL_EVENT_GSIV:
+                      return block->data.smmu.event_gsiv;
+                  case SMMU_CTRL_GERR_GSIV:
+                      return block->data.smmu.gerr_gsiv;
                   default:
                       val_print(ACS_PRINT_ERR, "This SMMU info option not supported %d\n", type);
                       return 0;
@@ -413,3 +413,17 @@ val_mem_issue_dsb(void)
     AA64IssueDSB();
 #endif
 }
+
+/**
+  @brief   This API invalidates the TLB entries of the current translation regime
+           and waits for the invalidation to complete
+  @param   None
+  @return  None
+**/
+void
+val_mem_issue_tlbi(void)
+{
+#ifndef TARGET_LINUX
+    AA64IssueTlbi();
+#endif
+}
@@ -151,12 +151,12 @@ uint32_t
 val_mmu_add_entry(uint64_t base_addr, uint64_t size)
 {
   pgt_descriptor_t pgt_desc;
-  memory_region_descriptor_t mem_desc;
+  memory_region_descriptor_t mem_desc[2];
   uint64_t ttbr;
   const uint32_t oas_bit_arr[7] = {32, 36, 40, 42, 44, 48, 52}; /* Physical address sizes */
 
   /* init descriptors */
-  val_memory_set(&mem_desc, sizeof(mem_desc), 0);
+  val_memory_set(mem_desc, sizeof(mem_desc), 0);
   val_memory_set(&pgt_desc, sizeof(pgt_desc), 0);
 
   /* Get translation attributes from TCR and translation table base from TTBR */
@@ -180,14 +180,17 @@ val_mmu_add_entry(uint64_t base_addr, uint64_t size)
   val_print(ACS_PRINT_DEBUG, "\n   Input addr size in bits (ias) = %d", pgt_desc.ias);
   val_print(ACS_PRINT_DEBUG, "\n   Output addr size in bits (oas) = %d\n", pgt_desc.oas);
 
-  /* populate mem descriptor structure with addr region to be mapped and attributes */
-  mem_desc.virtual_address = base_addr;
-  mem_desc.physical_address = base_addr;
-  mem_desc.length = size;
-  mem_desc.attributes = ATTR_DEVICE_nGnRnE | (1ull << MEM_ATTR_AF_SHIFT);
-
-  /* update translation table entry(s) for addr region defined by memory descriptor structure  */
-  if (val_pgt_create(&mem_desc, &pgt_desc)) {
+  /* populate mem descriptor structure with addr region to be mapped and attributes,
+     the zero length entry ends the list */
+  mem_desc[0].virtual_address = base_addr;
+  mem_desc[0].physical_address = base_addr;
+  mem_desc[0].length = size;
+  mem_desc[0].attributes = ATTR_DEVICE_nGnRnE | (1ull << MEM_ATTR_AF_SHIFT);
+
+  /* update translation table entry(s) for addr region defined by memory descriptor structure.
+     These are the live TTBR0 tables, val_pgt_create replaces valid entries with
+     break-before-make */
+  if (val_pgt_create(mem_desc, &pgt_desc)) {
       val_print(ACS_PRINT_ERR, "   Failed to create MMU translation entry(s)\n", 0);
       return 1;
   }
@@ -23,8 +23,13 @@
 #include "common/include/acs_memory.h"
 #include "sbsa/include/sbsa_val_interface.h"
 #include "common/include/acs_mpam_reg.h"
+#include "common/include/acs_timer_support.h"
 
 static MPAM_INFO_TABLE *g_mpam_info_table;
+/* MSC nodes are variable length, index them once for O(1) access */
+static MPAM_MSC_NODE **g_mpam_msc_index;
+/* Decoded MSC feature ID registers, indexed by MSC index */
+static MPAM_MSC_FEATURES *g_mpam_msc_feat;
 static SRAT_INFO_TABLE *g_srat_info_table;
 static HMAT_INFO_TABLE *g_hmat_info_table;
 
@@ -81,6 +86,31 @@ val_mpam_reg_write(MPAM_SYS_REGS reg_id, uint64_t write_data)
   return;
 }
 
+/**
+  @brief   This API returns the MSC node at msc_index, from the index built by
+           val_mpam_create_info_table, or by walking the table if there is none.
+
+  @param   msc_index  - index of the MSC node in the MPAM info table.
+
+  @return  pointer to the MSC node.
+**/
+static
+MPAM_MSC_NODE *
+mpam_get_msc_node(uint32_t msc_index)
+{
+  uint32_t i;
+  MPAM_MSC_NODE *msc_entry;
+
+  if (g_mpam_msc_index != NULL)
+      return g_mpam_msc_index[msc_index];
+
+  msc_entry = &g_mpam_info_table->msc_node[0];
+  for (i = 0; i < msc_index; i++)
+      msc_entry = MPAM_NEXT_MSC(msc_entry);
+
+  return msc_entry;
+}
+
 /**
   @brief   This API returns requested MSC or resource info.
 
@@ -94,7 +124,6 @@ val_mpam_reg_write(MPAM_SYS_REGS reg_id, uint64_t write_data)
 uint64_t
 val_mpam_get_info(MPAM_INFO_e type, uint32_t msc_index, uint32_t rsrc_index)
 {
-  uint32_t i = 0;
   MPAM_MSC_NODE *msc_entry;
 
   if (g_mpam_info_table == NULL) {
@@ -102,58 +131,52 @@ val_mpam_get_info(MPAM_INFO_e type, uint32_t msc_index, uint32_t rsrc_index)
       return MPAM_INVALID_INFO;
   }
 
-  if (msc_index > g_mpam_info_table->msc_count) {
+  if (msc_index >= g_mpam_info_table->msc_count) {
       val_print(ACS_PRINT_ERR, "Invalid MSC index = 0x%lx ", msc_index);
       return 0;
   }
 
-  /* Walk the MPAM info table and return requested info */
-  msc_entry = &g_mpam_info_table->msc_node[0];
-  for (i = 0; i < g_mpam_info_table->msc_count; i++, msc_entry = MPAM_NEXT_MSC(msc_entry)) {
-      if (msc_index == i) {
-          if (rsrc_index > msc_entry->rsrc_count - 1) {
-              val_print(ACS_PRINT_ERR,
-                      "\n   Invalid MSC resource index = 0x%lx for", rsrc_index);
-              val_print(ACS_PRINT_ERR, "MSC index = 0x%lx ", msc_index);
-              return MPAM_INVALID_INFO;
-          }
-          switch (type) {
-          case MPAM_MSC_RSRC_COUNT:
-              return msc_entry->rsrc_count;
-          case MPAM_MSC_RSRC_RIS:
-              return msc_entry->rsrc_node[rsrc_index].ris_index;
-          case MPAM_MSC_RSRC_TYPE:
-              return msc_entry->rsrc_node[rsrc_index].locator_type;
-          case MPAM_MSC_RSRC_DESC1:
-              return msc_entry->rsrc_node[rsrc_index].descriptor1;
-          case MPAM_MSC_RSRC_DESC2:
-              return msc_entry->rsrc_node[rsrc_index].descriptor2;
-          case MPAM_MSC_BASE_ADDR:
-              return msc_entry->msc_base_addr;
-          case MPAM_MSC_ADDR_LEN:
-              return msc_entry->msc_addr_len;
-          case MPAM_MSC_NRDY:
-              return msc_entry->max_nrdy;
-          case MPAM_MSC_OF_INTR:
-              return msc_entry->of_intr;
-          case MPAM_MSC_OF_INTR_FLAGS:
-              return msc_entry->of_intr_flags;
-          case MPAM_MSC_ERR_INTR:
-              return msc_entry->err_intr;
-          case MPAM_MSC_ERR_INTR_FLAGS:
-              return msc_entry->err_intr_flags;
-          case MPAM_MSC_ID:
-              return msc_entry->identifier;
-          case MPAM_MSC_INTERFACE_TYPE:
-              return msc_entry->intrf_type;
-          default:
-              val_print(ACS_PRINT_ERR,
-                       "\n   This MPAM info option for type %d is not supported", type);
-              return MPAM_INVALID_INFO;
-          }
-      }
+  msc_entry = mpam_get_msc_node(msc_index);
+  if (rsrc_index > msc_entry->rsrc_count - 1) {
+      val_print(ACS_PRINT_ERR,
+              "\n   Invalid MSC resource index = 0x%lx for", rsrc_index);
+      val_print(ACS_PRINT_ERR, "MSC index = 0x%lx ", msc_index);
+      return MPAM_INVALID_INFO;
+  }
+  switch (type) {
+  case MPAM_MSC_RSRC_COUNT:
+      return msc_entry->rsrc_count;
+  case MPAM_MSC_RSRC_RIS:
+      return msc_entry->rsrc_node[rsrc_index].ris_index;
+  case MPAM_MSC_RSRC_TYPE:
+      return msc_entry->rsrc_node[rsrc_index].locator_type;
+  case MPAM_MSC_RSRC_DESC1:
+      return msc_entry->rsrc_node[rsrc_index].descriptor1;
+  case MPAM_MSC_RSRC_DESC2:
+      return msc_entry->rsrc_node[rsrc_index].descriptor2;
+  case MPAM_MSC_BASE_ADDR:
+      return msc_entry->msc_base_addr;
+  case MPAM_MSC_ADDR_LEN:
+      return msc_entry->msc_addr_len;
+  case MPAM_MSC_NRDY:
+      return msc_entry->max_nrdy;
+  case MPAM_MSC_OF_INTR:
+      return msc_entry->of_intr;
+  case MPAM_MSC_OF_INTR_FLAGS:
+      return msc_entry->of_intr_flags;
+  case MPAM_MSC_ERR_INTR:
+      return msc_entry->err_intr;
+  case MPAM_MSC_ERR_INTR_FLAGS:
+      return msc_entry->err_intr_flags;
+  case MPAM_MSC_ID:
+      return msc_entry->identifier;
+  case MPAM_MSC_INTERFACE_TYPE:
+      return msc_entry->intrf_type;
+  default:
+      val_print(ACS_PRINT_ERR,
+               "\n   This MPAM info option for type %d is not supported", type);
+      return MPAM_INVALID_INFO;
   }
-  return MPAM_INVALID_INFO;
 }
 
 /**
@@ -282,6 +305,97 @@ val_mpam_get_msc_count(void)
         return g_mpam_info_table->msc_count;
 }
 
+/**
+  @brief   This API returns the decoded feature ID registers of an MSC. The ID
+           registers are read on the first call for each MSC, since MSCs behind
+           a PCC interface are only reachable once the PCC table is created.
+  @param   msc_index - index of the MSC node in the MPAM info table.
+  @param   rsrc      - 1 if resource specific fields are needed.
+  @return  decoded features, NULL if not cached, the caller then reads the
+           registers.
+**/
+static
+MPAM_MSC_FEATURES *
+mpam_get_msc_feat(uint32_t msc_index, uint32_t rsrc)
+{
+  MPAM_MSC_FEATURES *feat;
+  uint64_t idr;
+  uint32_t data;
+
+  if ((g_mpam_msc_feat == NULL) || (msc_index >= g_mpam_info_table->msc_count))
+      return NULL;
+
+  feat = &g_mpam_msc_feat[msc_index];
+  if (!feat->valid) {
+      idr = val_mpam_mmr_read64(msc_index, REG_MPAMF_IDR);
+
+      feat->version = BITFIELD_READ(AIDR_VERSION, val_mpam_mmr_read(msc_index, REG_MPAMF_AIDR));
+      feat->partid_max = BITFIELD_READ(IDR_PARTID_MAX, idr);
+      feat->pmg_max = BITFIELD_READ(IDR_PMG_MAX, idr);
+      feat->has_partid_nrw = BITFIELD_READ(IDR_HAS_PARTID_NRW, idr);
+      if (feat->has_partid_nrw)
+          feat->intpartid_max = BITFIELD_READ(INTPARTID_MAX,
+                                   val_mpam_mmr_read(msc_index, REG_MPAMF_PARTID_NRW_IDR));
+
+      /* upper half of MPAMF_IDR is only implemented with MPAMF_IDR.EXT */
+      feat->ext_idr = BITFIELD_READ(IDR_EXT, idr);
+      if (feat->ext_idr) {
+          feat->has_ris = BITFIELD_READ(IDR_HAS_RIS, idr);
+          feat->ris_max = feat->has_ris ? BITFIELD_READ(IDR_RIS_MAX, idr) : 0;
+          feat->has_esr = BITFIELD_READ(IDR_HAS_ESR, idr);
+          feat->has_extd_esr = BITFIELD_READ(IDR_HAS_EXTD_ESR, idr);
+      }
+
+      if (!feat->has_ris) {
+          feat->has_msmon = BITFIELD_READ(IDR_HAS_MSMON, idr);
+          feat->has_cpor = BITFIELD_READ(IDR_HAS_CPOR_PART, idr);
+          feat->has_ccap = BITFIELD_READ(IDR_HAS_CCAP_PART, idr);
+          feat->has_mbw_part = BITFIELD_READ(IDR_HAS_MBW_PART, idr);
+
+          if (feat->has_cpor)
+              feat->cpbm_wd = BITFIELD_READ(CPOR_IDR_CPBM_WD,
+                                 val_mpam_mmr_read(msc_index, REG_MPAMF_CPOR_IDR));
+          if (feat->has_ccap)
+              feat->cmax_wd = BITFIELD_READ(CMAX_WD,
+                                 val_mpam_mmr_read(msc_index, REG_MPAMF_CCAP_IDR));
+          if (feat->has_mbw_part) {
+              data = val_mpam_mmr_read(msc_index, REG_MPAMF_MBW_IDR);
+              feat->bwa_wd = BITFIELD_READ(BWA_WD, data);
+              feat->mbw_has_min = BITFIELD_READ(HAS_MIN, data);
+              feat->mbw_has_max = BITFIELD_READ(HAS_MAX, data);
+              feat->mbw_has_pbm = BITFIELD_READ(HAS_PBM, data);
+              feat->bwpbm_wd = BITFIELD_READ(BWPBM_WD, data);
+          }
+
+          if (feat->has_msmon) {
+              data = val_mpam_mmr_read(msc_index, REG_MPAMF_MSMON_IDR);
+              feat->has_mbwu = BITFIELD_READ(MSMON_IDR_MSMON_MBWU, data);
+              feat->has_csu = BITFIELD_READ(MSMON_IDR_MSMON_CSU, data);
+          }
+          if (feat->has_mbwu) {
+              data = val_mpam_mmr_read(msc_index, REG_MPAMF_MBWUMON_IDR);
+              feat->mbwumon_count = BITFIELD_READ(MBWUMON_IDR_NUM_MON, data);
+              feat->mbwu_has_long = BITFIELD_READ(MBWUMON_IDR_HAS_LONG, data);
+              feat->mbwu_lwd = BITFIELD_READ(MBWUMON_IDR_LWD, data);
+              feat->mbwu_has_rwbw = BITFIELD_READ(MBWUMON_IDR_HAS_RWBW, data);
+              feat->mbwu_scale = BITFIELD_READ(MBWUMON_IDR_SCALE, data);
+          }
+          if (feat->has_csu) {
+              data = val_mpam_mmr_read(msc_index, REG_MPAMF_CSUMON_IDR);
+              feat->csumon_count = BITFIELD_READ(CSUMON_IDR_NUM_MON, data);
+              feat->csu_ro = BITFIELD_READ(CSUMON_IDR_CSU_RO, data);
+          }
+          feat->rsrc_valid = 1;
+      }
+      feat->valid = 1;
+  }
+
+  if (rsrc && !feat->rsrc_valid)
+      return NULL;
+
+  return feat;
+}
+
 /**
  * @brief   This API returns maximum RIS value supported in MPAMCFG_PART_SEL.
  *
@@ -291,6 +405,11 @@ val_mpam_get_msc_count(void)
 uint32_t
 val_mpam_get_max_ris_count(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 0);
+
+    if (feat != NULL)
+        return feat->ris_max;
+
     if (val_mpam_msc_supports_ris(msc_index)) {
         return BITFIELD_READ(IDR_RIS_MAX, val_mpam_mmr_read64(msc_index, REG_MPAMF_IDR));
     }
@@ -306,6 +425,11 @@ val_mpam_get_max_ris_count(uint32_t msc_index)
 uint32_t
 val_mpam_msc_get_version(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 0);
+
+    if (feat != NULL)
+        return feat->version;
+
     return BITFIELD_READ(AIDR_VERSION, val_mpam_mmr_read(msc_index, REG_MPAMF_AIDR));
 }
 
@@ -317,6 +441,11 @@ val_mpam_msc_get_version(uint32_t msc_index)
 uint32_t
 val_mpam_msc_supports_mon(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->has_msmon;
+
     return BITFIELD_READ(IDR_HAS_MSMON, val_mpam_mmr_read64(msc_index, REG_MPAMF_IDR));
 }
 
@@ -328,6 +457,11 @@ val_mpam_msc_supports_mon(uint32_t msc_index)
 uint32_t
 val_mpam_supports_cpor(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->has_cpor;
+
     return BITFIELD_READ(IDR_HAS_CPOR_PART, val_mpam_mmr_read64(msc_index, REG_MPAMF_IDR));
 }
 
@@ -339,6 +473,11 @@ val_mpam_supports_cpor(uint32_t msc_index)
 uint32_t
 val_mpam_supports_ccap(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->has_ccap;
+
     return BITFIELD_READ(IDR_HAS_CCAP_PART, val_mpam_mmr_read64(msc_index, REG_MPAMF_IDR));
 }
 
@@ -350,6 +489,11 @@ val_mpam_supports_ccap(uint32_t msc_index)
 uint32_t
 val_mpam_msc_supports_ext_idr(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 0);
+
+    if (feat != NULL)
+        return feat->ext_idr;
+
     return BITFIELD_READ(IDR_EXT, val_mpam_mmr_read64(msc_index, REG_MPAMF_IDR));
 }
 
@@ -362,6 +506,11 @@ val_mpam_msc_supports_ext_idr(uint32_t msc_index)
 uint32_t
 val_mpam_msc_supports_ris(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 0);
+
+    if (feat != NULL)
+        return feat->has_ris;
+
     if (val_mpam_msc_supports_ext_idr(msc_index))
       return BITFIELD_READ(IDR_HAS_RIS, val_mpam_mmr_read64(msc_index, REG_MPAMF_IDR));
 
@@ -377,6 +526,11 @@ val_mpam_msc_supports_ris(uint32_t msc_index)
 uint32_t
 val_mpam_msc_supports_extd_esr(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 0);
+
+    if (feat != NULL)
+        return feat->has_extd_esr;
+
     if (val_mpam_msc_supports_ext_idr(msc_index))
       return BITFIELD_READ(IDR_HAS_EXTD_ESR, val_mpam_mmr_read64(msc_index, REG_MPAMF_IDR));
 
@@ -392,6 +546,11 @@ val_mpam_msc_supports_extd_esr(uint32_t msc_index)
 uint32_t
 val_mpam_msc_supports_esr(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 0);
+
+    if (feat != NULL)
+        return feat->has_esr;
+
     if (val_mpam_msc_supports_ext_idr(msc_index))
       return BITFIELD_READ(IDR_HAS_ESR, val_mpam_mmr_read64(msc_index, REG_MPAMF_IDR));
 
@@ -409,6 +568,11 @@ val_mpam_msc_supports_esr(uint32_t msc_index)
 uint32_t
 val_mpam_msc_supports_mbwumon(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->has_mbwu;
+
     if (val_mpam_msc_supports_mon(msc_index))
         return BITFIELD_READ(MSMON_IDR_MSMON_MBWU,
                    val_mpam_mmr_read(msc_index, REG_MPAMF_MSMON_IDR));
@@ -427,6 +591,10 @@ val_mpam_msc_supports_mbwumon(uint32_t msc_index)
 uint32_t
 val_mpam_msc_supports_mbwpart(uint32_t msc_index)
 {
+  MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+  if (feat != NULL)
+      return feat->has_mbw_part;
 
   return BITFIELD_READ(IDR_HAS_MBW_PART,
                    val_mpam_mmr_read(msc_index, REG_MPAMF_IDR));
@@ -443,6 +611,10 @@ val_mpam_msc_supports_mbwpart(uint32_t msc_index)
 uint32_t
 val_mpam_msc_supports_mbwpbm(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->mbw_has_pbm;
 
     if (val_mpam_msc_supports_mbwpart(msc_index))
         return BITFIELD_READ(HAS_PBM,
@@ -462,6 +634,10 @@ val_mpam_msc_supports_mbwpbm(uint32_t msc_index)
 uint32_t
 val_mpam_msc_supports_mbw_min(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->mbw_has_min;
 
     if (val_mpam_msc_supports_mbwpart(msc_index))
         return BITFIELD_READ(HAS_MIN,
@@ -481,6 +657,10 @@ val_mpam_msc_supports_mbw_min(uint32_t msc_index)
 uint32_t
 val_mpam_msc_supports_mbw_max(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->mbw_has_max;
 
     if (val_mpam_msc_supports_mbwpart(msc_index))
         return BITFIELD_READ(HAS_MAX,
@@ -497,6 +677,10 @@ val_mpam_msc_supports_mbw_max(uint32_t msc_index)
 uint32_t
 val_mpam_msc_supports_partid_nrw(uint32_t msc_index)
 {
+  MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 0);
+
+  if (feat != NULL)
+      return feat->has_partid_nrw;
 
   return BITFIELD_READ(IDR_HAS_PARTID_NRW,
                    val_mpam_mmr_read64(msc_index, REG_MPAMF_IDR));
@@ -513,6 +697,11 @@ val_mpam_msc_supports_partid_nrw(uint32_t msc_index)
 uint32_t
 val_mpam_get_mbwumon_count(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->mbwumon_count;
+
     return BITFIELD_READ(MBWUMON_IDR_NUM_MON, val_mpam_mmr_read(msc_index, REG_MPAMF_MBWUMON_IDR));
 }
 
@@ -552,6 +741,11 @@ val_mpam_msc_get_mscbw(uint32_t msc_index, uint32_t rsrc_index)
 uint32_t
 val_mpam_mbwu_supports_long(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->mbwu_has_long;
+
     return BITFIELD_READ(MBWUMON_IDR_HAS_LONG,
                 val_mpam_mmr_read(msc_index, REG_MPAMF_MBWUMON_IDR));
 }
@@ -564,6 +758,11 @@ val_mpam_mbwu_supports_long(uint32_t msc_index)
 uint32_t
 val_mpam_mbwu_supports_lwd(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->mbwu_lwd;
+
     return BITFIELD_READ(MBWUMON_IDR_LWD, val_mpam_mmr_read(msc_index, REG_MPAMF_MBWUMON_IDR));
 }
 
@@ -578,6 +777,11 @@ val_mpam_mbwu_supports_lwd(uint32_t msc_index)
 uint32_t
 val_mpam_supports_csumon(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->has_csu;
+
     if (val_mpam_msc_supports_mon(msc_index))
         return BITFIELD_READ(MSMON_IDR_MSMON_CSU,
                    val_mpam_mmr_read(msc_index, REG_MPAMF_MSMON_IDR));
@@ -596,6 +800,11 @@ val_mpam_supports_csumon(uint32_t msc_index)
 uint32_t
 val_mpam_get_csumon_count(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->csumon_count;
+
     return BITFIELD_READ(CSUMON_IDR_NUM_MON, val_mpam_mmr_read(msc_index, REG_MPAMF_CSUMON_IDR));
 }
 
@@ -644,6 +853,7 @@ void
 val_mpam_memory_configure_mbwumon(uint32_t msc_index)
 {
     uint32_t data = 0;
+    MPAM_MSC_FEATURES *feat;
 
     /* select monitor instance zero by writing zero to MSMON_CFG_MON_SEL.MON_SEL */
     data = val_mpam_mmr_read(msc_index, REG_MSMON_CFG_MON_SEL);
@@ -659,7 +869,9 @@ val_mpam_memory_configure_mbwumon(uint32_t msc_index)
     val_mpam_mmr_write(msc_index, REG_MSMON_CFG_MBWU_CTL, data);
 
     /* Check if MPAMF_MBWUMON_IDR supports RW bandwidth selection */
-    if (BITFIELD_READ(MBWUMON_IDR_HAS_RWBW, val_mpam_mmr_read64(msc_index, REG_MPAMF_MBWUMON_IDR)))
+    feat = mpam_get_msc_feat(msc_index, 1);
+    if ((feat != NULL) ? feat->mbwu_has_rwbw :
+        BITFIELD_READ(MBWUMON_IDR_HAS_RWBW, val_mpam_mmr_read64(msc_index, REG_MPAMF_MBWUMON_IDR)))
     {
         /* If true, configure monitor filter reg to count both read and write bandwidth */
         data = BITFIELD_SET(MBWU_FLT_RWBW, MBWU_FLT_RWBW_RW);
@@ -721,11 +933,11 @@ uint64_t
 val_mpam_memory_mbwumon_read_count(uint32_t msc_index)
 {
     uint64_t count = MPAM_MON_NOT_READY;
+    MPAM_MSC_FEATURES *feat;
 
     /*if MSMON_MBWU_L is implemented*/
-    if (BITFIELD_READ(MBWUMON_IDR_LWD, val_mpam_mmr_read64(msc_index, REG_MPAMF_MBWUMON_IDR))) {
-        if (BITFIELD_READ(MBWUMON_IDR_HAS_LONG,
-            val_mpam_mmr_read64(msc_index, REG_MPAMF_MBWUMON_IDR))) {
+    if (val_mpam_mbwu_supports_lwd(msc_index)) {
+        if (val_mpam_mbwu_supports_long(msc_index)) {
             // (63 bits)
             if (BITFIELD_READ(MSMON_MBWU_L_NRDY,
                 val_mpam_mmr_read64(msc_index, REG_MSMON_MBWU_L)) == 0)
@@ -746,8 +958,12 @@ val_mpam_memory_mbwumon_read_count(uint32_t msc_index)
             count = BITFIELD_READ(MSMON_MBWU_VALUE,
                                   val_mpam_mmr_read(msc_index, REG_MSMON_MBWU));
             /* shift the count if scaling is enabled */
-            count = count << BITFIELD_READ(MBWUMON_IDR_SCALE,
-                                  val_mpam_mmr_read(msc_index, REG_MPAMF_MBWUMON_IDR));
+            feat = mpam_get_msc_feat(msc_index, 1);
+            if (feat != NULL)
+                count = count << feat->mbwu_scale;
+            else
+                count = count << BITFIELD_READ(MBWUMON_IDR_SCALE,
+                                      val_mpam_mmr_read(msc_index, REG_MPAMF_MBWUMON_IDR));
         }
     }
     return(count);
@@ -765,7 +981,7 @@ void
 val_mpam_memory_mbwumon_reset(uint32_t msc_index)
 {
     /*if MSMON_MBWU_L is implemented*/
-    if (BITFIELD_READ(MBWUMON_IDR_LWD, val_mpam_mmr_read64(msc_index, REG_MPAMF_MBWUMON_IDR)))
+    if (val_mpam_mbwu_supports_lwd(msc_index))
         val_mpam_mmr_write64(msc_index, REG_MSMON_MBWU_L, 0);
     else
        val_mpam_mmr_write(msc_index, REG_MSMON_MBWU, 0);
@@ -837,6 +1053,66 @@ uint64_t val_mpam_memory_get_base(uint32_t msc_index, uint32_t rsrc_index)
     return val_srat_get_info(SRAT_MEM_BASE_ADDR, prox_domain);
 }
 
+/**
+  @brief   This API generates memory traffic on buffers of any 64 bit size
+           with 64 byte LDP/STP loops, or LDNP/STNP for non-temporal accesses,
+           and measures the bandwidth achieved with the generic counter.
+           A trailing part shorter than MPAM_TRAFFIC_CHUNK is not accessed.
+
+  @param   mode   - MPAM_TRAFFIC_READ, MPAM_TRAFFIC_WRITE or MPAM_TRAFFIC_COPY.
+  @param   dst    - buffer written, for write and copy modes.
+  @param   src    - buffer read, for read and copy modes.
+  @param   size   - size of the buffers in bytes.
+  @param   flags  - MPAM_TRAFFIC_NON_TEMPORAL for non-temporal accesses.
+
+  @return  bandwidth in MB/s, counting bytes read and written, 0 if not measured.
+**/
+uint64_t
+val_mpam_mem_traffic(MPAM_TRAFFIC_MODE_e mode, void *dst, void *src,
+                     uint64_t size, uint32_t flags)
+{
+    uint64_t len = size & ~((uint64_t)MPAM_TRAFFIC_CHUNK - 1);
+    uint64_t non_temporal = (flags & MPAM_TRAFFIC_NON_TEMPORAL) ? 1 : 0;
+    uint64_t bytes;
+    uint64_t freq;
+    uint64_t start;
+    uint64_t ticks;
+    uint64_t bw_mbps;
+
+    if (len == 0)
+        return 0;
+
+    freq = ArmArchTimerReadReg(CntFrq);
+    start = ArmArchTimerReadReg(CntPct);
+
+    switch (mode) {
+    case MPAM_TRAFFIC_READ:
+        (void)AA64MemTrafficRead(src, len, non_temporal);
+        bytes = len;
+        break;
+    case MPAM_TRAFFIC_WRITE:
+        AA64MemTrafficWrite(dst, len, MPAM_TRAFFIC_PATTERN, non_temporal);
+        bytes = len;
+        break;
+    default:
+        AA64MemTrafficCopy(dst, src, len, non_temporal);
+        bytes = 2 * len;
+        break;
+    }
+
+    ticks = ArmArchTimerReadReg(CntPct) - start;
+    if ((freq == 0) || (ticks == 0))
+        return 0;
+
+    /* scale to kB first, bytes * freq overflows for multi GB transfers */
+    bw_mbps = ((bytes / 1000) * freq / ticks) / 1000;
+
+    val_print(ACS_PRINT_DEBUG, "\n       Memory traffic size 0x%llx", len);
+    val_print(ACS_PRINT_DEBUG, ", bandwidth %lld MB/s", bw_mbps);
+
+    return bw_mbps;
+}
+
 static
 void
 memory_map_msc(void)
@@ -853,6 +1129,36 @@ memory_map_msc(void)
   return;
 }
 
+/**
+  @brief   This API builds the array of MSC node pointers used by
+           val_mpam_get_info, so that MSC lookups do not walk the table.
+           On allocation failure lookups keep walking the table.
+  @param   None
+  @return  None
+**/
+static
+void
+mpam_build_msc_index(void)
+{
+  uint32_t i;
+  uint32_t msc_count = g_mpam_info_table->msc_count;
+  MPAM_MSC_NODE *msc_entry;
+
+  g_mpam_msc_index = NULL;
+  if (msc_count == 0)
+    return;
+
+  g_mpam_msc_index = val_memory_alloc(msc_count * sizeof(MPAM_MSC_NODE *));
+  if (g_mpam_msc_index == NULL) {
+    val_print(ACS_PRINT_WARN, "\n   MSC index allocation failed", 0);
+    return;
+  }
+
+  msc_entry = &g_mpam_info_table->msc_node[0];
+  for (i = 0; i < msc_count; i++, msc_entry = MPAM_NEXT_MSC(msc_entry))
+    g_mpam_msc_index[i] = msc_entry;
+}
+
 /**
   @brief   This API will call PAL layer to fill in the MPAM table information
            into the g_mpam_info_table pointer.
@@ -875,6 +1181,16 @@ val_mpam_create_info_table(uint64_t *mpam_info_table)
 
   val_print(ACS_PRINT_TEST,
                 " MPAM INFO: Number of MSC nodes       :    %d\n", g_mpam_info_table->msc_count);
+
+  mpam_build_msc_index();
+
+  /* feature ID registers are decoded on first use, see mpam_get_msc_feat */
+  g_mpam_msc_feat = NULL;
+  if (g_mpam_info_table->msc_count != 0) {
+    g_mpam_msc_feat = val_memory_calloc(g_mpam_info_table->msc_count, sizeof(MPAM_MSC_FEATURES));
+    if (g_mpam_msc_feat == NULL)
+      val_print(ACS_PRINT_WARN, "\n   MSC feature cache allocation failed", 0);
+  }
   val_print(ACS_PRINT_DEBUG, "Memory mapping MSC nodes\n", 0);
 
   /* TODO - Check if MSC memory mapping requires a flag/ cmdline option */
@@ -891,6 +1207,16 @@ val_mpam_create_info_table(uint64_t *mpam_info_table)
 void
 val_mpam_free_info_table(void)
 {
+    if (g_mpam_msc_index != NULL) {
+        val_memory_free(g_mpam_msc_index);
+        g_mpam_msc_index = NULL;
+    }
+
+    if (g_mpam_msc_feat != NULL) {
+        val_memory_free(g_mpam_msc_feat);
+        g_mpam_msc_feat = NULL;
+    }
+
     if (g_mpam_info_table != NULL) {
         pal_mem_free_aligned((void *)g_mpam_info_table);
         g_mpam_info_table = NULL;
@@ -986,6 +1312,11 @@ val_srat_free_info_table(void)
 uint32_t
 val_mpam_get_max_pmg(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 0);
+
+    if (feat != NULL)
+        return feat->pmg_max;
+
     return BITFIELD_READ(IDR_PMG_MAX, val_mpam_mmr_read64(msc_index, REG_MPAMF_IDR));
 }
 
@@ -997,6 +1328,11 @@ val_mpam_get_max_pmg(uint32_t msc_index)
 uint32_t
 val_mpam_get_max_partid(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 0);
+
+    if (feat != NULL)
+        return feat->partid_max;
+
     return BITFIELD_READ(IDR_PARTID_MAX, val_mpam_mmr_read64(msc_index, REG_MPAMF_IDR));
 }
 
@@ -1008,6 +1344,11 @@ val_mpam_get_max_partid(uint32_t msc_index)
 uint16_t
 val_mpam_get_max_intpartid(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 0);
+
+    if (feat != NULL)
+        return feat->intpartid_max;
+
     return BITFIELD_READ(INTPARTID_MAX, val_mpam_mmr_read(msc_index, REG_MPAMF_PARTID_NRW_IDR));
 }
 
@@ -1022,6 +1363,11 @@ val_mpam_get_max_intpartid(uint32_t msc_index)
 uint32_t
 val_mpam_get_cmax_wd(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->cmax_wd;
+
     return BITFIELD_READ(CMAX_WD, val_mpam_mmr_read(msc_index, REG_MPAMF_CCAP_IDR));
 }
 
@@ -1036,6 +1382,11 @@ val_mpam_get_cmax_wd(uint32_t msc_index)
 uint32_t
 val_mpam_get_bwa_wd(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->bwa_wd;
+
     return BITFIELD_READ(BWA_WD, val_mpam_mmr_read(msc_index, REG_MPAMF_MBW_IDR));
 }
 /**
@@ -1244,6 +1595,11 @@ void val_mpam_msc_configure_mbwmax(uint32_t msc_index, uint16_t partid,
 uint32_t
 val_mpam_get_cpbm_width(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->cpbm_wd;
+
     if (val_mpam_supports_cpor(msc_index))
         return BITFIELD_READ(CPOR_IDR_CPBM_WD, val_mpam_mmr_read(msc_index, REG_MPAMF_CPOR_IDR));
     else
@@ -1258,6 +1614,11 @@ val_mpam_get_cpbm_width(uint32_t msc_index)
 uint32_t
 val_mpam_get_mbwpbm_width(uint32_t msc_index)
 {
+    MPAM_MSC_FEATURES *feat = mpam_get_msc_feat(msc_index, 1);
+
+    if (feat != NULL)
+        return feat->bwpbm_wd;
+
     if (val_mpam_msc_supports_mbwpbm(msc_index))
         return BITFIELD_READ(BWPBM_WD, val_mpam_mmr_read(msc_index, REG_MPAMF_MBW_IDR));
     else
@@ -1279,6 +1640,7 @@ void
 val_mpam_configure_csu_mon(uint32_t msc_index, uint16_t partid, uint8_t pmg, uint16_t mon_sel)
 {
     uint32_t data;
+    MPAM_MSC_FEATURES *feat;
 
     /* retaining other configured fields e.g, RIS index if supported */
     data = val_mpam_mmr_read(msc_index, REG_MSMON_CFG_MON_SEL);
@@ -1299,7 +1661,9 @@ val_mpam_configure_csu_mon(uint32_t msc_index, uint16_t partid, uint8_t pmg, uin
 
     /* Reset CSU Monitor Value */
     /* if CSUMON_IDR.CSU_RO == 0, accesses to this register are RW */
-    if (!BITFIELD_READ(CSUMON_IDR_CSU_RO, val_mpam_mmr_read(msc_index, REG_MPAMF_CSUMON_IDR))) {
+    feat = mpam_get_msc_feat(msc_index, 1);
+    if (!((feat != NULL) ? feat->csu_ro :
+          BITFIELD_READ(CSUMON_IDR_CSU_RO, val_mpam_mmr_read(msc_index, REG_MPAMF_CSUMON_IDR)))) {
        val_mpam_mmr_write(msc_index, REG_MSMON_CSU, 0);
     }
 
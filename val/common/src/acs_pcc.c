@@ -18,10 +18,32 @@
 /* This file contains APIs used by other modules/components */
 
 #include "common/include/acs_val.h"
+#include "common/include/acs_timer_support.h"
 #include "common/include/acs_common.h"
+#include "common/include/acs_pe.h"
 
 static PCC_INFO_TABLE *g_pcc_info_table;
 
+/* Lower bound of the command complete timeout, for subspaces reporting
+   a zero minimum request turnaround time */
+#define PCC_CMD_TIMEOUT_MIN_US 1000
+
+/* Number of distinct platform interrupts the PCC handler can be installed on */
+#define PCC_INTR_MAX 8
+
+/* Commands are posted one at a time, so a single subspace waits for
+   the platform interrupt at any point in time */
+static PCC_SUBSPACE_TYPE_3 *g_pcc_intr_ss;
+static uint32_t g_pcc_intr_id;
+static volatile uint32_t g_pcc_intr_done;
+
+static uint32_t g_pcc_intr_installed[PCC_INTR_MAX];
+static uint32_t g_pcc_intr_cnt;
+
+/* EL1 physical timer bounding each WFI to the remaining command timeout,
+   0 until its handler is installed */
+static uint32_t g_pcc_timer_intid;
+
 /* PCCT related APIs */
 
 /**
@@ -71,28 +93,206 @@ val_pcc_get_ss_info_idx(uint32_t subspace_id)
 }
 
 /**
-  @brief  This API implements ACPI Doorbell protocol.
+  @brief  Handler for the PCC platform interrupt. Acknowledges the interrupt
+          through the platform interrupt ack register of the waiting subspace
+          and records the command completion.
 
-  @param  subspace_idx  - Subspace id, used to index PCCT array.
-  @param  command       - PCC command header
-  @param  data          - pointer to data to be written to communication
-                          subspace.
-  @param  data_size     - size of data to be written to subspace
+  @param  None
 
-  @return pointer to communication subspace with response.
+  @return None
 **/
+static
 void
-*val_pcc_cmd_response(uint32_t subspace_id, uint32_t command, void *data, uint32_t data_size)
+pcc_intr_handler(void)
 {
+  PCC_SUBSPACE_TYPE_3 *pcc_ss = g_pcc_intr_ss;
+  uint64_t ack_val;
+
+  if ((pcc_ss != NULL) && (pcc_ss->platform_intr_ack_reg.addr != 0)) {
+      /* acknowledge by performing read/modify/write cycle */
+      ack_val = val_mmio_read(pcc_ss->platform_intr_ack_reg.addr);
+      ack_val = (ack_val & pcc_ss->platform_intr_ack_preserve) | pcc_ss->platform_intr_ack_set;
+      val_mmio_write(pcc_ss->platform_intr_ack_reg.addr, ack_val);
+  }
 
-  uint32_t pcc_idx;
-  uint32_t loop_cnt;
-  uint32_t cmd_complete;
-  uint64_t shared_mem_addr;
-  uint64_t cmd_complete_upd_reg;
-  uint64_t doorbell_val;
-  PCC_SUBSPACE_TYPE_3 *ptr_to_pcc_ss_type_3;
+  g_pcc_intr_done = 1;
+  val_gic_end_of_interrupt(g_pcc_intr_id);
+}
+
+/**
+  @brief  Handler for the EL1 physical timer bounding a WFI wait. The timer is
+          normally disabled again before IRQs are unmasked, so this only runs
+          if the timer interrupt is taken while another wakes the PE.
+
+  @param  None
+
+  @return None
+**/
+static
+void
+pcc_timer_handler(void)
+{
+  val_timer_set_phy_el1(0);
+  val_gic_end_of_interrupt(g_pcc_timer_intid);
+}
+
+/**
+  @brief  This API arms the platform interrupt of a PCC subspace for the next
+          command, installing the handler the first time the interrupt is used.
+          The EL1 physical timer handler is installed with the first interrupt,
+          so that the wait never sleeps past its timeout. A subspace without
+          platform interrupt, or whose interrupt or timer cannot be installed,
+          is left to polling.
+
+  @param  pcc_ss  - pointer to PCC type 3 subspace info.
 
+  @return 1 if command completion is signalled by interrupt, 0 otherwise.
+**/
+static
+uint32_t
+pcc_intr_arm(PCC_SUBSPACE_TYPE_3 *pcc_ss)
+{
+  uint32_t i;
+  uint32_t timer_intid;
+
+  if ((pcc_ss->platform_intr == 0) || (ArmArchTimerReadReg(CntFrq) == 0) || g_el1physkip)
+      return 0;
+
+  if (g_pcc_timer_intid == 0) {
+      timer_intid = val_timer_get_info(TIMER_INFO_PHY_EL1_INTID, 0);
+      if ((timer_intid == 0) || val_gic_install_isr(timer_intid, pcc_timer_handler)) {
+          val_print(ACS_PRINT_DEBUG, "\n    PCC wait timer not installed, polling", 0);
+          pcc_ss->platform_intr = 0;
+          return 0;
+      }
+      g_pcc_timer_intid = timer_intid;
+  }
+
+  g_pcc_intr_ss = pcc_ss;
+  g_pcc_intr_id = pcc_ss->platform_intr;
+  g_pcc_intr_done = 0;
+
+  for (i = 0; i < g_pcc_intr_cnt; i++) {
+      if (g_pcc_intr_installed[i] == pcc_ss->platform_intr)
+          return 1;
+  }
+
+  if ((g_pcc_intr_cnt == PCC_INTR_MAX) ||
+      val_gic_install_isr(pcc_ss->platform_intr, pcc_intr_handler)) {
+      val_print(ACS_PRINT_DEBUG, "\n    PCC interrupt 0x%x not installed, polling",
+                pcc_ss->platform_intr);
+      /* do not retry for this subspace */
+      pcc_ss->platform_intr = 0;
+      return 0;
+  }
+
+  g_pcc_intr_installed[g_pcc_intr_cnt++] = pcc_ss->platform_intr;
+  return 1;
+}
+
+/**
+  @brief  This API returns the error status of the command a PCC subspace has
+          completed, as reported by its error status register if it has one.
+
+  @param  pcc_ss  - pointer to PCC type 3 subspace info.
+
+  @return ACS_STATUS_PASS if no error is reported, ACS_STATUS_ERR otherwise.
+**/
+static
+uint32_t
+pcc_cmd_error_status(PCC_SUBSPACE_TYPE_3 *pcc_ss)
+{
+  if ((pcc_ss->error_status_reg.addr == 0) || (pcc_ss->error_status_mask == 0))
+      return ACS_STATUS_PASS;
+
+  if (val_mmio_read(pcc_ss->error_status_reg.addr) & pcc_ss->error_status_mask)
+      return ACS_STATUS_ERR;
+
+  return ACS_STATUS_PASS;
+}
+
+/**
+  @brief  This API waits for the command complete bit of a PCC subspace until
+          the platform sets it, or until a timeout of three times the minimum
+          request turnaround time expires. Time is measured with the generic
+          counter, so the wait ends as soon as the bit is set. The error status
+          of the completed command is then checked.
+
+          When the platform interrupt is armed the PE sleeps in WFI between
+          checks instead of polling the register. IRQs are masked around the
+          check and WFI, so a completion interrupt arriving in between stays
+          pending and wakes the PE, and is taken once IRQs are unmasked. The
+          EL1 physical timer is armed for the remaining timeout before each
+          WFI and disabled after it, so a platform that never completes the
+          command does not leave the PE asleep.
+
+  @param  pcc_ss    - pointer to PCC type 3 subspace info.
+  @param  use_intr  - 1 if completion is signalled by the platform interrupt.
+
+  @return ACS_STATUS_PASS if command complete is set, ACS_STATUS_FAIL on timeout,
+          ACS_STATUS_ERR if the platform reports an error for the command.
+**/
+static
+uint32_t
+pcc_wait_cmd_complete(PCC_SUBSPACE_TYPE_3 *pcc_ss, uint32_t use_intr)
+{
+  uint64_t timeout_us;
+  uint64_t freq;
+  uint64_t start;
+  uint64_t timeout_ticks;
+  uint64_t elapsed;
+  uint64_t daif;
+
+  timeout_us = 3 * (uint64_t)pcc_ss->min_req_turnaround_usec;
+  if (timeout_us < PCC_CMD_TIMEOUT_MIN_US)
+      timeout_us = PCC_CMD_TIMEOUT_MIN_US;
+
+  freq = ArmArchTimerReadReg(CntFrq);
+  if (freq == 0) {
+      /* no counter frequency, poll with microsecond delays */
+      do {
+          if (val_mmio_read(pcc_ss->cmd_complete_chk_reg.addr) & pcc_ss->cmd_complete_chk_mask)
+              return pcc_cmd_error_status(pcc_ss);
+          val_time_delay_ms(1);
+      } while (timeout_us--);
+      return ACS_STATUS_FAIL;
+  }
+
+  timeout_ticks = (timeout_us * freq) / 1000000;
+  start = ArmArchTimerReadReg(CntPct);
+  while (1) {
+      if (val_mmio_read(pcc_ss->cmd_complete_chk_reg.addr) & pcc_ss->cmd_complete_chk_mask)
+          return pcc_cmd_error_status(pcc_ss);
+      elapsed = ArmArchTimerReadReg(CntPct) - start;
+      if (elapsed > timeout_ticks)
+          break;
+      if (use_intr) {
+          daif = AA64ReadDaif();
+          AA64MaskIrq();
+          if (!g_pcc_intr_done) {
+              val_timer_set_phy_el1(timeout_ticks - elapsed + 1);
+              ArmCallWFI();
+              val_timer_set_phy_el1(0);
+          }
+          AA64WriteDaif(daif);
+      }
+  }
+
+  return ACS_STATUS_FAIL;
+}
+
+/**
+  @brief  This API returns the type 3 subspace info for a PCC subspace id.
+
+  @param  subspace_id  - Subspace id, used to index PCCT array.
+
+  @return pointer to subspace info, NULL if not found.
+**/
+static
+PCC_SUBSPACE_TYPE_3 *
+pcc_get_ss_type_3(uint32_t subspace_id)
+{
+  uint32_t pcc_idx;
 
   /* get pcc info block index */
   pcc_idx = val_pcc_get_ss_info_idx(subspace_id);
@@ -102,30 +302,32 @@ void
       return NULL;
   }
 
-  /* pointer to PCC info */
-  ptr_to_pcc_ss_type_3 = &(g_pcc_info_table->pcc_info[pcc_idx].type_spec_info.pcc_ss_type_3);
+  return &(g_pcc_info_table->pcc_info[pcc_idx].type_spec_info.pcc_ss_type_3);
+}
 
-  /* Note : For information on Doorbell Protocol refer ACPI 6.5 specification; section 14.5 */
+/**
+  @brief  This API posts one command to a PCC subspace owned by OSPM, i.e with
+          command complete set, and waits for the platform to complete it.
 
-  /* ensuring command complete check is set, indicating shared memory
-     exclusively owned by OSPM */
-  loop_cnt = 3;
-  do {
-      /* wait for minimum request turnaround time * 3 to provide time for platform */
-      val_time_delay_ms(ptr_to_pcc_ss_type_3->min_req_turnaround_usec);
-      /* read command complete check register */
-      cmd_complete = val_mmio_read(ptr_to_pcc_ss_type_3->cmd_complete_chk_reg.addr) &
-                                ptr_to_pcc_ss_type_3->cmd_complete_chk_mask;
-      loop_cnt--;
-  } while (cmd_complete == 0 || loop_cnt != 0);
-
-  /* if platform not setting complete, return with failure */
-  if (loop_cnt == 0) {
-      val_print(ACS_PRINT_ERR,
-                "\n    Platform fails to set command complete reg for PCC subspace id : 0x%x",
-                subspace_id);
-      return NULL;
-  }
+  @param  ptr_to_pcc_ss_type_3 - pointer to PCC type 3 subspace info.
+  @param  subspace_id          - Subspace id, for error reporting.
+  @param  command              - PCC command header
+  @param  data                 - pointer to data to be written to communication
+                                 subspace.
+  @param  data_size            - size of data to be written to subspace
+
+  @return ACS_STATUS_PASS if the platform completed the command, ACS_STATUS_FAIL otherwise.
+**/
+static
+uint32_t
+pcc_post_cmd(PCC_SUBSPACE_TYPE_3 *ptr_to_pcc_ss_type_3, uint32_t subspace_id,
+             uint32_t command, void *data, uint32_t data_size)
+{
+  uint64_t shared_mem_addr;
+  uint64_t cmd_complete_upd_reg;
+  uint64_t doorbell_val;
+  uint32_t use_intr;
+  uint32_t status;
 
   /* write command and parameters to PCC shared memory region */
   shared_mem_addr = ptr_to_pcc_ss_type_3->base_addr;
@@ -144,34 +346,75 @@ void
   /* write command complete update register to clear the complete bit */
   val_mmio_write(ptr_to_pcc_ss_type_3->cmd_complete_update_reg.addr, cmd_complete_upd_reg);
 
+  /* arm the platform interrupt, if any, before the platform can complete */
+  use_intr = pcc_intr_arm(ptr_to_pcc_ss_type_3);
+
   /* ring doorbell by performing read/modify/write cycle */
   doorbell_val = val_mmio_read(ptr_to_pcc_ss_type_3->doorbell_reg.addr);
   doorbell_val = (doorbell_val & ptr_to_pcc_ss_type_3->doorbell_preserve)
                     | ptr_to_pcc_ss_type_3->doorbell_write;
   val_mmio_write(ptr_to_pcc_ss_type_3->doorbell_reg.addr, doorbell_val);
 
-  /* wait for minimum request turnaround time and poll on the command complete bit for set */
-  loop_cnt = 3;
-  do {
-      /* wait for minimum request turnaround time * 3 to provide time for platform */
-      val_time_delay_ms(ptr_to_pcc_ss_type_3->min_req_turnaround_usec);
-      /* read command complete check register */
-      cmd_complete = val_mmio_read(ptr_to_pcc_ss_type_3->cmd_complete_chk_reg.addr) &
-                                ptr_to_pcc_ss_type_3->cmd_complete_chk_mask;
-      loop_cnt--;
-  } while (cmd_complete == 0 || loop_cnt != 0);
-
-  /* if platform not setting complete, return with failure */
-  if (loop_cnt == 0) {
+  /* wait for the command complete bit to be set, return with failure if
+     platform does not set it or reports an error */
+  status = pcc_wait_cmd_complete(ptr_to_pcc_ss_type_3, use_intr);
+  if (status == ACS_STATUS_ERR) {
+      val_print(ACS_PRINT_ERR,
+          "\n    Platform reports command error for PCC subspace id : 0x%x", subspace_id);
+      return ACS_STATUS_FAIL;
+  }
+  if (status != ACS_STATUS_PASS) {
       val_print(ACS_PRINT_ERR,
           "\n    Platform fails to set command complete, post command for PCC subspace id : 0x%x",
           subspace_id);
+      return ACS_STATUS_FAIL;
+  }
+
+  return ACS_STATUS_PASS;
+}
+
+/**
+  @brief  This API implements ACPI Doorbell protocol.
+
+  @param  subspace_idx  - Subspace id, used to index PCCT array.
+  @param  command       - PCC command header
+  @param  data          - pointer to data to be written to communication
+                          subspace.
+  @param  data_size     - size of data to be written to subspace
+
+  @return pointer to communication subspace with response.
+**/
+void
+*val_pcc_cmd_response(uint32_t subspace_id, uint32_t command, void *data, uint32_t data_size)
+{
+  PCC_SUBSPACE_TYPE_3 *ptr_to_pcc_ss_type_3;
+
+  /* pointer to PCC info */
+  ptr_to_pcc_ss_type_3 = pcc_get_ss_type_3(subspace_id);
+  if (ptr_to_pcc_ss_type_3 == NULL) {
+      return NULL;
+  }
+
+  /* Note : For information on Doorbell Protocol refer ACPI 6.5 specification; section 14.5 */
+
+  /* ensuring command complete check is set, indicating shared memory
+     exclusively owned by OSPM, return with failure if platform does not set it.
+     An error reported for an earlier command does not affect ownership. */
+  if (pcc_wait_cmd_complete(ptr_to_pcc_ss_type_3, 0) == ACS_STATUS_FAIL) {
+      val_print(ACS_PRINT_ERR,
+                "\n    Platform fails to set command complete reg for PCC subspace id : 0x%x",
+                subspace_id);
+      return NULL;
+  }
+
+  if (pcc_post_cmd(ptr_to_pcc_ss_type_3, subspace_id, command, data, data_size)
+      != ACS_STATUS_PASS) {
       return NULL;
   }
 
   /* process response from platform */
   /* return pointer to communication subspace with response data */
-  return (void *)(shared_mem_addr + PCC_TY3_COMM_SPACE);
+  return (void *)(ptr_to_pcc_ss_type_3->base_addr + PCC_TY3_COMM_SPACE);
 }
 
 /**
@@ -186,6 +429,7 @@ void
 val_pcc_free_info_table(void)
 {
     if (g_pcc_info_table != NULL) {
+        g_pcc_intr_ss = NULL;
         pal_mem_free_aligned((void *)g_pcc_info_table);
         g_pcc_info_table = NULL;
     }
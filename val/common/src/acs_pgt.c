@@ -25,11 +25,17 @@
 
 #define PGT_DEBUG_LEVEL ACS_PRINT_INFO
 
+/* Table pages kept for reuse by later translation tables, beyond this they are freed */
+#define PGT_POOL_MAX_FREE 64
+
 static uint32_t page_size;
 static uint32_t bits_per_level;
+/* Output address bits of a descriptor, next level table addresses included */
 static uint64_t pgt_addr_mask;
-uint64_t is_values_init = 0;
-uint64_t offset = 0;
+/* Set while val_pgt_create updates tables it allocated, whose subtables it may free and
+   whose blocks and contiguous runs it may rewrite. Other tables, such as the live TTBR0
+   tables, only get new entries and valid entries replaced with break-before-make. */
+static uint32_t pgt_owned;
 
 typedef struct
 {
@@ -43,125 +49,276 @@ typedef struct
 } tt_descriptor_t;
 
 typedef struct {
-    uint32_t l0_index;
-    uint32_t l1_index;
-    uint32_t l2_index;
-    uint32_t l3_index;
-    uint64_t size_used;
-} acs_pgt_t;
+    uint32_t tables;
+    uint32_t blocks;
+    uint32_t pages;
+    uint32_t contig;
+} pgt_build_stats_t;
+
+static pgt_build_stats_t pgt_stats;
+
+/* Free table pages, linked through their first entry */
+static uint64_t *pgt_pool_free_list;
+static uint32_t pgt_pool_free_count;
+
+/* Roots allocated by val_pgt_create, until val_pgt_destroy. Requests with PGT_FLAG_SHARE
+   for the same layout and translation attributes share the tables, which cannot be
+   updated while more than one user holds them. A root not recorded, the table being
+   full, is still freed by val_pgt_destroy but later updates treat it as not owned. */
+#define PGT_CACHE_MAX          16
+#define PGT_CACHE_MAX_REGIONS  4
+
+typedef struct {
+    uint64_t pgt_base;      /* root table, 0 if the slot is free */
+    uint32_t ias;
+    uint32_t oas;
+    uint32_t page_size;
+    uint32_t stage;
+    uint64_t mair;
+    PE_TCR_BF tcr;
+    uint32_t share;         /* other requests for the same layout may share the tables */
+    uint32_t num_regions;
+    uint32_t refcount;      /* users not yet passed to val_pgt_destroy */
+    memory_region_descriptor_t region[PGT_CACHE_MAX_REGIONS];
+} pgt_cache_entry_t;
+
+static pgt_cache_entry_t pgt_cache[PGT_CACHE_MAX];
+
+static void free_translation_table(uint64_t *tt_base, uint32_t bits_at_this_level,
+                                   uint32_t this_level);
+
+/* Recent walks done by val_pgt_get_attributes over tables val_pgt_create allocated and
+   has not yet destroyed. Other tables, such as the firmware TTBR0 tables, may be freed or
+   reused behind the VAL and are always walked. A hit is only used while every descriptor
+   the walk read, from the root to the leaf of the queried address, still holds its cached
+   value. Changes made through val_pgt_create/destroy invalidate the table. */
+#define PGT_WALK_CACHE_SIZE 16
+#define PGT_WALK_MAX_LEVELS 4
+
+typedef struct {
+    uint64_t pgt_base;
+    uint64_t va;            /* address walked */
+    uint32_t size_log2;     /* size mapped by the leaf or its contiguous run, 0 if free */
+    uint32_t leaf_log2;     /* size mapped by the leaf entry alone */
+    uint32_t depth;         /* descriptors read, the leaf last */
+    uint64_t *slot[PGT_WALK_MAX_LEVELS];  /* descriptor slots read */
+    uint64_t desc[PGT_WALK_MAX_LEVELS];   /* their values when cached */
+} pgt_walk_cache_entry_t;
 
-static acs_pgt_t acs_pgt_info;
+static pgt_walk_cache_entry_t pgt_walk_cache[PGT_WALK_CACHE_SIZE];
+static uint32_t pgt_walk_cache_next;
 
-void setup_acs_pgt_values(void)
+/* Invalidate the cached walks of a table, of every table if pgt_base is 0 */
+static
+void pgt_walk_cache_invalidate(uint64_t pgt_base)
 {
-    acs_pgt_info.l0_index = 0;
-    acs_pgt_info.l1_index = 0;
-    acs_pgt_info.l2_index = 0;
-    acs_pgt_info.l3_index = 0;
-    acs_pgt_info.size_used = 0;
+    uint32_t i;
+
+    for (i = 0; i < PGT_WALK_CACHE_SIZE; i++) {
+        if (pgt_base == 0 || pgt_walk_cache[i].pgt_base == pgt_base)
+            pgt_walk_cache[i].size_log2 = 0;
+    }
 }
 
+/**
+  @brief  This API allocates a zeroed translation table, reusing a freed table if possible
+
+  @param  None
 
+  @return table base, NULL on allocation failure
+**/
 static
-uint32_t get_pgt_index(uint32_t level)
+uint64_t *pgt_table_alloc(void)
 {
-    switch (level)
-    {
-        case(PGT_LEVEL_0):
-            return acs_pgt_info.l0_index;
-        case(PGT_LEVEL_1):
-            return acs_pgt_info.l1_index;
-        case(PGT_LEVEL_2):
-            return acs_pgt_info.l2_index;
-        case(PGT_LEVEL_3):
-            return acs_pgt_info.l3_index;
-        default:
-            return 0;
+    uint64_t *table = pgt_pool_free_list;
+
+    if (table != NULL) {
+        pgt_pool_free_list = (uint64_t *)table[0];
+        pgt_pool_free_count--;
+    } else {
+        table = val_memory_alloc_pages(1);
+        if (table == NULL)
+            return NULL;
     }
+
+    val_memory_set(table, page_size, 0);
+    pgt_stats.tables++;
+    return table;
 }
 
+/**
+  @brief  This API returns a translation table to the pool
+
+  @param  table   Table base
+
+  @return None
+**/
 static
-void increment_pgt_index(uint32_t level, uint32_t max_index)
+void pgt_table_free(uint64_t *table)
 {
-    switch (level)
-    {
-        case(PGT_LEVEL_1):
-            if (acs_pgt_info.l1_index == (max_index - 1)) {
-                acs_pgt_info.l1_index = 0;
-                acs_pgt_info.l0_index++;
-            }
-            break;
+    if (pgt_pool_free_count >= PGT_POOL_MAX_FREE) {
+        val_memory_free_pages(table, 1);
+        return;
+    }
 
-        case(PGT_LEVEL_2):
-            if (acs_pgt_info.l2_index == (max_index - 1)) {
-                acs_pgt_info.l2_index = 0;
-                acs_pgt_info.l1_index++;
-            }
-            break;
+    table[0] = (uint64_t)pgt_pool_free_list;
+    pgt_pool_free_list = table;
+    pgt_pool_free_count++;
+}
 
-        case(PGT_LEVEL_3):
-            if (acs_pgt_info.l3_index == (max_index - 1)) {
-                acs_pgt_info.l3_index = 0;
-                acs_pgt_info.l2_index++;
-            } else
-                acs_pgt_info.l3_index++;
-            break;
-        default:
-            break;
-    }
+/**
+  @brief  This API checks if a level can hold block descriptors for the current granule.
+          Level 0 blocks (4KB) and level 1 blocks (16KB, 64KB) need 52-bit addressing.
+
+  @param  level   Translation level
+
+  @return 1 if block descriptors are allowed
+**/
+static
+uint32_t pgt_block_allowed(uint32_t level)
+{
+    if (page_size == PAGE_SIZE_4K)
+        return (level == PGT_LEVEL_1 || level == PGT_LEVEL_2);
+
+    return (level == PGT_LEVEL_2);
 }
 
+/**
+  @brief  This API returns the number of entries of a contiguous run at a level
+
+  @param  granule Translation granule size
+  @param  level   Translation level
+
+  @return number of entries
+**/
 static
-uint32_t get_entries_per_level(uint32_t page_size)
+uint32_t pgt_contig_entries(uint32_t granule, uint32_t level)
 {
-    switch (page_size)
-    {
-        case(PAGE_SIZE_4K):   //4kb granule
-            return MAX_ENTRIES_4K;
-        case(PAGE_SIZE_16K):  //16kb granule
-            return MAX_ENTRIES_16K;
-        case(PAGE_SIZE_64K):  //64kb granule
-            return MAX_ENTRIES_64K;
-        default:
-            val_print(ACS_PRINT_ERR, "\n       %llx granularity not supported.", page_size);
-            return 0;
+    if (granule == PAGE_SIZE_4K)
+        return PGT_CONTIG_ENTRIES_4K;
+    if (granule == PAGE_SIZE_16K && level == PGT_LEVEL_3)
+        return PGT_CONTIG_ENTRIES_16K_L3;
+
+    return PGT_CONTIG_ENTRIES_DEFAULT;
+}
+
+static
+uint32_t pgt_entry_is_leaf(uint64_t entry, uint32_t level)
+{
+    if (IS_PGT_ENTRY_INVALID(entry))
+        return 0;
+
+    return (level == PGT_LEVEL_3) ? IS_PGT_ENTRY_PAGE(entry) : IS_PGT_ENTRY_BLOCK(entry);
+}
+
+/**
+  @brief  This API writes a descriptor. A valid descriptor of tables not allocated by
+          val_pgt_create may be in use by the PE, so it is replaced with break-before-make:
+          invalid entry, DSB, TLB invalidation, DSB, new entry.
+
+  @param  table_desc  Descriptor to write
+  @param  desc        New descriptor
+
+  @return None
+**/
+static
+void pgt_write_desc(uint64_t *table_desc, uint64_t desc)
+{
+    if (!pgt_owned && !IS_PGT_ENTRY_INVALID(*table_desc) && *table_desc != desc) {
+        *table_desc = 0;
+        val_mem_issue_dsb();
+        val_mem_issue_tlbi();
     }
+
+    *table_desc = desc;
 }
 
+/**
+  @brief  This API clears the contiguous hint from the run holding an entry which is
+          about to be replaced, so that no run is left partially overwritten
+
+  @param  tt_desc   Translation Table Descriptor
+  @param  index     Index of the entry being replaced
+
+  @return None
+**/
 static
-uint64_t get_block_size(uint32_t level)
+void pgt_break_contig(tt_descriptor_t *tt_desc, uint64_t index)
 {
-    uint32_t entries = get_entries_per_level(page_size);
-    switch (level)
-    {
-        case(PGT_LEVEL_0):  // For L0 table translation
-            if (page_size == PAGE_SIZE_4K)
-                return (uint64_t)(page_size * entries * entries * entries);
-            else if (page_size == PAGE_SIZE_16K)
-                return (uint64_t)(page_size * entries * entries * 2); // only 2 lookup tables in L0
-            else {
-                val_print(ACS_PRINT_ERR, "\n       L0 tables not supported for page size %llx",
-                                                                                        page_size);
-                return 0;
-            }
+    uint64_t num = pgt_contig_entries(page_size, tt_desc->level);
+    uint64_t i, first = index & ~(num - 1);
 
-        case(PGT_LEVEL_1):  // For L1 table translation
-            if (page_size == PAGE_SIZE_4K || page_size == PAGE_SIZE_16K)
-                return (uint64_t)(page_size * entries * entries);
-            else
-                return (uint64_t)(page_size * entries * 64); // 64 Lookup tables in L1 (64KB Gran)
+    if (!pgt_owned || !pgt_entry_is_leaf(tt_desc->tt_base[index], tt_desc->level) ||
+        !(tt_desc->tt_base[index] & PGT_ENTRY_CONTIG_MASK))
+        return;
 
-        case(PGT_LEVEL_2):  // For L2 table translation
-            return (uint64_t)(page_size * entries);
-        case(PGT_LEVEL_3):  // For L3 table translation
-            return (uint64_t)(page_size);
-        default:
-            return 0;
+    if (num > (0x1ull << tt_desc->nbits))
+        return;
+
+    for (i = first; i < first + num; i++) {
+        if (pgt_entry_is_leaf(tt_desc->tt_base[i], tt_desc->level))
+            tt_desc->tt_base[i] &= ~PGT_ENTRY_CONTIG_MASK;
     }
 }
 
 /**
-  @brief  This API fills the translation table
+  @brief  This API frees the subtables of a table descriptor which is about to be replaced
+          by a leaf. Tables not allocated by val_pgt_create are left to their owner.
+
+  @param  tt_desc   Translation Table Descriptor
+  @param  index     Index of the entry being replaced
+
+  @return None
+**/
+static
+void pgt_release_entry(tt_descriptor_t *tt_desc, uint64_t index)
+{
+    uint64_t *tt_base_next_level;
+
+    if (!pgt_owned || tt_desc->level == PGT_LEVEL_3 ||
+        !IS_PGT_ENTRY_TABLE(tt_desc->tt_base[index]))
+        return;
+
+    tt_base_next_level = val_memory_phys_to_virt(tt_desc->tt_base[index] & pgt_addr_mask);
+    tt_desc->tt_base[index] = 0;
+    free_translation_table(tt_base_next_level, bits_per_level, tt_desc->level + 1);
+    pgt_table_free(tt_base_next_level);
+}
+
+/**
+  @brief  This API fills a next level table with the mapping of a block descriptor it
+          replaces, so that the rest of the block stays mapped
+
+  @param  table      Next level table
+  @param  block      Block descriptor being split
+  @param  level      Level of the next level table
+  @param  size_log2  log2 of the size mapped by one entry of the next level table
+
+  @return None
+**/
+static
+void pgt_split_block(uint64_t *table, uint64_t block, uint32_t level, uint32_t size_log2)
+{
+    uint64_t num = 0x1ull << bits_per_level;
+    uint64_t attr = PGT_DESC_ATTRIBUTES(block) & ~PGT_ENTRY_CONTIG_MASK;
+    uint64_t output_address = block & pgt_addr_mask & ~((0x1ull << (size_log2 + bits_per_level)) - 1);
+    uint64_t i;
+
+    attr |= PGT_ENTRY_VALID_MASK;
+    attr |= (level == PGT_LEVEL_3) ? PGT_ENTRY_PAGE_MASK : PGT_ENTRY_BLOCK_MASK;
+
+    /* The whole table maps one aligned range, so every run can be marked contiguous */
+    if (pgt_contig_entries(page_size, level) <= num)
+        attr |= PGT_ENTRY_CONTIG_MASK;
+
+    for (i = 0; i < num; i++)
+        table[i] = (output_address + (i << size_log2)) | attr;
+}
+
+/**
+  @brief  This API fills the translation table. Each range is mapped with the largest
+          descriptor allowed by its alignment, and aligned runs of descriptors mapping
+          a contiguous output range are marked with the contiguous hint.
 
   @param  tt_desc   Translation Table Descriptor
   @param  mem_desc  Memory Descriptor
@@ -172,66 +329,70 @@ static
 uint32_t fill_translation_table(tt_descriptor_t tt_desc, memory_region_descriptor_t *mem_desc)
 {
     uint64_t block_size = 0x1ull << tt_desc.size_log2;
-    uint64_t input_address, output_address, filled_tables, table_index, max_allowed_mem;
+    uint64_t contig_num = pgt_contig_entries(page_size, tt_desc.level);
+    uint64_t contig_size = block_size * contig_num;
+    uint64_t input_address, output_address, next_address, table_index, leaf, i;
+    uint64_t attributes = mem_desc->attributes & ~PGT_ENTRY_CONTIG_MASK;
     uint64_t *tt_base_next_level, *table_desc;
+    uint32_t is_new_table;
     tt_descriptor_t tt_desc_next_level;
 
-    val_print(PGT_DEBUG_LEVEL, "\n       tt_desc.level: %d     ", tt_desc.level);
-    val_print(PGT_DEBUG_LEVEL, "\n       tt_desc.input_base: 0x%llx     ", tt_desc.input_base);
-    val_print(PGT_DEBUG_LEVEL, "\n       tt_desc.input_top: 0x%llx     ", tt_desc.input_top);
-    val_print(PGT_DEBUG_LEVEL, "\n       tt_desc.output_base: 0x%llx     ", tt_desc.output_base);
-    val_print(PGT_DEBUG_LEVEL, "\n       tt_desc.size_log2: %d     ", tt_desc.size_log2);
-    val_print(PGT_DEBUG_LEVEL, "\n       tt_desc.nbits: %d     ", tt_desc.nbits);
+    if (tt_desc.level == PGT_LEVEL_3)
+        leaf = PGT_ENTRY_PAGE_MASK | PGT_ENTRY_VALID_MASK | attributes;
+    else
+        leaf = PGT_ENTRY_BLOCK_MASK | PGT_ENTRY_VALID_MASK | attributes;
 
-    if (!is_values_init) {
-        setup_acs_pgt_values();
-        is_values_init = 1;
-    }
+    input_address = tt_desc.input_base;
+    output_address = tt_desc.output_base;
 
-    for (input_address = tt_desc.input_base, output_address = tt_desc.output_base;
-         input_address < tt_desc.input_top;
-         input_address += (block_size - offset), output_address += (block_size - offset))
+    while (input_address <= tt_desc.input_top)
     {
         table_index = input_address >> tt_desc.size_log2 & ((0x1ull << tt_desc.nbits) - 1);
         table_desc = &tt_desc.tt_base[table_index];
+        next_address = (input_address | (block_size - 1)) + 1;
 
-        val_print(PGT_DEBUG_LEVEL, "\n       table_index = %d     ", table_index);
-
-        if (tt_desc.level == 3)
+        /* Level 3 always maps a page, a trailing partial page included */
+        if (tt_desc.level == PGT_LEVEL_3 ||
+            (pgt_block_allowed(tt_desc.level) &&
+             (input_address & (block_size - 1)) == 0 &&
+             (output_address & (block_size - 1)) == 0 &&
+             tt_desc.input_top >= (next_address - 1)))
         {
-            //Create level 3 page descriptor entry
-            *table_desc = PGT_ENTRY_PAGE_MASK | PGT_ENTRY_VALID_MASK;
-            *table_desc |= (output_address & ~(uint64_t)(page_size - 1));
-            *table_desc |= mem_desc->attributes;
-            val_print(PGT_DEBUG_LEVEL, "\n       page_descriptor = 0x%llx     ", *table_desc);
-            /* Keep a count of number of L3 tables filled. If the number exceedes the limit, move
-               to next L2 table and continue.  */
-            increment_pgt_index(tt_desc.level, get_entries_per_level(page_size));
-            offset = 0;
-            continue;
-        }
+            if (pgt_owned && contig_num <= (0x1ull << tt_desc.nbits) &&
+                (input_address & (contig_size - 1)) == 0 &&
+                (output_address & (contig_size - 1)) == 0 &&
+                tt_desc.input_top >= (input_address + contig_size - 1))
+            {
+                for (i = 0; i < contig_num; i++) {
+                    pgt_release_entry(&tt_desc, table_index + i);
+                    table_desc[i] = ((output_address + i * block_size) & ~(block_size - 1)) |
+                                    leaf | PGT_ENTRY_CONTIG_MASK;
+                }
 
-        //Are input and output addresses eligible for being described via block descriptor?
-        if ((input_address & (block_size - 1)) == 0 &&
-             (output_address & (block_size - 1)) == 0 &&
-             tt_desc.input_top >= (input_address + block_size - 1)) {
-            //Create a block descriptor entry
-            *table_desc = PGT_ENTRY_BLOCK_MASK | PGT_ENTRY_VALID_MASK;
-            *table_desc |= (output_address & ~(block_size - 1));
-            *table_desc |= mem_desc->attributes;
-            val_print(PGT_DEBUG_LEVEL, "\n       block_descriptor = 0x%llx     ", *table_desc);
-            increment_pgt_index(tt_desc.level, get_entries_per_level(page_size));
-            offset = 0;
+                pgt_stats.contig += contig_num;
+                next_address = input_address + contig_size;
+            } else {
+                pgt_break_contig(&tt_desc, table_index);
+                pgt_release_entry(&tt_desc, table_index);
+                pgt_write_desc(table_desc, (output_address & ~(block_size - 1)) | leaf);
+            }
+
+            if (tt_desc.level == PGT_LEVEL_3)
+                pgt_stats.pages += (next_address - input_address) >> tt_desc.size_log2;
+            else
+                pgt_stats.blocks += (next_address - input_address) >> tt_desc.size_log2;
+
+            output_address += next_address - input_address;
+            input_address = next_address;
             continue;
         }
-        /*
-        If there's no descriptor populated at current index of this page_table, or
-        If there's a block descriptor, allocate new page, else use the already populated address.
-        Block descriptor info will be overwritten in case its there.
-        */
-        if (*table_desc == 0 || IS_PGT_ENTRY_BLOCK(*table_desc))
+
+        /* Descend into an existing table, else allocate one, keeping the mapping of a
+           block descriptor being replaced in tables val_pgt_create owns */
+        is_new_table = !IS_PGT_ENTRY_TABLE(*table_desc);
+        if (is_new_table)
         {
-            tt_base_next_level = val_memory_alloc_pages(1);
+            tt_base_next_level = pgt_table_alloc();
             if (tt_base_next_level == NULL)
             {
                 val_print(ACS_PRINT_ERR,
@@ -239,39 +400,41 @@ uint32_t fill_translation_table(tt_descriptor_t tt_desc, memory_region_descripto
                 0);
                 return ACS_STATUS_ERR;
             }
-            val_memory_set(tt_base_next_level, page_size, 0);
+
+            if (pgt_owned && pgt_entry_is_leaf(*table_desc, tt_desc.level))
+                pgt_split_block(tt_base_next_level, *table_desc, tt_desc.level + 1,
+                                tt_desc.size_log2 - bits_per_level);
         }
         else
             tt_base_next_level = val_memory_phys_to_virt(*table_desc & pgt_addr_mask);
 
-        tt_desc_next_level.tt_base    = tt_base_next_level;
-        tt_desc_next_level.input_base = input_address;
-        filled_tables                 = get_pgt_index(tt_desc.level + 1);
-        offset                        = filled_tables * get_block_size(tt_desc.level + 1);
-
-        val_print(PGT_DEBUG_LEVEL, "       filled_tables in next level = 0x%llx", filled_tables);
-        val_print(PGT_DEBUG_LEVEL, "       offset = 0x%llx", offset);
-
-        // Calculate the maximum allowed mem addr that can be mapped for the L0/L1/L2 table.
-        // This prevents overwriting page tables.
-        max_allowed_mem                = input_address + block_size - offset - 1;
-        tt_desc_next_level.input_top   = get_min(tt_desc.input_top, max_allowed_mem);
+        tt_desc_next_level.tt_base     = tt_base_next_level;
+        tt_desc_next_level.input_base  = input_address;
+        tt_desc_next_level.input_top   = get_min(tt_desc.input_top, next_address - 1);
         tt_desc_next_level.output_base = output_address;
         tt_desc_next_level.level       = tt_desc.level + 1;
         tt_desc_next_level.size_log2   = tt_desc.size_log2 - bits_per_level;
         tt_desc_next_level.nbits       = bits_per_level;
-        increment_pgt_index(tt_desc.level, get_entries_per_level(page_size));
 
         if (fill_translation_table(tt_desc_next_level, mem_desc))
         {
-            val_memory_free_pages(tt_base_next_level, 1);
+            if (is_new_table) {
+                free_translation_table(tt_base_next_level, bits_per_level, tt_desc.level + 1);
+                pgt_table_free(tt_base_next_level);
+            }
             return ACS_STATUS_ERR;
         }
 
-        *table_desc = PGT_ENTRY_TABLE_MASK | PGT_ENTRY_VALID_MASK;
-        *table_desc |= (uint64_t)val_memory_virt_to_phys(tt_base_next_level) &
-                       ~(uint64_t)(page_size - 1);
-        val_print(PGT_DEBUG_LEVEL, "\n      table_descriptor = 0x%llx     ", *table_desc);
+        if (is_new_table)
+        {
+            pgt_break_contig(&tt_desc, table_index);
+            pgt_write_desc(table_desc, PGT_ENTRY_TABLE_MASK | PGT_ENTRY_VALID_MASK |
+                           ((uint64_t)val_memory_virt_to_phys(tt_base_next_level) &
+                            ~(uint64_t)(page_size - 1)));
+        }
+
+        output_address += next_address - input_address;
+        input_address = next_address;
     }
     return 0;
 }
@@ -296,10 +459,163 @@ static uint32_t log2_page_size(uint64_t size)
     return 0;
 }
 
+/**
+  @brief  This API returns the number of regions of a descriptor list, 0 if the list
+          is too long to be shared
+
+  @param  mem_desc  Memory Descriptor list, ended by a zero length entry
+
+  @return number of regions
+**/
+static
+uint32_t pgt_cache_num_regions(memory_region_descriptor_t *mem_desc)
+{
+    uint32_t num = 0;
+
+    while (mem_desc[num].length != 0) {
+        if (++num > PGT_CACHE_MAX_REGIONS)
+            return 0;
+    }
+
+    return num;
+}
+
+static
+uint32_t pgt_tcr_equal(PE_TCR_BF *tcr1, PE_TCR_BF *tcr2)
+{
+    return (tcr1->ps == tcr2->ps && tcr1->tg == tcr2->tg && tcr1->sh == tcr2->sh &&
+            tcr1->orgn == tcr2->orgn && tcr1->irgn == tcr2->irgn && tcr1->tsz == tcr2->tsz &&
+            tcr1->sl == tcr2->sl && tcr1->tg_size_log2 == tcr2->tg_size_log2);
+}
+
+/**
+  @brief  This API looks up shared tables with the same layout and translation attributes
+
+  @param  mem_desc  Memory Descriptor list
+  @param  pgt_desc  Translation attributes
+
+  @return cache entry, NULL if none
+**/
+static
+pgt_cache_entry_t *pgt_cache_lookup(memory_region_descriptor_t *mem_desc,
+                                    pgt_descriptor_t *pgt_desc)
+{
+    uint32_t i, j, num = pgt_cache_num_regions(mem_desc);
+    pgt_cache_entry_t *entry;
+
+    if (num == 0)
+        return NULL;
+
+    for (i = 0; i < PGT_CACHE_MAX; i++)
+    {
+        entry = &pgt_cache[i];
+        if (!entry->pgt_base || !entry->share || entry->ias != pgt_desc->ias ||
+            entry->oas != pgt_desc->oas || entry->page_size != page_size ||
+            entry->stage != pgt_desc->stage || entry->mair != pgt_desc->mair ||
+            !pgt_tcr_equal(&entry->tcr, &pgt_desc->tcr) || entry->num_regions != num)
+            continue;
+
+        for (j = 0; j < num; j++) {
+            if (entry->region[j].virtual_address != mem_desc[j].virtual_address ||
+                entry->region[j].physical_address != mem_desc[j].physical_address ||
+                entry->region[j].length != mem_desc[j].length ||
+                entry->region[j].attributes != mem_desc[j].attributes)
+                break;
+        }
+
+        if (j == num)
+            return entry;
+    }
+
+    return NULL;
+}
+
+static
+pgt_cache_entry_t *pgt_cache_find_base(uint64_t pgt_base)
+{
+    uint32_t i;
+
+    for (i = 0; i < PGT_CACHE_MAX; i++) {
+        if (pgt_cache[i].pgt_base == pgt_base)
+            return &pgt_cache[i];
+    }
+
+    return NULL;
+}
+
+/**
+  @brief  This API frees a translation table hierarchy
+
+  @param  pgt_base  Root table
+  @param  ias       Input address size of the tables
+  @param  oas       Output address size of the tables
+
+  @return None
+**/
+static
+void pgt_free_tables(uint64_t pgt_base, uint32_t ias, uint32_t oas)
+{
+    uint32_t page_size_log2, num_pgt_levels;
+    uint64_t *pgt_base_virt = val_memory_phys_to_virt(pgt_base);
+
+    pgt_walk_cache_invalidate(pgt_base);
+
+    page_size = val_memory_page_size();
+    page_size_log2 = log2_page_size(page_size);
+    bits_per_level =  page_size_log2 - 3;
+    pgt_addr_mask = ((0x1ull << (oas - page_size_log2)) - 1) << page_size_log2;
+    num_pgt_levels = (ias - page_size_log2 + bits_per_level - 1)/bits_per_level;
+
+    free_translation_table(pgt_base_virt,
+                           ias - ((num_pgt_levels - 1) * bits_per_level + page_size_log2),
+                           4 - num_pgt_levels);
+    pgt_table_free(pgt_base_virt);
+}
+
+/**
+  @brief  This API records a root allocated by val_pgt_create, with its layout if the
+          caller asked for the tables to be shared
+
+  @param  mem_desc  Memory Descriptor list the tables were built from
+  @param  pgt_desc  Translation attributes and root of the tables
+
+  @return None
+**/
+static
+void pgt_cache_insert(memory_region_descriptor_t *mem_desc, pgt_descriptor_t *pgt_desc)
+{
+    uint32_t i, num = pgt_cache_num_regions(mem_desc);
+    pgt_cache_entry_t *entry = pgt_cache_find_base(0);
+
+    if (entry == NULL)
+        return;
+
+    entry->pgt_base = pgt_desc->pgt_base;
+    entry->ias = pgt_desc->ias;
+    entry->oas = pgt_desc->oas;
+    entry->page_size = val_memory_page_size();
+    entry->stage = pgt_desc->stage;
+    entry->mair = pgt_desc->mair;
+    entry->tcr = pgt_desc->tcr;
+    entry->share = (pgt_desc->flags & PGT_FLAG_SHARE) && num != 0;
+    entry->num_regions = num;
+    entry->refcount = 1;
+
+    for (i = 0; i < num; i++)
+        entry->region[i] = mem_desc[i];
+}
+
 /**
   @brief Create stage 1 or stage 2 page table, with given memory addresses and attributes
          Note: This API updates existing translation table if pgt_desc->pgt_base is not NULL
                else it created new table and updated pgt_desc->pgt_base with the address.
+               With PGT_FLAG_SHARE in pgt_desc->flags, a new table may be the one built
+               for an earlier request with the same regions and translation attributes
+               that also asked for sharing. Updating tables held by more than one user
+               fails, tables with a single user are updated in place.
+               Tables not allocated here, such as the live TTBR0 tables, are updated
+               without splitting blocks or setting the contiguous hint, and their valid
+               entries are replaced with break-before-make.
   @param mem_desc - Array of memory addresses and attributes needed for page table creation.
   @param pgt_desc - Data structure for output page table base and input translation attributes.
   @return status
@@ -308,8 +624,9 @@ uint32_t val_pgt_create(memory_region_descriptor_t *mem_desc, pgt_descriptor_t *
 {
     uint64_t *tt_base;
     tt_descriptor_t tt_desc;
-    uint32_t num_pgt_levels, page_size_log2;
+    uint32_t num_pgt_levels, page_size_log2, is_new_table;
     memory_region_descriptor_t *mem_desc_iter;
+    pgt_cache_entry_t *entry = NULL;
 
     page_size = val_memory_page_size();
     page_size_log2 = log2_page_size(page_size);
@@ -319,72 +636,268 @@ uint32_t val_pgt_create(memory_region_descriptor_t *mem_desc, pgt_descriptor_t *
     val_print(PGT_DEBUG_LEVEL, "\n       val_pgt_create: nbits_per_level = %d    ", bits_per_level);
     val_print(PGT_DEBUG_LEVEL, "\n       val_pgt_create: page_size_log2 = %d     ", page_size_log2);
 
+    val_memory_set(&pgt_stats, sizeof(pgt_stats), 0);
+
     /* check whether input page descriptor has base addr of translation table
        to use. If the pgt_base member is NULL allocate a page to create a new
        table, else update existing translation table */
-    if (pgt_desc->pgt_base == (uint64_t) NULL) {
-        tt_base = (uint64_t *) val_memory_alloc_pages(1);
+    pgt_addr_mask = ((0x1ull << (pgt_desc->oas - page_size_log2)) - 1) << page_size_log2;
+
+    is_new_table = (pgt_desc->pgt_base == (uint64_t) NULL);
+    if (is_new_table) {
+        /* Share the tables of an identical earlier request */
+        if (pgt_desc->flags & PGT_FLAG_SHARE)
+            entry = pgt_cache_lookup(mem_desc, pgt_desc);
+        if (entry) {
+            entry->refcount++;
+            pgt_desc->pgt_base = entry->pgt_base;
+            val_print(PGT_DEBUG_LEVEL, "\n       val_pgt_create: reusing tables at 0x%llx     ",
+                      entry->pgt_base);
+            return 0;
+        }
+
+        tt_base = pgt_table_alloc();
         if (tt_base == NULL) {
             val_print(ACS_PRINT_ERR, "\n      val_pgt_create: page allocation failed     ", 0);
             return ACS_STATUS_ERR;
         }
-        val_memory_set(tt_base, page_size, 0);
     }
-    else
+    else {
         tt_base = (uint64_t *) pgt_desc->pgt_base;
+        pgt_walk_cache_invalidate(pgt_desc->pgt_base);
+    }
+
+    /* Tables held by other users stay as they are, a single user's tables stop being
+       shared once updated */
+    pgt_owned = is_new_table;
+    if (!is_new_table && (entry = pgt_cache_find_base(pgt_desc->pgt_base)) != NULL) {
+        if (entry->refcount > 1) {
+            val_print(ACS_PRINT_ERR, "\n      val_pgt_create: tables at 0x%llx are shared     ",
+                      pgt_desc->pgt_base);
+            return ACS_STATUS_ERR;
+        }
+
+        pgt_owned = 1;
+        entry->share = 0;
+    }
 
     tt_desc.tt_base = tt_base;
-    pgt_addr_mask = ((0x1ull << (pgt_desc->ias - page_size_log2)) - 1) << page_size_log2;
 
     for (mem_desc_iter = mem_desc; mem_desc_iter->length != 0; ++mem_desc_iter)
     {
         val_print(PGT_DEBUG_LEVEL,
                   "      val_pgt_create: input addr = 0x%x     ",
-                  mem_desc->virtual_address);
+                  mem_desc_iter->virtual_address);
         val_print(PGT_DEBUG_LEVEL,
                   "      val_pgt_create: output addr = 0x%x     ",
-                  mem_desc->physical_address);
-        val_print(PGT_DEBUG_LEVEL, "      val_pgt_create: length = 0x%x\n     ", mem_desc->length);
-        if ((mem_desc->virtual_address & (uint64_t)(page_size - 1)) != 0 ||
-            (mem_desc->physical_address & (uint64_t)(page_size - 1)) != 0)
+                  mem_desc_iter->physical_address);
+        val_print(PGT_DEBUG_LEVEL, "      val_pgt_create: length = 0x%x\n     ", mem_desc_iter->length);
+        if ((mem_desc_iter->virtual_address & (uint64_t)(page_size - 1)) != 0 ||
+            (mem_desc_iter->physical_address & (uint64_t)(page_size - 1)) != 0)
             {
                 val_print(ACS_PRINT_ERR, "\n       val_pgt_create: addr alignment err     ", 0);
-                return ACS_STATUS_ERR;
+                break;
             }
 
-        if (mem_desc->physical_address >= (0x1ull << pgt_desc->oas))
+        if (mem_desc_iter->physical_address >= (0x1ull << pgt_desc->oas))
         {
             val_print(ACS_PRINT_ERR,
                       "\n       val_pgt_create: output address size error     ",
                       0);
-            return ACS_STATUS_ERR;
+            break;
         }
 
-        if (mem_desc->virtual_address >= (0x1ull << pgt_desc->ias))
+        if (mem_desc_iter->virtual_address >= (0x1ull << pgt_desc->ias))
         {
             val_print(ACS_PRINT_WARN,
                       "\n       val_pgt_create: input address size error, "
                       "truncating to %d-bits     ",
                       pgt_desc->ias);
-            mem_desc->virtual_address &= ((0x1ull << pgt_desc->ias) - 1);
+            mem_desc_iter->virtual_address &= ((0x1ull << pgt_desc->ias) - 1);
         }
 
-        tt_desc.input_base = mem_desc->virtual_address & ((0x1ull << pgt_desc->ias) - 1);
-        tt_desc.input_top = tt_desc.input_base + mem_desc->length - 1;
-        tt_desc.output_base = mem_desc->physical_address & ((0x1ull << pgt_desc->oas) - 1);
+        tt_desc.input_base = mem_desc_iter->virtual_address & ((0x1ull << pgt_desc->ias) - 1);
+        tt_desc.input_top = tt_desc.input_base + mem_desc_iter->length - 1;
+        tt_desc.output_base = mem_desc_iter->physical_address & ((0x1ull << pgt_desc->oas) - 1);
         tt_desc.level = 4 - num_pgt_levels;
         tt_desc.size_log2 = (num_pgt_levels - 1) * bits_per_level + page_size_log2;
         tt_desc.nbits = pgt_desc->ias - tt_desc.size_log2;
 
-        if (fill_translation_table(tt_desc, mem_desc))
-        {
-            val_memory_free_pages(tt_base, 1);
+        if (fill_translation_table(tt_desc, mem_desc_iter))
+            break;
+    }
+
+    if (mem_desc_iter->length != 0)
+    {
+        /* Drop a new hierarchy whole. Updates already made to existing tables are kept. */
+        if (is_new_table)
+            pgt_free_tables((uint64_t)val_memory_virt_to_phys(tt_base),
+                            pgt_desc->ias, pgt_desc->oas);
+        return ACS_STATUS_ERR;
+    }
+
+    val_print(PGT_DEBUG_LEVEL, "\n       val_pgt_create: tables = %d     ", pgt_stats.tables);
+    val_print(PGT_DEBUG_LEVEL, "\n       val_pgt_create: blocks = %d     ", pgt_stats.blocks);
+    val_print(PGT_DEBUG_LEVEL, "\n       val_pgt_create: pages = %d     ", pgt_stats.pages);
+    val_print(PGT_DEBUG_LEVEL, "\n       val_pgt_create: contiguous = %d     ", pgt_stats.contig);
+
+    /* New entries of tables in use are visible to the walker before returning */
+    if (!pgt_owned)
+        val_mem_issue_dsb();
+
+    pgt_desc->pgt_base = (uint64_t)val_memory_virt_to_phys(tt_base);
+
+    if (is_new_table)
+        pgt_cache_insert(mem_desc, pgt_desc);
+
+    return 0;
+}
+
+/**
+  @brief  This API walks translation tables to the leaf descriptor of an address
+
+  @param  pgt_desc         page table base and translation attributes
+  @param  virtual_address  address to translate
+  @param  walk             output descriptors read, sizes mapped by the leaf
+
+  @return 0 if Success
+**/
+static
+uint32_t pgt_walk(pgt_descriptor_t *pgt_desc, uint64_t virtual_address,
+                  pgt_walk_cache_entry_t *walk)
+{
+    uint32_t ias, index, num_pgt_levels, this_level, level_bits;
+    uint32_t bits_at_this_level, bits_remaining;
+    uint64_t val64, addr_mask, tt_base_phys, *tt_base_virt;
+    uint32_t page_size_log2 = pgt_desc->tcr.tg_size_log2;
+
+    ias = (uint32_t)64 - pgt_desc->tcr.tsz;
+
+    level_bits = page_size_log2 - 3;
+    num_pgt_levels = (ias - page_size_log2 + level_bits - 1)/level_bits;
+    if (num_pgt_levels > PGT_WALK_MAX_LEVELS)
+        return ACS_STATUS_ERR;
+    this_level = 4 - num_pgt_levels;
+    bits_remaining = (num_pgt_levels - 1) * level_bits + page_size_log2;
+    bits_at_this_level = ias - bits_remaining;
+    addr_mask = ((0x1ull << (ias - page_size_log2)) - 1) << page_size_log2;
+    tt_base_phys = pgt_desc->pgt_base;
+    walk->depth = 0;
+
+    while (1) {
+        index = (virtual_address >> bits_remaining) & ((0x1u << bits_at_this_level) - 1);
+        tt_base_virt = (uint64_t *)val_memory_phys_to_virt(tt_base_phys);
+        val64 = tt_base_virt[index];
+        walk->slot[walk->depth] = &tt_base_virt[index];
+        walk->desc[walk->depth++] = val64;
+
+        if (IS_PGT_ENTRY_INVALID(val64) || (this_level == 3 && !IS_PGT_ENTRY_PAGE(val64))) {
+            val_print(PGT_DEBUG_LEVEL, "\n       pgt_walk: no mapping at level %d     ",
+                      this_level);
             return ACS_STATUS_ERR;
         }
+
+        if (this_level == 3 || IS_PGT_ENTRY_BLOCK(val64)) {
+            walk->leaf_log2 = bits_remaining;
+            walk->size_log2 = bits_remaining;
+
+            /* Entries of a contiguous run share their attributes */
+            if ((val64 & PGT_ENTRY_CONTIG_MASK) &&
+                pgt_contig_entries(0x1u << page_size_log2, this_level) <=
+                                                              (0x1ull << bits_at_this_level))
+                walk->size_log2 += log2_page_size(pgt_contig_entries(0x1u << page_size_log2,
+                                                                     this_level));
+            return 0;
+        }
+
+        tt_base_phys = val64 & addr_mask;
+        ++this_level;
+        bits_remaining -= level_bits;
+        bits_at_this_level = level_bits;
     }
+}
 
-    pgt_desc->pgt_base = (uint64_t)val_memory_virt_to_phys(tt_base);
+/**
+  @brief  This API checks that the descriptors of a cached walk are unchanged, the leaf
+          being the entry of the contiguous run that maps the address
+
+  @param  entry            cached walk
+  @param  virtual_address  address to translate, within the leaf or its run
+
+  @return 1 if the cached walk is still valid
+**/
+static
+uint32_t pgt_walk_cache_valid(pgt_walk_cache_entry_t *entry, uint64_t virtual_address)
+{
+    uint32_t k, leaf = entry->depth - 1;
+    int64_t delta = (int64_t)((virtual_address >> entry->leaf_log2) -
+                              (entry->va >> entry->leaf_log2));
+
+    for (k = 0; k < leaf; k++) {
+        if (*entry->slot[k] != entry->desc[k])
+            return 0;
+    }
+
+    /* Entries of a run map consecutive blocks of one output range */
+    return entry->slot[leaf][delta] == entry->desc[leaf] + ((uint64_t)delta << entry->leaf_log2);
+}
 
+/**
+  @brief  This API returns the leaf descriptor of an address, from the walk cache if a
+          recent walk of the same table found it. Only tables val_pgt_create allocated
+          are cached.
+
+  @param  pgt_desc         page table base and translation attributes
+  @param  virtual_address  address to translate
+  @param  desc             output leaf descriptor
+  @param  size_log2        output log2 of the size sharing the descriptor attributes
+
+  @return 0 if Success
+**/
+static
+uint32_t pgt_walk_cached(pgt_descriptor_t *pgt_desc, uint64_t virtual_address, uint64_t *desc,
+                         uint32_t *size_log2)
+{
+    pgt_walk_cache_entry_t *entry, walk;
+    uint32_t i;
+
+    if (pgt_cache_find_base(pgt_desc->pgt_base) == NULL) {
+        if (pgt_walk(pgt_desc, virtual_address, &walk))
+            return ACS_STATUS_ERR;
+
+        *desc = walk.desc[walk.depth - 1];
+        *size_log2 = walk.size_log2;
+        return 0;
+    }
+
+    for (i = 0; i < PGT_WALK_CACHE_SIZE; i++)
+    {
+        entry = &pgt_walk_cache[i];
+        if (entry->size_log2 && entry->pgt_base == pgt_desc->pgt_base &&
+            (entry->va >> entry->size_log2) == (virtual_address >> entry->size_log2))
+        {
+            if (!pgt_walk_cache_valid(entry, virtual_address)) {
+                entry->size_log2 = 0;
+                break;
+            }
+
+            *desc = entry->desc[entry->depth - 1];
+            *size_log2 = entry->size_log2;
+            return 0;
+        }
+    }
+
+    entry = &pgt_walk_cache[pgt_walk_cache_next];
+    entry->size_log2 = 0;
+    if (pgt_walk(pgt_desc, virtual_address, entry))
+        return ACS_STATUS_ERR;
+
+    pgt_walk_cache_next = (pgt_walk_cache_next + 1) % PGT_WALK_CACHE_SIZE;
+    entry->pgt_base = pgt_desc->pgt_base;
+    entry->va = virtual_address;
+
+    *desc = entry->desc[entry->depth - 1];
+    *size_log2 = entry->size_log2;
     return 0;
 }
 
@@ -398,9 +911,36 @@ uint32_t val_pgt_create(memory_region_descriptor_t *mem_desc, pgt_descriptor_t *
 uint64_t val_pgt_get_attributes(pgt_descriptor_t pgt_desc, uint64_t virtual_address,
                                 uint64_t *attributes)
 {
-    uint32_t ias, index, num_pgt_levels, this_level;
-    uint32_t bits_at_this_level, bits_remaining;
-    uint64_t val64, tt_base_phys, *tt_base_virt;
+    uint64_t desc;
+    uint32_t size_log2;
+
+    if (attributes == NULL)
+        return ACS_STATUS_ERR;
+
+    if (!pgt_desc.pgt_base)
+        return ACS_STATUS_ERR;
+
+    if (pgt_walk_cached(&pgt_desc, virtual_address, &desc, &size_log2))
+        return ACS_STATUS_ERR;
+
+    *attributes = PGT_DESC_ATTRIBUTES(desc) & ~PGT_ENTRY_CONTIG_MASK;
+    return 0;
+}
+
+/**
+  @brief Get attributes of consecutive pages starting at a given virtual address. Each
+         leaf descriptor is looked up once for all the pages it maps.
+  @param pgt_desc - page table base and translation attributes.
+  @param virtual_address - virtual address of the first page.
+  @param num_pages - number of translation granule sized pages.
+  @param attributes - output attributes, one per page
+  @return status, error if any page is not mapped
+**/
+uint64_t val_pgt_get_attributes_range(pgt_descriptor_t pgt_desc, uint64_t virtual_address,
+                                      uint32_t num_pages, uint64_t *attributes)
+{
+    uint64_t desc, attr, next_address;
+    uint32_t i = 0, size_log2;
     uint32_t page_size_log2 = pgt_desc.tcr.tg_size_log2;
 
     if (attributes == NULL)
@@ -409,49 +949,23 @@ uint64_t val_pgt_get_attributes(pgt_descriptor_t pgt_desc, uint64_t virtual_addr
     if (!pgt_desc.pgt_base)
         return ACS_STATUS_ERR;
 
-    ias = (uint32_t)64 - pgt_desc.tcr.tsz;
+    virtual_address &= ~((0x1ull << page_size_log2) - 1);
 
-    bits_per_level = page_size_log2 - 3;
-    num_pgt_levels = (ias - page_size_log2 + bits_per_level - 1)/bits_per_level;
-    this_level = 4 - num_pgt_levels;
-    bits_remaining = (num_pgt_levels - 1) * bits_per_level + page_size_log2;
-    bits_at_this_level = ias - bits_remaining;
-    tt_base_phys = pgt_desc.pgt_base;
+    while (i < num_pages)
+    {
+        if (pgt_walk_cached(&pgt_desc, virtual_address, &desc, &size_log2))
+            return ACS_STATUS_ERR;
 
-    while (1) {
-        index = (virtual_address >> bits_remaining) & ((0x1u << bits_at_this_level) - 1);
-        tt_base_virt = (uint64_t*)val_memory_phys_to_virt(tt_base_phys);
-        val64 = tt_base_virt[index];
+        attr = PGT_DESC_ATTRIBUTES(desc) & ~PGT_ENTRY_CONTIG_MASK;
+        next_address = (virtual_address | ((0x1ull << size_log2) - 1)) + 1;
 
-        val_print(PGT_DEBUG_LEVEL,
-                  "\n       val_pgt_get_attributes: this_level = %d     ",
-                  this_level);
-        val_print(PGT_DEBUG_LEVEL,
-                  "\n       val_pgt_get_attributes: index = %d     ",
-                  index);
-        val_print(PGT_DEBUG_LEVEL,
-                  "\n       val_pgt_get_attributes: bits_remaining = %d     ",
-                  bits_remaining);
-        val_print(PGT_DEBUG_LEVEL,
-                  "\n       val_pgt_get_attributes: tt_base_virt = %x     ",
-                  (uint64_t)tt_base_virt);
-        val_print(PGT_DEBUG_LEVEL, "\n       val_pgt_get_attributes: val64 = %x     ", val64);
-        if (this_level == 3)
-        {
-            if (!IS_PGT_ENTRY_PAGE(val64))
-                return ACS_STATUS_ERR;
-            *attributes = PGT_DESC_ATTRIBUTES(val64);
-            return 0;
-        }
-        if (IS_PGT_ENTRY_BLOCK(val64)) {
-            *attributes = PGT_DESC_ATTRIBUTES(val64);
-            return 0;
+        for (; virtual_address < next_address && i < num_pages; i++) {
+            attributes[i] = attr;
+            virtual_address += (0x1ull << page_size_log2);
         }
-        tt_base_phys = val64 & (((0x1ull << (ias - page_size_log2)) - 1) << page_size_log2);
-        ++this_level;
-        bits_remaining -= bits_at_this_level;
-        bits_at_this_level = bits_per_level;
     }
+
+    return 0;
 }
 
 /**
@@ -484,33 +998,62 @@ static void free_translation_table(uint64_t *tt_base, uint32_t bits_at_this_leve
             val_print(PGT_DEBUG_LEVEL,
                       "\n       free_translation_table: tt_base_next_virt = %llx     ",
                       (uint64_t)tt_base_next_virt);
-            val_memory_free_pages(tt_base_next_virt, 1);
+            pgt_table_free(tt_base_next_virt);
         }
     }
 }
 
 /**
   @brief Free all page tables in the page table hierarchy starting from the base page table.
+         Shared tables are freed when their last user passes them here.
   @param pgt_desc - page table base and translation attributes.
   @return void
 **/
 void val_pgt_destroy(pgt_descriptor_t pgt_desc)
 {
-    uint32_t page_size_log2, num_pgt_levels;
-    uint64_t *pgt_base_virt = val_memory_phys_to_virt(pgt_desc.pgt_base);
+    pgt_cache_entry_t *entry;
 
     if (!pgt_desc.pgt_base)
         return;
 
     val_print(PGT_DEBUG_LEVEL, "\n       val_pgt_destroy: pgt_base = %llx     ", pgt_desc.pgt_base);
-    page_size = val_memory_page_size();
-    page_size_log2 = log2_page_size(page_size);
-    bits_per_level =  page_size_log2 - 3;
-    pgt_addr_mask = ((0x1ull << (pgt_desc.ias - page_size_log2)) - 1) << page_size_log2;
-    num_pgt_levels = (pgt_desc.ias - page_size_log2 + bits_per_level - 1)/bits_per_level;
 
-    free_translation_table(pgt_base_virt,
-                           pgt_desc.ias - ((num_pgt_levels - 1) * bits_per_level + page_size_log2),
-                           4 - num_pgt_levels);
-    val_memory_free_pages(pgt_base_virt, 1);
+    entry = pgt_cache_find_base(pgt_desc.pgt_base);
+    if (entry) {
+        if (--entry->refcount)
+            return;
+        entry->pgt_base = 0;
+    }
+
+    pgt_free_tables(pgt_desc.pgt_base, pgt_desc.ias, pgt_desc.oas);
+}
+
+/**
+  @brief Free the table pages kept for reuse by val_pgt_create and forget the tables
+         not yet destroyed, so that no later request shares them. Called at teardown.
+  @return void
+**/
+void val_pgt_release(void)
+{
+    uint64_t *table;
+    uint32_t i;
+
+    for (i = 0; i < PGT_CACHE_MAX; i++)
+    {
+        if (!pgt_cache[i].pgt_base)
+            continue;
+
+        val_print(ACS_PRINT_WARN, "\n       val_pgt_release: tables at 0x%llx not destroyed",
+                  pgt_cache[i].pgt_base);
+        pgt_cache[i].pgt_base = 0;
+    }
+
+    pgt_walk_cache_invalidate(0);
+
+    while ((table = pgt_pool_free_list) != NULL) {
+        pgt_pool_free_list = (uint64_t *)table[0];
+        val_memory_free_pages(table, 1);
+    }
+
+    pgt_pool_free_count = 0;
 }
@@ -53,6 +53,9 @@ BITFIELD_DECL(uint32_t, IDR1_SSIDSIZE, 10, 6)
 BITFIELD_DECL(uint32_t, IDR1_SIDSIZE, 5, 0)
 
 
+#define SMMU_IDR3_OFFSET 0xc
+#define IDR3_RIL (1 << 10)
+
 #define SMMU_IDR5_OFFSET 0x14
 BITFIELD_DECL(uint32_t, IDR5_OAS, 2, 0)
 #define SMMU_OAS_MAX_IDX 7
@@ -82,6 +85,13 @@ BITFIELD_DECL(uint32_t, CR1_QUEUE_IC, 1, 0)
 #define SMMU_GERROR_EVTQ_ABT_ERR     (1 << 2)
 #define SMMU_GERROR_MSI_EVTQ_ABT_ERR (1 << 5)
 
+#define SMMU_IRQ_CTRL_OFFSET         0x50
+#define SMMU_IRQ_CTRLACK_OFFSET      0x54
+#define IRQ_CTRL_GERROR_IRQEN        (1 << 0)
+#define IRQ_CTRL_EVTQ_IRQEN          (1 << 2)
+#define SMMU_GERROR_IRQ_CFG0_OFFSET  0x68
+#define SMMU_EVTQ_IRQ_CFG0_OFFSET    0xb0
+
 #define SMMU_STRTAB_BASE_OFFSET 0x80
 #define STRTAB_BASE_RA (1UL << 62)
 BITFIELD_DECL(uint64_t, STRTAB_BASE_ADDR, 51, 6)
@@ -103,6 +113,11 @@ BITFIELD_DECL(uint32_t, STRTAB_BASE_CFG_LOG2SIZE, 5, 0)
 #define SMMU_EVNTQ_CONS_OFFSET 0xac
 
 BITFIELD_DECL(uint32_t, EVTQ_0_ID, 7, 0)
+BITFIELD_DECL(uint64_t, EVTQ_0_SSID, 31, 12)
+BITFIELD_DECL(uint64_t, EVTQ_0_SID, 63, 32)
+#define EVTQ_0_SSV  (1ULL << 11)
+#define EVTQ_1_RNW  (1ULL << 35)
+#define EVTQ_1_S2   (1ULL << 39)
 BITFIELD_DECL(uint64_t, MSI_MASK, 51, 2)
 
 #define EVT_ID_UUT               0x01
@@ -197,6 +212,31 @@ BITFIELD_DECL(uint64_t, STRTAB_STE_3_S2TTB, 51, 4)
 BITFIELD_DECL(uint64_t, CMDQ_0_OP, 7, 0)
 BITFIELD_DECL(uint64_t, CMDQ_CFGI_1_RANGE, 4, 0)
 #define CMDQ_CFGI_1_ALL_STES 31
+BITFIELD_DECL(uint64_t, CMDQ_0_SSID, 31, 12)
+BITFIELD_DECL(uint64_t, CMDQ_0_SID, 63, 32)
+#define CMDQ_CFGI_1_LEAF (1ULL << 0)
+
+BITFIELD_DECL(uint64_t, CMDQ_TLBI_0_NUM, 16, 12)
+BITFIELD_DECL(uint64_t, CMDQ_TLBI_0_SCALE, 24, 20)
+BITFIELD_DECL(uint64_t, CMDQ_TLBI_0_VMID, 47, 32)
+BITFIELD_DECL(uint64_t, CMDQ_TLBI_0_ASID, 63, 48)
+BITFIELD_DECL(uint64_t, CMDQ_TLBI_1_TG, 11, 10)
+#define CMDQ_TLBI_1_VA_MASK  0xFFFFFFFFFFFFF000ULL
+#define CMDQ_TLBI_1_IPA_MASK 0x000FFFFFFFFFF000ULL
+#define CMDQ_TLBI_RANGE_NUM_MAX 31
+#define CMDQ_TLBI_RANGE_SCALE_MAX 31
+
+/* Pages invalidated one by one before falling back to a per ASID/VMID TLBI */
+#define SMMU_TLBI_PAGE_MAX 64
+
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_CS, 13, 12)
+#define CMDQ_SYNC_0_CS_NONE 0
+#define CMDQ_SYNC_0_CS_IRQ  1
+#define CMDQ_SYNC_0_CS_SEV  2
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSH, 23, 22)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSIATTR, 27, 24)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSIDATA, 63, 32)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_1_MSIADDR, 51, 2)
 
 #define SMMU_CMDQ_POLL_TIMEOUT 0x100000
 
@@ -23,7 +23,9 @@ uint32_t    g_smmu_index;
 uint64_t    g_page1_base;
 extern uint32_t g_num_smmus;
 
-struct smmu_master_node *g_smmu_master_list_head = NULL;
+smmu_master_table_t g_smmu_master_table;
+uint32_t    g_smmu_irq_index = ACS_INVALID_INDEX;
+smmu_cdtab_pool_t g_smmu_cdtab_pool;
 
 static uint64_t align_to_size(uint64_t addr,  uint64_t size)
 {
@@ -40,14 +42,6 @@ static uint32_t smmu_inc_cons(smmu_queue_t *q)
     return (q->cons + 1) & ((0x1ul << (q->log2nent + 1)) - 1);
 }
 
-static uint32_t smmu_queue_full(smmu_queue_t *q)
-{
-    uint32_t index_mask = ((0x1ul << q->log2nent) - 1);
-    uint32_t wrap_mask = (0x1ul << q->log2nent);
-    return ((q->prod & index_mask) == (q->cons & index_mask)) &&
-           ((q->prod & wrap_mask) != (q->cons & wrap_mask));
-}
-
 static uint32_t smmu_queue_empty(smmu_queue_t *q)
 {
     uint32_t index_mask = ((0x1ul << q->log2nent) - 1);
@@ -65,6 +59,12 @@ static int smmu_cmdq_build_cmd(uint64_t *cmd, uint8_t opcode)
     case CMDQ_OP_TLBI_EL2_ALL:
     case CMDQ_OP_TLBI_NSNH_ALL:
     case CMDQ_OP_CMD_SYNC:
+    case CMDQ_OP_CFGI_STE:
+    case CMDQ_OP_CFGI_CD:
+    case CMDQ_OP_TLBI_NH_ASID:
+    case CMDQ_OP_TLBI_NH_VA:
+    case CMDQ_OP_TLBI_S12_VMALL:
+    case CMDQ_OP_TLBI_S2_IPA:
         break;
     case CMDQ_OP_CFGI_ALL:
         cmd[1] |= BITFIELD_SET(CMDQ_CFGI_1_RANGE, CMDQ_CFGI_1_ALL_STES);
@@ -77,19 +77,39 @@ static int smmu_cmdq_build_cmd(uint64_t *cmd, uint8_t opcode)
     return 0;
 }
 
-static int smmu_cmdq_write_cmd(smmu_dev_t *smmu, uint64_t *cmd)
+static uint32_t smmu_cmdq_space(smmu_queue_t *q)
+{
+    uint32_t mask = ((0x1ul << (q->log2nent + 1)) - 1);
+    return (0x1ul << q->log2nent) - ((q->prod - q->cons) & mask);
+}
+
+static void smmu_cmdq_build_sync(smmu_dev_t *smmu, uint64_t *cmd)
+{
+    smmu_cmd_queue_t *cmdq = &smmu->cmdq;
+
+    smmu_cmdq_build_cmd(cmd, CMDQ_OP_CMD_SYNC);
+    if (!cmdq->sync_ptr)
+        return;
+
+    /* Signal completion by an MSI write of the sequence number to memory */
+    cmdq->sync_seq++;
+    cmd[0] |= BITFIELD_SET(CMDQ_SYNC_0_CS, CMDQ_SYNC_0_CS_IRQ) |
+              BITFIELD_SET(CMDQ_SYNC_0_MSH, SMMU_SH_ISH) |
+              BITFIELD_SET(CMDQ_SYNC_0_MSIATTR, SMMU_MEMATTR_OIWB) |
+              BITFIELD_SET(CMDQ_SYNC_0_MSIDATA, (uint64_t)cmdq->sync_seq);
+    cmd[1] |= cmdq->sync_phys & (CMDQ_SYNC_1_MSIADDR_MASK << CMDQ_SYNC_1_MSIADDR_SHIFT);
+}
+
+static int smmu_cmdq_write_cmds(smmu_dev_t *smmu, uint64_t *cmds, uint32_t num)
 {
     uint32_t timeout = SMMU_CMDQ_POLL_TIMEOUT;
-    int ret = 0, i;
+    uint32_t index_mask, i, j;
     uint64_t *cmd_dst;
     smmu_cmd_queue_t *cmdq = &smmu->cmdq;
-    smmu_queue_t
-        queue =
-            {
-                .log2nent = cmdq->queue.log2nent,
-            };
 
-    while (smmu_queue_full(&cmdq->queue) && timeout) {
+    /* PROD is owned by software, CONS is only read when the cached view is full */
+    while ((smmu_cmdq_space(&cmdq->queue) < num) && timeout) {
+        cmdq->queue.cons = val_mmio_read((uint64_t)cmdq->cons_reg);
         timeout--;
     }
 
@@ -98,30 +118,20 @@ static int smmu_cmdq_write_cmd(smmu_dev_t *smmu, uint64_t *cmd)
         return -1;
     }
 
-    queue.prod = val_mmio_read((uint64_t)cmdq->prod_reg);
-    cmd_dst = (uint64_t *)(cmdq->base + ((queue.prod & ((0x1ull << queue.log2nent) - 1)) * (cmdq->entry_size)));
-    for (i = 0; i < CMDQ_DWORDS_PER_ENT; ++i)
-        cmd_dst[i] = cmd[i];
-    queue.prod = smmu_inc_prod(&queue);
+    index_mask = ((0x1ul << cmdq->queue.log2nent) - 1);
+    for (i = 0; i < num; i++) {
+        cmd_dst = (uint64_t *)(cmdq->base + ((cmdq->queue.prod & index_mask) * (cmdq->entry_size)));
+        for (j = 0; j < CMDQ_DWORDS_PER_ENT; ++j)
+            cmd_dst[j] = cmds[i * CMDQ_DWORDS_PER_ENT + j];
+        cmdq->queue.prod = smmu_inc_prod(&cmdq->queue);
+    }
 
 #ifndef TARGET_LINUX
     ArmExecuteMemoryBarrier();
 #endif
-    val_mmio_write((uint64_t)cmdq->prod_reg, queue.prod);
-
-    return ret;
-}
+    val_mmio_write((uint64_t)cmdq->prod_reg, cmdq->queue.prod);
 
-static int smmu_cmdq_issue_cmd(smmu_dev_t *smmu,
-                   uint8_t opcode)
-{
-    uint64_t cmd[CMDQ_DWORDS_PER_ENT];
-
-    if (smmu_cmdq_build_cmd(cmd, opcode)) {
-        return -1;
-    }
-
-    return smmu_cmdq_write_cmd(smmu, cmd);
+    return 0;
 }
 
 static void smmu_cmdq_poll_until_consumed(smmu_dev_t *smmu)
@@ -130,7 +140,7 @@ static void smmu_cmdq_poll_until_consumed(smmu_dev_t *smmu)
     smmu_cmd_queue_t *cmdq = &smmu->cmdq;
     smmu_queue_t queue = {
                 .log2nent = smmu->cmdq.queue.log2nent,
-                .prod = val_mmio_read((uint64_t)smmu->cmdq.prod_reg),
+                .prod = smmu->cmdq.queue.prod,
                 .cons = val_mmio_read((uint64_t)smmu->cmdq.cons_reg)
             };
 
@@ -141,6 +151,8 @@ static void smmu_cmdq_poll_until_consumed(smmu_dev_t *smmu)
         timeout--;
     }
 
+    cmdq->queue.cons = queue.cons;
+
     if (!timeout) {
         val_print(ACS_PRINT_ERR, "\n       CMDQ poll timeout at 0x%08x", queue.prod);
         val_print(ACS_PRINT_ERR, "\n       prod_reg = 0x%08x,",
@@ -152,6 +164,90 @@ val_mmio_read(smmu->base + SMMU_GERROR_OFFSET));
     }
 }
 
+static int smmu_cmdq_wait_sync(smmu_dev_t *smmu)
+{
+    uint32_t timeout = SMMU_CMDQ_POLL_TIMEOUT;
+    smmu_cmd_queue_t *cmdq = &smmu->cmdq;
+    volatile uint32_t *sync_word = (volatile uint32_t *)cmdq->sync_ptr;
+
+    if (!sync_word) {
+        smmu_cmdq_poll_until_consumed(smmu);
+        return 0;
+    }
+
+    /* Poll the MSI target in memory instead of the CONS register */
+    while (timeout > 0) {
+        if (*sync_word == cmdq->sync_seq)
+            break;
+        timeout--;
+    }
+
+    if (!timeout) {
+        val_print(ACS_PRINT_ERR, "\n       CMD_SYNC timeout, seq 0x%08x", cmdq->sync_seq);
+        val_print(ACS_PRINT_ERR, "\n       gerror   = 0x%08x     ",
+val_mmio_read(smmu->base + SMMU_GERROR_OFFSET));
+        return -1;
+    }
+
+    /* Everything ahead of the CMD_SYNC has been consumed */
+    cmdq->queue.cons = cmdq->queue.prod;
+    return 0;
+}
+
+static uint32_t smmu_cmdq_batch_cap(smmu_dev_t *smmu)
+{
+    uint32_t nent = (0x1ul << smmu->cmdq.queue.log2nent);
+    return (nent < SMMU_CMDQ_BATCH_MAX) ? nent : SMMU_CMDQ_BATCH_MAX;
+}
+
+static int smmu_cmdq_batch_add_cmd(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch, uint64_t *cmd)
+{
+    uint32_t i;
+
+    if (batch->num == smmu_cmdq_batch_cap(smmu)) {
+        if (smmu_cmdq_write_cmds(smmu, batch->cmds, batch->num))
+            return -1;
+        batch->num = 0;
+    }
+
+    for (i = 0; i < CMDQ_DWORDS_PER_ENT; i++)
+        batch->cmds[batch->num * CMDQ_DWORDS_PER_ENT + i] = cmd[i];
+
+    batch->num++;
+    return 0;
+}
+
+static int smmu_cmdq_batch_add(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch, uint8_t opcode)
+{
+    uint64_t cmd[CMDQ_DWORDS_PER_ENT];
+
+    if (smmu_cmdq_build_cmd(cmd, opcode))
+        return -1;
+
+    return smmu_cmdq_batch_add_cmd(smmu, batch, cmd);
+}
+
+static int smmu_cmdq_batch_submit(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch)
+{
+    int ret;
+
+    if (batch->num == smmu_cmdq_batch_cap(smmu)) {
+        if (smmu_cmdq_write_cmds(smmu, batch->cmds, batch->num))
+            return -1;
+        batch->num = 0;
+    }
+
+    smmu_cmdq_build_sync(smmu, &batch->cmds[batch->num * CMDQ_DWORDS_PER_ENT]);
+    batch->num++;
+
+    ret = smmu_cmdq_write_cmds(smmu, batch->cmds, batch->num);
+    batch->num = 0;
+    if (ret)
+        return -1;
+
+    return smmu_cmdq_wait_sync(smmu);
+}
+
 static void smmu_strtab_write_ste(smmu_master_t *master, uint64_t *ste)
 {
     uint64_t val = STRTAB_STE_0_V;
@@ -227,6 +323,7 @@ static uint32_t smmu_strtab_init_linear(smmu_dev_t *smmu)
 
     cfg->strtab_phys = align_to_size((uint64_t)val_memory_virt_to_phys(cfg->strtab_ptr), size);
     cfg->strtab64 = (uint64_t*)align_to_size((uint64_t)cfg->strtab_ptr, size);
+    cfg->mem_size = 2 * (uint64_t)size;
     cfg->l1_ent_count = 1 << smmu->sid_bits;
     cfg->strtab_base_cfg = BITFIELD_SET(STRTAB_BASE_CFG_FMT, STRTAB_BASE_CFG_FMT_LINEAR) |
                            BITFIELD_SET(STRTAB_BASE_CFG_LOG2SIZE, smmu->sid_bits);
@@ -260,6 +357,16 @@ static uint32_t smmu_cmd_queue_init(smmu_dev_t *smmu)
                        BITFIELD_SET(QUEUE_BASE_LOG2SIZE, cmdq->queue.log2nent);
 
     cmdq->queue.prod = cmdq->queue.cons = 0;
+
+    /* A non-coherent MSI write would share a cache line with other data, poll CONS instead */
+    if (smmu->supported.msi && smmu->supported.cohacc) {
+        cmdq->sync_ptr = val_memory_calloc(1, sizeof(uint64_t));
+        if (cmdq->sync_ptr) {
+            cmdq->sync_phys = (uint64_t)val_memory_virt_to_phys(cmdq->sync_ptr);
+            cmdq->sync_seq = 0;
+        }
+    }
+
     return 1;
 }
 
@@ -268,7 +375,7 @@ static uint32_t smmu_evnt_queue_init(smmu_dev_t *smmu)
     smmu_evnt_queue_t *evntq = &smmu->evntq;
     uint64_t evntq_size = ((1 << evntq->queue.log2nent) * EVNTQ_DWORDS_PER_ENT) << 3;
     evntq_size = (evntq_size < 64)?64:evntq_size;
-    evntq->base_ptr = val_memory_calloc (1, evntq_size);
+    evntq->base_ptr = val_memory_calloc (2, evntq_size);
     if (!evntq->base_ptr) {
         val_print(ACS_PRINT_ERR, "\n      Failed to allocate Event queue struct.     ", 0);
         return 0;
@@ -293,7 +400,7 @@ static uint32_t smmu_evnt_queue_init(smmu_dev_t *smmu)
 
 static void smmu_free_strtab(smmu_dev_t *smmu)
 {
-    uint32_t i;
+    struct smmu_strtab_l2_chunk *chunk, *next;
 
     smmu_strtab_config_t *cfg = &smmu->strtab_cfg;
     if (cfg->strtab_ptr == NULL)
@@ -301,16 +408,57 @@ static void smmu_free_strtab(smmu_dev_t *smmu)
     if (smmu->supported.st_level_2lvl &&
         cfg->l1_desc != NULL)
     {
-        for (i = 0; i < cfg->l1_ent_count; ++i)
+        for (chunk = cfg->l2_pool; chunk != NULL; chunk = next)
         {
-            if (cfg->l1_desc[i].l2ptr != NULL)
-                val_memory_free(cfg->l1_desc[i].l2ptr);
+            next = chunk->next;
+            val_memory_free(chunk->ptr);
+            val_memory_free(chunk);
         }
 
         val_memory_free(cfg->l1_desc);
     }
 
     val_memory_free(cfg->strtab_ptr);
+    val_memory_set(cfg, sizeof(smmu_strtab_config_t), 0);
+}
+
+static uint64_t *smmu_strtab_alloc_l2_span(smmu_strtab_config_t *cfg, uint64_t *phys)
+{
+    struct smmu_strtab_l2_chunk *chunk = cfg->l2_pool;
+    uint32_t span_size = (1 << STRTAB_SPLIT) * STRTAB_STE_DWORDS * BYTES_PER_DWORD;
+    uint32_t num_spans;
+    uint64_t offset;
+
+    if ((chunk == NULL) || (chunk->used == chunk->num_spans)) {
+        num_spans = (chunk == NULL) ? 1 : chunk->num_spans * 2;
+        if (num_spans > STRTAB_L2_POOL_SPANS)
+            num_spans = STRTAB_L2_POOL_SPANS;
+
+        chunk = val_memory_calloc(1, sizeof(struct smmu_strtab_l2_chunk));
+        if (!chunk)
+            return NULL;
+
+        /* One extra span aligns the chunk to the span size */
+        chunk->ptr = val_memory_calloc(num_spans + 1, span_size);
+        if (!chunk->ptr) {
+            val_memory_free(chunk);
+            return NULL;
+        }
+
+        chunk->base_phys = align_to_size((uint64_t)val_memory_virt_to_phys(chunk->ptr), span_size);
+        chunk->base = (uint8_t *)align_to_size((uint64_t)chunk->ptr, span_size);
+        chunk->num_spans = num_spans;
+        chunk->next = cfg->l2_pool;
+        cfg->l2_pool = chunk;
+        cfg->mem_size += (uint64_t)(num_spans + 1) * span_size;
+    }
+
+    offset = (uint64_t)chunk->used * span_size;
+    chunk->used++;
+    cfg->l2_span_count++;
+
+    *phys = chunk->base_phys + offset;
+    return (uint64_t *)(chunk->base + offset);
 }
 
 /* Stream table manipulation functions */
@@ -326,29 +474,25 @@ smmu_strtab_write_level1_desc(uint64_t *dst, smmu_strtab_l1_desc_t *desc)
 
 static int smmu_strtab_init_level2(smmu_dev_t *smmu, uint32_t sid)
 {
-    uint64_t size, *ste;
+    uint64_t *ste;
     void *strtab;
     int i;
     smmu_strtab_config_t *cfg = &smmu->strtab_cfg;
     smmu_strtab_l1_desc_t *desc = &cfg->l1_desc[sid >> STRTAB_SPLIT];
 
-    if (desc->l2ptr)
+    if (desc->l2desc64)
         return 1;
 
-    size = (1 << STRTAB_SPLIT) * STRTAB_STE_DWORDS * BYTES_PER_DWORD;
     strtab = &cfg->strtab64[(sid >> STRTAB_SPLIT) * STRTAB_L1_DESC_DWORDS];
 
     desc->span = STRTAB_SPLIT + 1;
-    desc->l2ptr = val_memory_calloc(2, size);
-    if (!desc->l2ptr) {
+    desc->l2desc64 = smmu_strtab_alloc_l2_span(cfg, &desc->l2desc_phys);
+    if (!desc->l2desc64) {
         val_print(ACS_PRINT_ERR, "\n       failed to allocate l2 stream table for SID %u     ",
 sid);
         return 0;
     }
 
-    desc->l2desc_phys = align_to_size((uint64_t)val_memory_virt_to_phys(desc->l2ptr), size);
-    desc->l2desc64 = (uint64_t*)align_to_size((uint64_t)desc->l2ptr, size);
-
     for (ste = desc->l2desc64, i = 0; i < (1 << STRTAB_SPLIT); ++i, ste += STRTAB_STE_DWORDS)
         smmu_strtab_write_ste(NULL, ste);
     smmu_strtab_write_level1_desc(strtab, desc);
@@ -380,7 +524,8 @@ static int smmu_strtab_init_2level(smmu_dev_t *smmu)
     log2size += STRTAB_SPLIT;
 
     l1_tbl_size = cfg->l1_ent_count * STRTAB_L1_DESC_SIZE;
-    cfg->strtab_ptr = val_memory_alloc(2 * l1_tbl_size);
+    /* Zeroed L1 descriptors are invalid until their span is populated */
+    cfg->strtab_ptr = val_memory_calloc(2, l1_tbl_size);
     if (!cfg->strtab_ptr) {
         val_print(ACS_PRINT_ERR, "\n       failed to allocate l1 stream table     ", 0);
         return 0;
@@ -398,6 +543,7 @@ static int smmu_strtab_init_2level(smmu_dev_t *smmu)
         return 0;
     }
 
+    cfg->mem_size = 2 * (uint64_t)l1_tbl_size + cfg->l1_ent_count * sizeof(*cfg->l1_desc);
     return 1;
 }
 
@@ -421,6 +567,8 @@ static uint32_t smmu_strtab_init(smmu_dev_t *smmu)
     data |= STRTAB_BASE_RA;
     smmu->strtab_cfg.strtab_base = data;
 
+    val_print(ACS_PRINT_INFO, "  stream table memory 0x%llx bytes\n", smmu->strtab_cfg.mem_size);
+
     return 1;
 }
 
@@ -442,17 +590,78 @@ static int smmu_reg_write_sync(smmu_dev_t *smmu, uint32_t val,
     return 1;
 }
 
-static smmu_master_t *smmu_master_at(uint32_t sid)
+static uint32_t smmu_master_hash(uint32_t smmu_index, uint32_t sid, uint32_t log2size)
+{
+    uint64_t key = ((uint64_t)smmu_index << 32) | sid;
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> (64 - log2size));
+}
+
+static int smmu_master_table_resize(uint32_t log2size)
+{
+    smmu_master_table_t *tbl = &g_smmu_master_table;
+    struct smmu_master_node **bucket;
+    struct smmu_master_node *node, *next;
+    uint32_t i, idx;
+
+    bucket = val_memory_calloc(0x1ul << log2size, sizeof(struct smmu_master_node *));
+    if (bucket == NULL)
+        return -1;
+
+    if (tbl->bucket != NULL) {
+        for (i = 0; i < (0x1ul << tbl->log2size); i++) {
+            for (node = tbl->bucket[i]; node != NULL; node = next) {
+                next = node->next;
+                idx = smmu_master_hash(node->smmu_index, node->sid, log2size);
+                node->next = bucket[idx];
+                bucket[idx] = node;
+            }
+        }
+        val_memory_free(tbl->bucket);
+    }
+
+    tbl->bucket = bucket;
+    tbl->log2size = log2size;
+    return 0;
+}
+
+static smmu_master_t *smmu_master_find(uint32_t smmu_index, uint32_t sid)
 {
-    struct smmu_master_node *node = g_smmu_master_list_head;
+    smmu_master_table_t *tbl = &g_smmu_master_table;
+    struct smmu_master_node *node;
+
+    if (tbl->bucket == NULL)
+        return NULL;
 
+    node = tbl->bucket[smmu_master_hash(smmu_index, sid, tbl->log2size)];
     while (node != NULL)
     {
-        if (node->master->sid == sid)
+        if ((node->smmu_index == smmu_index) && (node->sid == sid))
             return node->master;
         node = node->next;
     }
 
+    return NULL;
+}
+
+static smmu_master_t *smmu_master_at(uint32_t smmu_index, uint32_t sid)
+{
+    smmu_master_table_t *tbl = &g_smmu_master_table;
+    struct smmu_master_node *node;
+    smmu_master_t *master;
+    uint32_t idx;
+
+    master = smmu_master_find(smmu_index, sid);
+    if (master != NULL)
+        return master;
+
+    if (tbl->bucket == NULL) {
+        if (smmu_master_table_resize(SMMU_MASTER_HASH_MIN_LOG2))
+            return NULL;
+    } else if (tbl->count >= (0x1ul << tbl->log2size) && tbl->log2size < 31) {
+        /* Keep the load factor at or below one, lookups work on the old table on failure */
+        smmu_master_table_resize(tbl->log2size + 1);
+    }
+
     node = val_memory_alloc(sizeof(struct smmu_master_node));
     if (node == NULL)
         return NULL;
@@ -464,16 +673,64 @@ static smmu_master_t *smmu_master_at(uint32_t sid)
         return NULL;
     }
 
-    node->next = g_smmu_master_list_head;
-    g_smmu_master_list_head = node;
+    node->smmu_index = smmu_index;
+    node->sid = sid;
+    idx = smmu_master_hash(smmu_index, sid, tbl->log2size);
+    node->next = tbl->bucket[idx];
+    tbl->bucket[idx] = node;
+    tbl->count++;
 
     return node->master;
 }
 
+static void smmu_master_remove(uint32_t smmu_index, uint32_t sid)
+{
+    smmu_master_table_t *tbl = &g_smmu_master_table;
+    struct smmu_master_node **link;
+    struct smmu_master_node *node;
+
+    if (tbl->bucket == NULL)
+        return;
+
+    link = &tbl->bucket[smmu_master_hash(smmu_index, sid, tbl->log2size)];
+    while ((node = *link) != NULL)
+    {
+        if ((node->smmu_index == smmu_index) && (node->sid == sid)) {
+            *link = node->next;
+            val_memory_free(node->master);
+            val_memory_free(node);
+            tbl->count--;
+            return;
+        }
+        link = &node->next;
+    }
+}
+
+static void smmu_master_table_free(void)
+{
+    smmu_master_table_t *tbl = &g_smmu_master_table;
+    struct smmu_master_node *node, *next;
+    uint32_t i;
+
+    if (tbl->bucket == NULL)
+        return;
+
+    for (i = 0; i < (0x1ul << tbl->log2size); i++) {
+        for (node = tbl->bucket[i]; node != NULL; node = next) {
+            next = node->next;
+            val_memory_free(node->master);
+            val_memory_free(node);
+        }
+    }
+
+    val_memory_free(tbl->bucket);
+    val_memory_set(tbl, sizeof(smmu_master_table_t), 0);
+}
+
 // Event handler. Gives the info of the kind of event error generated.
-static int smmu_handle_evt(uint64_t *event)
+static int smmu_handle_evt(uint32_t id)
 {
-        switch (BITFIELD_GET(EVTQ_0_ID, event[0])) {
+        switch (id) {
         case EVT_ID_UUT:
                 val_print(ACS_PRINT_TEST, "\n\n    Unsupported Upstream Transaction     ", 0);
                 break;
@@ -553,19 +810,6 @@ static void smmu_queue_read(smmu_evnt_queue_t *evntq, uint64_t *event)
 }
 
 
-static int smmu_queue_remove_raw(smmu_evnt_queue_t *evntq, uint64_t *event)
-{
-    if (smmu_queue_empty(&evntq->queue))
-    {
-        return 1;
-    }
-
-    smmu_queue_read(evntq, event);
-    evntq->queue.cons = smmu_inc_cons(&evntq->queue);
-    val_mmio_write((uint64_t)evntq->cons_reg, evntq->queue.cons);
-    return 0;
-}
-
 static int queue_sync_prod_in(smmu_evnt_queue_t *evntq)
 {
     uint32_t prod;
@@ -577,12 +821,181 @@ static int queue_sync_prod_in(smmu_evnt_queue_t *evntq)
     return ret;
 }
 
+static void smmu_evt_decode(uint64_t *raw, smmu_event_t *evt)
+{
+    evt->id = BITFIELD_GET(EVTQ_0_ID, raw[0]);
+    evt->sid = BITFIELD_GET(EVTQ_0_SID, raw[0]);
+    evt->ssid = BITFIELD_GET(EVTQ_0_SSID, raw[0]);
+    evt->flags = 0;
+    if (raw[0] & EVTQ_0_SSV)
+        evt->flags |= SMMU_EVT_FLAG_SSV;
+    if (raw[1] & EVTQ_1_RNW)
+        evt->flags |= SMMU_EVT_FLAG_RNW;
+    if (raw[1] & EVTQ_1_S2)
+        evt->flags |= SMMU_EVT_FLAG_S2;
+    evt->addr = raw[2];
+}
+
+static void smmu_evt_account(smmu_evt_stats_t *stats, smmu_event_t *evt)
+{
+    uint32_t i;
+
+    stats->total++;
+    if (evt->id < SMMU_EVT_ID_MAX)
+        stats->type_cnt[evt->id]++;
+
+    for (i = 0; i < stats->num_pairs; i++) {
+        if ((stats->pair[i].sid == evt->sid) && (stats->pair[i].id == evt->id)) {
+            stats->pair[i].count++;
+            return;
+        }
+    }
+
+    if (stats->num_pairs == SMMU_EVT_PAIR_MAX) {
+        stats->untracked++;
+        return;
+    }
+
+    stats->pair[i].sid = evt->sid;
+    stats->pair[i].id = evt->id;
+    stats->pair[i].count = 1;
+    stats->num_pairs++;
+}
+
+/* Consume every event up to a single PROD snapshot and publish CONS once */
+static uint32_t smmu_evtq_drain(smmu_dev_t *smmu, smmu_event_t *events, uint32_t max_events)
+{
+    smmu_evnt_queue_t *evntq = &smmu->evntq;
+    uint64_t raw[EVNTQ_DWORDS_PER_ENT];
+    smmu_event_t evt;
+    uint32_t num = 0;
+
+    if (queue_sync_prod_in(evntq)) {
+        smmu->evt_stats.overflow++;
+        val_print(ACS_PRINT_WARN, "\n  EVTQ overflow detected -- events lost     ", 0);
+    }
+
+    while (!smmu_queue_empty(&evntq->queue)) {
+        smmu_queue_read(evntq, raw);
+        smmu_evt_decode(raw, &evt);
+        smmu_evt_account(&smmu->evt_stats, &evt);
+        if ((events != NULL) && (num < max_events))
+            events[num] = evt;
+        num++;
+        evntq->queue.cons = smmu_inc_cons(&evntq->queue);
+    }
+
+    if (num == 0 && (SMMU_QUEUE_OVF(evntq->queue.prod) == SMMU_QUEUE_OVF(evntq->queue.cons)))
+        return 0;
+
+    /* Acknowledge any overflow along with the consumed entries */
+    evntq->queue.cons = SMMU_QUEUE_OVF(evntq->queue.prod) |
+                        (evntq->queue.cons & ((0x1ul << (evntq->queue.log2nent + 1)) - 1));
+    val_mmio_write((uint64_t)evntq->cons_reg, evntq->queue.cons);
+
+    return num;
+}
+
+/* Move drained events to the capture ring, the newest are dropped when it is full */
+static uint32_t smmu_evt_capture(smmu_dev_t *smmu)
+{
+    smmu_event_t events[SMMU_EVT_RING_SIZE];
+    uint32_t i, num, total = 0;
+
+    while ((num = smmu_evtq_drain(smmu, events, SMMU_EVT_RING_SIZE)) != 0) {
+        for (i = 0; i < num; i++) {
+            if ((i >= SMMU_EVT_RING_SIZE) ||
+                ((smmu->evt_head - smmu->evt_tail) == SMMU_EVT_RING_SIZE)) {
+                smmu->evt_ring_dropped++;
+                continue;
+            }
+            smmu->evt_ring[smmu->evt_head % SMMU_EVT_RING_SIZE] = events[i];
+            smmu->evt_head++;
+        }
+        total += num;
+    }
+
+    return total;
+}
+
+static void smmu_gerror_capture(smmu_dev_t *smmu)
+{
+    uint32_t gerror, gerrorn;
+
+    gerror = val_mmio_read(smmu->base + SMMU_GERROR_OFFSET);
+    gerrorn = val_mmio_read(smmu->base + SMMU_GERRORN_OFFSET);
+    smmu->gerror_active |= (gerror ^ gerrorn);
+
+    /* Acknowledge all active errors */
+    val_mmio_write(smmu->base + SMMU_GERRORN_OFFSET, gerror);
+}
+
+/* Pop events the handler moved to the capture ring, they are already counted */
+static uint32_t smmu_evt_ring_pop(smmu_dev_t *smmu, smmu_event_t *events, uint32_t max_events)
+{
+    uint32_t num = 0;
+
+    while (smmu->evt_tail != smmu->evt_head) {
+        if ((events != NULL) && (num >= max_events))
+            break;
+        if (events != NULL)
+            events[num] = smmu->evt_ring[smmu->evt_tail % SMMU_EVT_RING_SIZE];
+        smmu->evt_tail++;
+        num++;
+    }
+
+    return num;
+}
+
+/* EVTQ and GERRORN are owned by the handler while its interrupt is armed */
+static uint32_t smmu_evt_read(smmu_dev_t *smmu, smmu_event_t *events, uint32_t max_events)
+{
+    if (smmu->irq_en & IRQ_CTRL_EVTQ_IRQEN)
+        return smmu_evt_ring_pop(smmu, events, max_events);
+
+    return smmu_evtq_drain(smmu, events, max_events);
+}
+
+static void smmu_evtq_isr(void)
+{
+    smmu_dev_t *smmu;
+
+    if (g_smmu_irq_index == ACS_INVALID_INDEX)
+        return;
+
+    smmu = &g_smmu[g_smmu_irq_index];
+    smmu_evt_capture(smmu);
+    if (smmu->gerr_gsiv == smmu->evt_gsiv)
+        smmu_gerror_capture(smmu);
+
+    val_gic_end_of_interrupt(smmu->evt_gsiv);
+}
+
+static void smmu_gerror_isr(void)
+{
+    smmu_dev_t *smmu;
+
+    if (g_smmu_irq_index == ACS_INVALID_INDEX)
+        return;
+
+    smmu = &g_smmu[g_smmu_irq_index];
+    smmu_gerror_capture(smmu);
+    val_gic_end_of_interrupt(smmu->gerr_gsiv);
+}
+
 static uint32_t smmu_gerror_check(smmu_dev_t *smmu)
 {
-    uint32_t gerror, gerrorn, active;
+    uint32_t gerror = 0, gerrorn, active;
+
+    if (smmu->irq_en & IRQ_CTRL_GERROR_IRQEN) {
+        /* The handler has already acknowledged these in GERRORN */
+        active = smmu->gerror_active;
+    } else {
         gerror = val_mmio_read(smmu->base + SMMU_GERROR_OFFSET);
         gerrorn = val_mmio_read(smmu->base + SMMU_GERRORN_OFFSET);
         active = gerror ^ gerrorn;
+    }
+
     if (active & SMMU_GERROR_MSI_EVTQ_ABT_ERR)
     {
         val_print(ACS_PRINT_DEBUG, "\n      EVTQ MSI write aborted     ", 0);
@@ -595,17 +1008,18 @@ static uint32_t smmu_gerror_check(smmu_dev_t *smmu)
         return 1;
     }
 
-    val_mmio_write(smmu->base + SMMU_GERRORN_OFFSET, gerror);
-        return 0;
+    if (!(smmu->irq_en & IRQ_CTRL_GERROR_IRQEN))
+        val_mmio_write(smmu->base + SMMU_GERRORN_OFFSET, gerror);
+
+    return 0;
 }
 
 static void smmu_evtq_thread(void)
 {
-    uint32_t i, ret;
+    uint32_t i, num, ret;
     smmu_dev_t *smmu = &g_smmu[g_smmu_index];
     smmu_evnt_queue_t *evntq = &smmu->evntq;
-    smmu_queue_t *queue = &evntq->queue;
-    uint64_t event[EVNTQ_DWORDS_PER_ENT];
+    smmu_event_t events[SMMU_EVTQ_DUMP_BATCH];
     ret = smmu_gerror_check(smmu);
     if (ret)
     {
@@ -613,32 +1027,29 @@ static void smmu_evtq_thread(void)
         return;
     }
 
-    do {
-        while (!smmu_queue_remove_raw(evntq, event)) {
-            uint8_t id = BITFIELD_GET(EVTQ_0_ID, event[0]);
-            ret = smmu_handle_evt(event);
-            val_print(ACS_PRINT_TEST, "\n  event 0x%02x received: %d     ", id);
-            for (i = 0; i < ARRAY_SIZE(event); ++i)
-            {
-                val_print(ACS_PRINT_TEST, "\n  0x%016llx     ", (unsigned long long)event[i]);
-            }
-
-            val_print(ACS_PRINT_INFO, "\n  prod is: %x", val_mmio_read((uint64_t)evntq->prod_reg));
-            val_print(ACS_PRINT_INFO, "\n  cons is: %x", val_mmio_read((uint64_t)evntq->cons_reg));
+    while ((num = smmu_evt_read(smmu, events, SMMU_EVTQ_DUMP_BATCH)) != 0) {
+        for (i = 0; i < num && i < SMMU_EVTQ_DUMP_BATCH; i++) {
+            smmu_handle_evt(events[i].id);
+            val_print(ACS_PRINT_TEST, "\n  event 0x%02x received", events[i].id);
+            val_print(ACS_PRINT_TEST, " sid 0x%x", events[i].sid);
+            if (events[i].flags & SMMU_EVT_FLAG_SSV)
+                val_print(ACS_PRINT_TEST, " ssid 0x%x", events[i].ssid);
+            val_print(ACS_PRINT_TEST, " addr 0x%llx     ", events[i].addr);
         }
 
-        if (queue_sync_prod_in(evntq))
-            val_print(ACS_PRINT_WARN, "\n  EVTQ overflow detected -- events lost     ", 0);
-    } while (!smmu_queue_empty(&evntq->queue));
+        if (num > SMMU_EVTQ_DUMP_BATCH)
+            val_print(ACS_PRINT_TEST, "\n  %d further events counted, not shown",
+                      num - SMMU_EVTQ_DUMP_BATCH);
+    }
+
+    val_print(ACS_PRINT_INFO, "\n  prod is: %x", val_mmio_read((uint64_t)evntq->prod_reg));
+    val_print(ACS_PRINT_INFO, "\n  cons is: %x", val_mmio_read((uint64_t)evntq->cons_reg));
 
-    if (val_mmio_read((uint64_t)evntq->prod_reg) == val_mmio_read((uint64_t)evntq->cons_reg))
+    if (smmu_queue_empty(&evntq->queue))
     {
         val_print(ACS_PRINT_TEST, "\n  No outstanding events in the queue. Queue Empty.\n", 0);
     }
 
-    evntq->queue.cons = ((queue->prod) & (1 << 31)) |
-                        ((queue->cons) & (1 << queue->log2nent)) |
-                        ((queue->cons) & ((1 << queue->log2nent) - 1));
 return;
 }
 
@@ -655,16 +1066,109 @@ static int smmu_dev_disable(smmu_dev_t *smmu)
 
 static void smmu_tlbi_cfgi(smmu_dev_t *smmu)
 {
+    smmu_cmdq_batch_t batch = { .num = 0 };
+
     /* Invalidate any cached configuration */
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CFGI_ALL);
+    smmu_cmdq_batch_add(smmu, &batch, CMDQ_OP_CFGI_ALL);
     if (smmu->supported.hyp) {
-        smmu_cmdq_issue_cmd(smmu, CMDQ_OP_TLBI_EL2_ALL);
+        smmu_cmdq_batch_add(smmu, &batch, CMDQ_OP_TLBI_EL2_ALL);
+    }
+
+    smmu_cmdq_batch_add(smmu, &batch, CMDQ_OP_TLBI_NSNH_ALL);
+    smmu_cmdq_batch_submit(smmu, &batch);
+}
+
+/* Invalidate all TLB entries of the ASID or VMID of a master */
+static void smmu_master_tlbi_ctx(smmu_master_t *master, smmu_cmdq_batch_t *batch)
+{
+    uint64_t cmd[CMDQ_DWORDS_PER_ENT];
+
+    if (master->stage == SMMU_STAGE_S2) {
+        smmu_cmdq_build_cmd(cmd, CMDQ_OP_TLBI_S12_VMALL);
+        cmd[0] |= BITFIELD_SET(CMDQ_TLBI_0_VMID, (uint64_t)master->stage2_config.vmid);
+    } else {
+        smmu_cmdq_build_cmd(cmd, CMDQ_OP_TLBI_NH_ASID);
+        cmd[0] |= BITFIELD_SET(CMDQ_TLBI_0_ASID, (uint64_t)master->stage1_config.cd.asid);
+    }
+
+    smmu_cmdq_batch_add_cmd(master->smmu, batch, cmd);
+}
+
+/* Invalidate the STE, CD and TLB entries used by a master */
+static void smmu_master_sync(smmu_master_t *master)
+{
+    smmu_cmdq_batch_t batch = { .num = 0 };
+    uint64_t cmd[CMDQ_DWORDS_PER_ENT];
+
+    /* Leaf clear so a new level 1 descriptor is fetched too */
+    smmu_cmdq_build_cmd(cmd, CMDQ_OP_CFGI_STE);
+    cmd[0] |= BITFIELD_SET(CMDQ_0_SID, (uint64_t)master->sid);
+    smmu_cmdq_batch_add_cmd(master->smmu, &batch, cmd);
+
+    if (master->stage == SMMU_STAGE_S1) {
+        smmu_cmdq_build_cmd(cmd, CMDQ_OP_CFGI_CD);
+        cmd[0] |= BITFIELD_SET(CMDQ_0_SID, (uint64_t)master->sid) |
+                  BITFIELD_SET(CMDQ_0_SSID, (uint64_t)master->ssid);
+        smmu_cmdq_batch_add_cmd(master->smmu, &batch, cmd);
+    }
+
+    smmu_master_tlbi_ctx(master, &batch);
+    smmu_cmdq_batch_submit(master->smmu, &batch);
+}
+
+/* Invalidate the TLB entries of a master covering [iova, iova + size) */
+static void smmu_master_tlbi_range(smmu_master_t *master, uint64_t iova, uint64_t size)
+{
+    smmu_dev_t *smmu = master->smmu;
+    smmu_cmdq_batch_t batch = { .num = 0 };
+    uint64_t cmd[CMDQ_DWORDS_PER_ENT];
+    uint32_t shift = master->page_shift;
+    uint64_t addr, pages, num, inv;
+    uint32_t scale;
+
+    addr = iova & ~((0x1ull << shift) - 1);
+    pages = ((iova + size + (0x1ull << shift) - 1) >> shift) - (addr >> shift);
+
+    /* Without range invalidation, large regions are cheaper to drop as a whole.
+       A range command covers at most NUM_MAX << SCALE_MAX pages. */
+    if ((!smmu->supported.ril && (pages > SMMU_TLBI_PAGE_MAX)) ||
+        (pages > ((uint64_t)CMDQ_TLBI_RANGE_NUM_MAX << CMDQ_TLBI_RANGE_SCALE_MAX))) {
+        smmu_master_tlbi_ctx(master, &batch);
+        smmu_cmdq_batch_submit(smmu, &batch);
+        return;
     }
 
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_TLBI_NSNH_ALL);
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CMD_SYNC);
+    while (pages) {
+        if (master->stage == SMMU_STAGE_S2) {
+            smmu_cmdq_build_cmd(cmd, CMDQ_OP_TLBI_S2_IPA);
+            cmd[0] |= BITFIELD_SET(CMDQ_TLBI_0_VMID, (uint64_t)master->stage2_config.vmid);
+            cmd[1] |= addr & CMDQ_TLBI_1_IPA_MASK;
+        } else {
+            smmu_cmdq_build_cmd(cmd, CMDQ_OP_TLBI_NH_VA);
+            cmd[0] |= BITFIELD_SET(CMDQ_TLBI_0_ASID, (uint64_t)master->stage1_config.cd.asid);
+            cmd[1] |= addr & CMDQ_TLBI_1_VA_MASK;
+        }
+
+        inv = 1;
+        if (smmu->supported.ril) {
+            /* Range of (NUM + 1) * 2^SCALE pages, from the lowest set bit of the count */
+            for (scale = 0; !(pages & (0x1ull << scale)); scale++)
+                ;
+            if (scale > CMDQ_TLBI_RANGE_SCALE_MAX)
+                scale = CMDQ_TLBI_RANGE_SCALE_MAX;
+            num = (pages >> scale) & CMDQ_TLBI_RANGE_NUM_MAX;
+            cmd[0] |= BITFIELD_SET(CMDQ_TLBI_0_NUM, (num - 1)) |
+                      BITFIELD_SET(CMDQ_TLBI_0_SCALE, (uint64_t)scale);
+            cmd[1] |= BITFIELD_SET(CMDQ_TLBI_1_TG, (uint64_t)((shift - 10) >> 1));
+            inv = num << scale;
+        }
+
+        smmu_cmdq_batch_add_cmd(smmu, &batch, cmd);
+        addr += inv << shift;
+        pages -= inv;
+    }
 
-    smmu_cmdq_poll_until_consumed(smmu);
+    smmu_cmdq_batch_submit(smmu, &batch);
 }
 
 static int smmu_reset(smmu_dev_t *smmu)
@@ -807,6 +1311,15 @@ static uint32_t smmu_probe(smmu_dev_t *smmu)
     if (data & IDR0_S2P)
         smmu->supported.s2p = 1;
 
+    if (data & IDR0_MSI)
+        smmu->supported.msi = 1;
+
+    if (data & IDR0_COHACC)
+        smmu->supported.cohacc = 1;
+
+    if (val_mmio_read(smmu->base + SMMU_IDR3_OFFSET) & IDR3_RIL)
+        smmu->supported.ril = 1;
+
     if (!(data & (IDR0_S1P | IDR0_S2P))) {
         val_print(ACS_PRINT_ERR, "  no translation support!\n ", 0);
         return 0;
@@ -868,6 +1381,9 @@ static uint64_t *smmu_strtab_get_ste_for_sid(smmu_dev_t *smmu, uint32_t sid)
         return &cfg->strtab64[sid * STRTAB_STE_DWORDS];
 
     l1_desc = &cfg->l1_desc[((sid >> STRTAB_SPLIT) * STRTAB_L1_DESC_DWORDS)];
+    if (l1_desc->l2desc64 == NULL)
+        return NULL;
+
     return &l1_desc->l2desc64[((sid & ((1 << STRTAB_SPLIT) - 1)) * STRTAB_STE_DWORDS)];
 }
 
@@ -900,18 +1416,104 @@ static void smmu_cdtab_write_l1_desc(uint64_t *dst,
     *dst = val;
 }
 
+static uint32_t smmu_cdtab_pool_class(uint64_t size)
+{
+    uint32_t log2size = SMMU_CDTAB_POOL_MIN_LOG2;
+
+    while ((0x1ull << log2size) < size)
+        log2size++;
+
+    return log2size;
+}
+
+static smmu_cdtab_blk_t *smmu_cdtab_pool_get(uint64_t size)
+{
+    smmu_cdtab_pool_t *pool = &g_smmu_cdtab_pool;
+    uint32_t log2size = smmu_cdtab_pool_class(size);
+    smmu_cdtab_blk_t *blk;
+
+    if (log2size >= SMMU_CDTAB_POOL_CLASSES)
+        return NULL;
+
+    blk = pool->free[log2size];
+    if (blk != NULL) {
+        pool->free[log2size] = blk->next;
+        blk->next = NULL;
+        val_memory_set(blk->va, 0x1ul << log2size, 0);
+        return blk;
+    }
+
+    blk = val_memory_calloc(1, sizeof(smmu_cdtab_blk_t));
+    if (blk == NULL)
+        return NULL;
+
+    blk->ptr = val_memory_calloc(2, 0x1ul << log2size);
+    if (blk->ptr == NULL) {
+        val_memory_free(blk);
+        return NULL;
+    }
+
+    blk->phys = align_to_size((uint64_t)val_memory_virt_to_phys(blk->ptr), 0x1ull << log2size);
+    blk->va = (uint64_t *)align_to_size((uint64_t)blk->ptr, 0x1ull << log2size);
+    blk->log2size = log2size;
+    pool->allocs++;
+
+    return blk;
+}
+
+static void smmu_cdtab_pool_put(smmu_cdtab_blk_t *blk)
+{
+    smmu_cdtab_pool_t *pool = &g_smmu_cdtab_pool;
+
+    if (blk == NULL)
+        return;
+
+    blk->next = pool->free[blk->log2size];
+    pool->free[blk->log2size] = blk;
+}
+
+/* Preallocate single CD tables, the layout used by masters without substreams */
+static void smmu_cdtab_pool_init(void)
+{
+    smmu_cdtab_blk_t *blk[SMMU_CDTAB_POOL_PREALLOC];
+    uint32_t i;
+
+    for (i = 0; i < SMMU_CDTAB_POOL_PREALLOC; i++)
+        blk[i] = smmu_cdtab_pool_get(CDTAB_CD_DWORDS << 3);
+
+    for (i = 0; i < SMMU_CDTAB_POOL_PREALLOC; i++)
+        smmu_cdtab_pool_put(blk[i]);
+}
+
+static void smmu_cdtab_pool_free(void)
+{
+    smmu_cdtab_pool_t *pool = &g_smmu_cdtab_pool;
+    smmu_cdtab_blk_t *blk, *next;
+    uint32_t i;
+
+    for (i = 0; i < SMMU_CDTAB_POOL_CLASSES; i++) {
+        for (blk = pool->free[i]; blk != NULL; blk = next) {
+            next = blk->next;
+            val_memory_free(blk->ptr);
+            val_memory_free(blk);
+        }
+    }
+
+    val_memory_set(pool, sizeof(smmu_cdtab_pool_t), 0);
+}
+
 static int smmu_cdtab_alloc_leaf_table(smmu_cdtab_l1_ctx_desc_t *l1_desc)
 {
     uint64_t size = CDTAB_L2_ENTRY_COUNT * (CDTAB_CD_DWORDS << 3);
 
-    l1_desc->l2ptr = val_memory_alloc(size*2);
-    if (!l1_desc->l2ptr) {
+    l1_desc->l2blk = smmu_cdtab_pool_get(size);
+    if (!l1_desc->l2blk) {
         val_print(ACS_PRINT_ERR, "\n       failed to allocate context descriptor table     ", 0);
         return 1;
     }
 
-    l1_desc->l2desc_phys = align_to_size((uint64_t)val_memory_virt_to_phys(l1_desc->l2ptr), size);
-    l1_desc->l2desc64 = (uint64_t*)align_to_size((uint64_t)l1_desc->l2ptr, size);
+    l1_desc->l2desc_phys = l1_desc->l2blk->phys;
+    l1_desc->l2desc64 = l1_desc->l2blk->va;
     return 0;
 }
 
@@ -927,7 +1529,7 @@ static uint64_t *smmu_cdtab_get_ctx_desc(smmu_master_t *master)
 
     idx = master->ssid >> CDTAB_SPLIT;
     l1_desc = &cdcfg->l1_desc[idx];
-    if (!l1_desc->l2ptr) {
+    if (!l1_desc->l2blk) {
         if (smmu_cdtab_alloc_leaf_table(l1_desc))
             return NULL;
 
@@ -988,17 +1590,13 @@ static void smmu_cdtab_free(smmu_master_t *master)
     {
         num_l1_ents = (max_contexts + CDTAB_L2_ENTRY_COUNT - 1)/CDTAB_L2_ENTRY_COUNT;
         for (i = 0; i < num_l1_ents; i++)
-        {
-            if (cdcfg->l1_desc[i].l2ptr != NULL)
-                val_memory_free(cdcfg->l1_desc[i].l2ptr);
+            smmu_cdtab_pool_put(cdcfg->l1_desc[i].l2blk);
 
-        }
-
-        val_memory_free(cdcfg->l1_desc);
+        smmu_cdtab_pool_put(cdcfg->l1_desc_blk);
     }
 
-    val_memory_free(cdcfg->cdtab_ptr);
-    cdcfg->cdtab_ptr = NULL;
+    smmu_cdtab_pool_put(cdcfg->cdtab_blk);
+    val_memory_set(cdcfg, sizeof(smmu_cdtab_config_t), 0);
 }
 
 static int smmu_cdtab_alloc(smmu_master_t *master)
@@ -1015,10 +1613,12 @@ static int smmu_cdtab_alloc(smmu_master_t *master)
         cfg->s1fmt = STRTAB_STE_0_S1FMT_64K_L2;
         cdcfg->l1_ent_count = (cdmax + CDTAB_L2_ENTRY_COUNT - 1)/CDTAB_L2_ENTRY_COUNT;
 
-        cdcfg->l1_desc = val_memory_calloc(cdcfg->l1_ent_count, sizeof(*cdcfg->l1_desc));
-        if (!cdcfg->l1_desc)
+        cdcfg->l1_desc_blk = smmu_cdtab_pool_get(cdcfg->l1_ent_count * sizeof(*cdcfg->l1_desc));
+        if (!cdcfg->l1_desc_blk)
             return 0;
 
+        cdcfg->l1_desc = (smmu_cdtab_l1_ctx_desc_t *)cdcfg->l1_desc_blk->va;
+
         l1_tbl_size = cdcfg->l1_ent_count * (CDTAB_L1_DESC_DWORDS << 3);
     } else {
         cfg->s1fmt = STRTAB_STE_0_S1FMT_LINEAR;
@@ -1026,14 +1626,16 @@ static int smmu_cdtab_alloc(smmu_master_t *master)
         l1_tbl_size = cdmax * (CDTAB_CD_DWORDS << 3);
     }
 
-    cdcfg->cdtab_ptr = val_memory_calloc(2, l1_tbl_size);
-    if (!cdcfg->cdtab_ptr) {
+    cdcfg->cdtab_blk = smmu_cdtab_pool_get(l1_tbl_size);
+    if (!cdcfg->cdtab_blk) {
         val_print(ACS_PRINT_ERR, "\n       smmu_cdtab_alloc: alloc failed     ", 0);
+        smmu_cdtab_pool_put(cdcfg->l1_desc_blk);
+        cdcfg->l1_desc_blk = NULL;
         return 0;
     }
 
-    cdcfg->cdtab_phys = align_to_size((uint64_t)val_memory_virt_to_phys(cdcfg->cdtab_ptr), l1_tbl_size);
-    cdcfg->cdtab64 = (uint64_t*)align_to_size((uint64_t)cdcfg->cdtab_ptr, l1_tbl_size);
+    cdcfg->cdtab_phys = cdcfg->cdtab_blk->phys;
+    cdcfg->cdtab64 = cdcfg->cdtab_blk->va;
 
     return 1;
 }
@@ -1072,7 +1674,7 @@ uint64_t val_smmu_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt
         return 1;
     }
 
-    if ((master = smmu_master_at(master_attr.streamid)) == NULL)
+    if ((master = smmu_master_at(master_attr.smmu_index, master_attr.streamid)) == NULL)
         return 1;
 
     if (master->smmu == NULL)
@@ -1082,6 +1684,8 @@ uint64_t val_smmu_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt
         master->ssid_bits = master_attr.ssid_bits;
     }
 
+    master->page_shift = pgt_desc.tcr.tg_size_log2;
+
     /* TODO: Support for stage 1 and stage 2 translations in one stream table entry(STE)
      * This implementation only supports either stage 1 or stage 2 in one STE
      */
@@ -1132,7 +1736,7 @@ uint64_t val_smmu_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt
         smmu_stage1_config_t *cfg = &master->stage1_config;
 
         cfg->s1cdmax = master->ssid_bits;
-        if (cfg->cdcfg.cdtab_ptr == NULL) {
+        if (cfg->cdcfg.cdtab_blk == NULL) {
             if (!smmu_cdtab_alloc(master))
                 return 1;
         }
@@ -1157,7 +1761,7 @@ uint64_t val_smmu_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt
     smmu_strtab_write_ste(master, ste);
     dump_strtab(ste);
 
-    smmu_tlbi_cfgi(smmu);
+    smmu_master_sync(master);
 
     return 0;
 }
@@ -1170,7 +1774,10 @@ uint32_t val_smmu_config_ste_dcp(smmu_master_attributes_t master_attr, uint32_t
     uint64_t *ste;
     uint32_t dcp_value;
 
-    master = smmu_master_at(master_attr.streamid);
+    if (master_attr.smmu_index >= g_num_smmus)
+        return ACS_INVALID_INDEX;
+
+    master = smmu_master_find(master_attr.smmu_index, master_attr.streamid);
     if (master == NULL)
         return ACS_INVALID_INDEX;
 
@@ -1202,7 +1809,7 @@ void val_smmu_unmap(smmu_master_attributes_t master_attr)
     smmu_master_t *master;
     uint64_t *strtab;
 
-    if ((master = smmu_master_at(master_attr.streamid)) == NULL)
+    if ((master = smmu_master_find(master_attr.smmu_index, master_attr.streamid)) == NULL)
         return;
 
     if (master->smmu == NULL)
@@ -1211,12 +1818,13 @@ void val_smmu_unmap(smmu_master_attributes_t master_attr)
     if (master_attr.streamid >= (0x1ul << master->smmu->sid_bits))
         return;
 
-    strtab = master->smmu->strtab_cfg.strtab64 + master_attr.streamid * STRTAB_STE_DWORDS;
-    smmu_strtab_write_ste(NULL, strtab);
+    strtab = smmu_strtab_get_ste_for_sid(master->smmu, master_attr.streamid);
+    if (strtab != NULL)
+        smmu_strtab_write_ste(NULL, strtab);
 
+    smmu_master_sync(master);
     smmu_cdtab_free(master);
-    smmu_tlbi_cfgi(master->smmu);
-    val_memory_set(master, sizeof(smmu_master_t), 0);
+    smmu_master_remove(master_attr.smmu_index, master_attr.streamid);
 }
 
 static uint32_t smmu_init(smmu_dev_t *smmu)
@@ -1260,15 +1868,22 @@ void val_smmu_stop(void)
         smmu = &g_smmu[g_smmu_index];
         if (smmu->base == 0)
             continue;
+        if (smmu->irq_en)
+            val_smmu_irq_disable(g_smmu_index);
         smmu_dev_disable(smmu);
         if (smmu->cmdq.base_ptr)
             val_memory_free(smmu->cmdq.base_ptr);
+        if (smmu->cmdq.sync_ptr)
+            val_memory_free(smmu->cmdq.sync_ptr);
         if (smmu->evntq.base_ptr)
             val_memory_free(smmu->evntq.base_ptr);
         smmu_free_strtab(smmu);
     }
 
+    smmu_master_table_free();
+    smmu_cdtab_pool_free();
     val_memory_free(g_smmu);
+    val_pgt_release();
 }
 
 /**
@@ -1289,6 +1904,8 @@ uint32_t val_smmu_init(void)
         return ACS_STATUS_ERR;
     }
 
+    smmu_cdtab_pool_init();
+
     for (g_smmu_index  = 0; g_smmu_index  < g_num_smmus; ++g_smmu_index) {
         smmu_version = val_iovirt_get_smmu_info(SMMU_CTRL_ARCH_MAJOR_REV, g_smmu_index);
         if (smmu_version != 3) {
@@ -1338,6 +1955,10 @@ val_smmu_get_info(SMMU_INFO_e type, uint32_t smmu_index)
             return smmu->ias;
         case SMMU_OUT_ADDR_SIZE:
             return smmu->oas;
+        case SMMU_STRTAB_MEM_SIZE:
+            return smmu->strtab_cfg.mem_size;
+        case SMMU_CDTAB_POOL_ALLOCS:
+            return g_smmu_cdtab_pool.allocs;
         default:
             return val_iovirt_get_smmu_info(type, smmu_index);
     }
@@ -1361,3 +1982,267 @@ void val_smmu_dump_eventq(void)
     val_print(ACS_PRINT_TEST, "\n      Eventq dump finished...    ", 0);
     return;
 }
+
+/**
+  @brief  Drain the event queue of an SMMU, decoding all pending events and
+          adding them to the per SMMU event counters
+  @param  smmu_index - Index of SMMU in global SMMU table.
+  @param  events - array receiving the decoded events, may be NULL
+  @param  max_events - size of the events array
+  @return number of events drained, may exceed max_events. While the event
+          queue interrupt is armed, events already captured by the handler are
+          returned instead, at most max_events of them when events is not NULL.
+**/
+uint32_t val_smmu_evtq_drain(uint32_t smmu_index, smmu_event_t *events, uint32_t max_events)
+{
+    smmu_dev_t *smmu;
+
+    if ((g_smmu == NULL) || (smmu_index >= g_num_smmus))
+        return 0;
+
+    smmu = &g_smmu[smmu_index];
+    if (smmu->base == 0)
+        return 0;
+
+    return smmu_evt_read(smmu, events, max_events);
+}
+
+/**
+  @brief  Count the events drained from an SMMU since the counters were cleared
+  @param  smmu_index - Index of SMMU in global SMMU table.
+  @param  sid - StreamID or SMMU_EVT_ANY
+  @param  id - event type or SMMU_EVT_ANY
+  @return number of matching events, per StreamID counts exclude untracked events
+**/
+uint32_t val_smmu_evtq_get_count(uint32_t smmu_index, uint32_t sid, uint32_t id)
+{
+    smmu_evt_stats_t *stats;
+    uint32_t i, count = 0;
+
+    if ((g_smmu == NULL) || (smmu_index >= g_num_smmus))
+        return 0;
+
+    stats = &g_smmu[smmu_index].evt_stats;
+
+    if (sid == SMMU_EVT_ANY) {
+        if (id == SMMU_EVT_ANY)
+            return stats->total;
+        return (id < SMMU_EVT_ID_MAX) ? stats->type_cnt[id] : 0;
+    }
+
+    for (i = 0; i < stats->num_pairs; i++) {
+        if ((stats->pair[i].sid == sid) && ((id == SMMU_EVT_ANY) || (stats->pair[i].id == id)))
+            count += stats->pair[i].count;
+    }
+
+    return count;
+}
+
+/**
+  @brief  Clear the event counters of an SMMU
+  @param  smmu_index - Index of SMMU in global SMMU table.
+  @return void
+**/
+void val_smmu_evtq_clear_stats(uint32_t smmu_index)
+{
+    if ((g_smmu == NULL) || (smmu_index >= g_num_smmus))
+        return;
+
+    val_memory_set(&g_smmu[smmu_index].evt_stats, sizeof(smmu_evt_stats_t), 0);
+}
+
+/**
+  @brief  Wire the event queue and global error interrupts of an SMMU to the
+          calling PE. Events are then captured by the interrupt handler.
+          Only one SMMU is armed at a time, arming another disarms the previous.
+  @param  smmu_index - Index of SMMU in global SMMU table.
+  @return 0 on success, 1 if the SMMU has no wired interrupts or arming failed
+**/
+uint32_t val_smmu_irq_enable(uint32_t smmu_index)
+{
+    smmu_dev_t *smmu;
+    uint64_t mpidr = val_pe_get_mpid();
+    uint32_t en = 0;
+
+    if ((g_smmu == NULL) || (smmu_index >= g_num_smmus))
+        return 1;
+
+    smmu = &g_smmu[smmu_index];
+    if (smmu->base == 0)
+        return 1;
+
+    if ((g_smmu_irq_index != ACS_INVALID_INDEX) && (g_smmu_irq_index != smmu_index))
+        val_smmu_irq_disable(g_smmu_irq_index);
+
+    smmu->evt_gsiv = val_iovirt_get_smmu_info(SMMU_CTRL_EVENT_GSIV, smmu_index);
+    smmu->gerr_gsiv = val_iovirt_get_smmu_info(SMMU_CTRL_GERR_GSIV, smmu_index);
+    if (!smmu->evt_gsiv && !smmu->gerr_gsiv) {
+        val_print(ACS_PRINT_DEBUG, "\n       SMMU %d has no wired interrupts", smmu_index);
+        return 1;
+    }
+
+    g_smmu_irq_index = smmu_index;
+
+    /* A zero MSI address selects the wired interrupt */
+    if (smmu->evt_gsiv) {
+        val_mmio_write64(smmu->base + SMMU_EVTQ_IRQ_CFG0_OFFSET, 0);
+        if (val_gic_install_isr(smmu->evt_gsiv, smmu_evtq_isr)) {
+            val_print(ACS_PRINT_ERR, "\n       SMMU EVTQ ISR install failed 0x%x", smmu->evt_gsiv);
+            g_smmu_irq_index = ACS_INVALID_INDEX;
+            return 1;
+        }
+        val_gic_route_interrupt_to_pe(smmu->evt_gsiv, mpidr);
+        en |= IRQ_CTRL_EVTQ_IRQEN;
+    }
+
+    if (smmu->gerr_gsiv) {
+        val_mmio_write64(smmu->base + SMMU_GERROR_IRQ_CFG0_OFFSET, 0);
+        if (smmu->gerr_gsiv != smmu->evt_gsiv) {
+            if (val_gic_install_isr(smmu->gerr_gsiv, smmu_gerror_isr)) {
+                val_print(ACS_PRINT_ERR, "\n       SMMU GERROR ISR install failed 0x%x",
+                          smmu->gerr_gsiv);
+                /* Release the event queue interrupt installed above */
+                smmu->irq_en = en;
+                val_smmu_irq_disable(smmu_index);
+                return 1;
+            }
+            val_gic_route_interrupt_to_pe(smmu->gerr_gsiv, mpidr);
+        }
+        en |= IRQ_CTRL_GERROR_IRQEN;
+    }
+
+    if (smmu_reg_write_sync(smmu, en, SMMU_IRQ_CTRL_OFFSET, SMMU_IRQ_CTRLACK_OFFSET)) {
+        val_print(ACS_PRINT_ERR, "\n       failed to set SMMU_IRQ_CTRL     ", 0);
+        smmu->irq_en = en;
+        val_smmu_irq_disable(smmu_index);
+        return 1;
+    }
+
+    smmu->irq_en = en;
+    return 0;
+}
+
+/**
+  @brief  Disable the event queue and global error interrupts of an SMMU
+  @param  smmu_index - Index of SMMU in global SMMU table.
+  @return void
+**/
+void val_smmu_irq_disable(uint32_t smmu_index)
+{
+    smmu_dev_t *smmu;
+
+    if ((g_smmu == NULL) || (smmu_index >= g_num_smmus))
+        return;
+
+    smmu = &g_smmu[smmu_index];
+    if (smmu->base == 0)
+        return;
+
+    /* Release the lines first so the handlers never run with a stale index */
+    if (smmu->irq_en & IRQ_CTRL_EVTQ_IRQEN)
+        val_gic_free_irq(smmu->evt_gsiv, 0);
+    if ((smmu->irq_en & IRQ_CTRL_GERROR_IRQEN) && (smmu->gerr_gsiv != smmu->evt_gsiv))
+        val_gic_free_irq(smmu->gerr_gsiv, 0);
+
+    smmu_reg_write_sync(smmu, 0, SMMU_IRQ_CTRL_OFFSET, SMMU_IRQ_CTRLACK_OFFSET);
+    smmu->irq_en = 0;
+
+    if (g_smmu_irq_index == smmu_index)
+        g_smmu_irq_index = ACS_INVALID_INDEX;
+}
+
+/**
+  @brief  Wait for an event of an SMMU. Events captured ahead of the matching
+          one are discarded. The event queue is polled if its interrupt is not armed.
+  @param  smmu_index - Index of SMMU in global SMMU table.
+  @param  sid - StreamID or SMMU_EVT_ANY
+  @param  id - event type or SMMU_EVT_ANY
+  @param  timeout_ms - deadline in milliseconds
+  @param  event - receives the matching event, may be NULL
+  @return 0 if a matching event was received, 1 on timeout
+**/
+uint32_t val_smmu_wait_for_event(uint32_t smmu_index, uint32_t sid, uint32_t id,
+                                 uint32_t timeout_ms, smmu_event_t *event)
+{
+    smmu_dev_t *smmu;
+    smmu_event_t *evt;
+
+    if ((g_smmu == NULL) || (smmu_index >= g_num_smmus))
+        return 1;
+
+    smmu = &g_smmu[smmu_index];
+    if (smmu->base == 0)
+        return 1;
+
+    while (1) {
+        if (!(smmu->irq_en & IRQ_CTRL_EVTQ_IRQEN))
+            smmu_evt_capture(smmu);
+
+        while (smmu->evt_tail != smmu->evt_head) {
+            evt = &smmu->evt_ring[smmu->evt_tail % SMMU_EVT_RING_SIZE];
+            smmu->evt_tail++;
+            if (((sid == SMMU_EVT_ANY) || (evt->sid == sid)) &&
+                ((id == SMMU_EVT_ANY) || (evt->id == id))) {
+                if (event != NULL)
+                    *event = *evt;
+                return 0;
+            }
+        }
+
+        if (timeout_ms == 0)
+            return 1;
+
+        val_time_delay_ms(ONE_MILLISECOND);
+        timeout_ms--;
+    }
+}
+
+/**
+  @brief  Return and clear the global errors seen on an SMMU. GERROR is read
+          directly if its interrupt is not armed.
+  @param  smmu_index - Index of SMMU in global SMMU table.
+  @return SMMU_GERROR bits that became active
+**/
+uint32_t val_smmu_gerror_read_clear(uint32_t smmu_index)
+{
+    smmu_dev_t *smmu;
+    uint32_t active;
+
+    if ((g_smmu == NULL) || (smmu_index >= g_num_smmus))
+        return 0;
+
+    smmu = &g_smmu[smmu_index];
+    if (smmu->base == 0)
+        return 0;
+
+    if (!(smmu->irq_en & IRQ_CTRL_GERROR_IRQEN))
+        smmu_gerror_capture(smmu);
+
+    active = smmu->gerror_active;
+    smmu->gerror_active = 0;
+    return active;
+}
+
+/**
+  @brief  Invalidate the SMMU TLB entries of a mapped master for an input
+          address range. Range invalidation is used when SMMU_IDR3.RIL is
+          set, otherwise per page TLBIs or a per ASID/VMID invalidation.
+  @param  master_attr - structured data about the master (like streamid, smmu index)
+  @param  iova - start of the range
+  @param  size - size of the range in bytes
+  @return 0 on success, 1 if the master is not mapped
+**/
+uint32_t val_smmu_tlbi_range(smmu_master_attributes_t master_attr, uint64_t iova, uint64_t size)
+{
+    smmu_master_t *master;
+
+    if ((g_smmu == NULL) || (master_attr.smmu_index >= g_num_smmus))
+        return 1;
+
+    master = smmu_master_find(master_attr.smmu_index, master_attr.streamid);
+    if ((master == NULL) || (master->smmu == NULL) || (size == 0))
+        return 1;
+
+    smmu_master_tlbi_range(master, iova, size);
+    return 0;
+}
@@ -22,6 +22,7 @@
 #include "../include/acs_iovirt.h"
 #include "../include/acs_pgt.h"
 #include "../include/acs_pe.h"
+#include "../include/acs_smmu.h"
 #include "smmu_reg.h"
 
 #ifdef TARGET_EMULATION
@@ -35,7 +36,12 @@ static inline uint64_t get_max(uint64_t x, uint64_t y)
 
 #define CMDQ_OP_CFGI_STE 0x3
 #define CMDQ_OP_CFGI_ALL 0x4
+#define CMDQ_OP_CFGI_CD 0x5
+#define CMDQ_OP_TLBI_NH_ASID 0x11
+#define CMDQ_OP_TLBI_NH_VA 0x12
 #define CMDQ_OP_TLBI_EL2_ALL 0x20
+#define CMDQ_OP_TLBI_S12_VMALL 0x28
+#define CMDQ_OP_TLBI_S2_IPA 0x2a
 #define CMDQ_OP_TLBI_NSNH_ALL 0x30
 #define CMDQ_OP_CMD_SYNC 0x46
 
@@ -54,8 +60,19 @@ typedef struct {
     uint64_t entry_size;
     uint32_t *prod_reg;
     uint32_t *cons_reg;
+    void     *sync_ptr;     /* CMD_SYNC MSI target, coherent SMMUs with MSIs only */
+    uint64_t sync_phys;
+    uint32_t sync_seq;
 } smmu_cmd_queue_t;
 
+/* Commands published with one PROD update and completed by one CMD_SYNC */
+#define SMMU_CMDQ_BATCH_MAX 16
+
+typedef struct {
+    uint64_t cmds[SMMU_CMDQ_BATCH_MAX * CMDQ_DWORDS_PER_ENT];
+    uint32_t num;
+} smmu_cmdq_batch_t;
+
 typedef struct {
     smmu_queue_t queue;
     void    *base_ptr;
@@ -69,11 +86,23 @@ typedef struct {
 
 typedef struct {
     uint8_t  span;
-    void     *l2ptr;
-    uint64_t *l2desc64;
+    uint64_t *l2desc64;     /* NULL until a SID of the span is configured */
     uint64_t l2desc_phys;
 } smmu_strtab_l1_desc_t;
 
+/* Level 2 stream table spans are carved from pool chunks which double in
+   size up to STRTAB_L2_POOL_SPANS, so sparse SIDs stay cheap */
+#define STRTAB_L2_POOL_SPANS 16
+
+struct smmu_strtab_l2_chunk {
+    void     *ptr;
+    uint8_t  *base;
+    uint64_t base_phys;
+    uint32_t num_spans;
+    uint32_t used;
+    struct smmu_strtab_l2_chunk *next;
+};
+
 typedef struct {
     uint16_t vmid;
     uint64_t vttbr;
@@ -87,14 +116,34 @@ typedef struct {
     uint64_t    mair;
 } smmu_cdtab_ctx_desc_t;
 
+/* Zeroed memory aligned to its power of two size, recycled through per size
+   free lists so that map and unmap cycles of CD tables do not allocate */
+#define SMMU_CDTAB_POOL_CLASSES  32
+#define SMMU_CDTAB_POOL_MIN_LOG2 6
+#define SMMU_CDTAB_POOL_PREALLOC 4
+
+typedef struct smmu_cdtab_blk {
+    void     *ptr;
+    uint64_t *va;
+    uint64_t phys;
+    uint32_t log2size;
+    struct smmu_cdtab_blk *next;
+} smmu_cdtab_blk_t;
+
+typedef struct {
+    smmu_cdtab_blk_t *free[SMMU_CDTAB_POOL_CLASSES];
+    uint32_t allocs;        /* blocks allocated from the VAL heap */
+} smmu_cdtab_pool_t;
+
 typedef struct {
-    void     *l2ptr;
+    smmu_cdtab_blk_t *l2blk;
     uint64_t *l2desc64;
     uint64_t l2desc_phys;
 } smmu_cdtab_l1_ctx_desc_t;
 
 typedef struct {
-    void                           *cdtab_ptr;
+    smmu_cdtab_blk_t               *cdtab_blk;
+    smmu_cdtab_blk_t               *l1_desc_blk;
     uint64_t                       *cdtab64;
     uint64_t                       cdtab_phys;
     smmu_cdtab_l1_ctx_desc_t       *l1_desc;
@@ -116,8 +165,14 @@ typedef struct {
     uint32_t l1_ent_count;
     uint64_t strtab_base;
     uint32_t strtab_base_cfg;
+    struct smmu_strtab_l2_chunk *l2_pool;
+    uint32_t l2_span_count;
+    uint64_t mem_size;      /* bytes allocated for the stream table */
 } smmu_strtab_config_t;
 
+/* Events captured per SMMU for val_smmu_wait_for_event */
+#define SMMU_EVT_RING_SIZE 32
+
 typedef struct {
     uint64_t base;
     uint64_t page1_base;
@@ -136,12 +191,26 @@ typedef struct {
            uint32_t s1p:1;
            uint32_t s2p:1;
            uint32_t msi:1;
+           uint32_t cohacc:1;
+           uint32_t ril:1;
         };
         uint32_t bitmap;
     } supported;
     uint64_t msi_address;
+    smmu_evt_stats_t evt_stats;
+    uint32_t evt_gsiv;
+    uint32_t gerr_gsiv;
+    uint32_t irq_en;                    /* SMMU_IRQ_CTRL bits armed by the VAL */
+    volatile uint32_t gerror_active;    /* GERROR bits seen by the handler */
+    volatile uint32_t evt_head;         /* ring slots written by the capture */
+    volatile uint32_t evt_tail;         /* ring slots consumed by waiters */
+    uint32_t evt_ring_dropped;
+    smmu_event_t evt_ring[SMMU_EVT_RING_SIZE];
 } smmu_dev_t;
 
+/* Events decoded per pass when dumping the event queue */
+#define SMMU_EVTQ_DUMP_BATCH 16
+
 typedef enum {
     SMMU_STAGE_S1 = 0,
     SMMU_STAGE_S2,
@@ -157,11 +226,23 @@ typedef struct {
     uint32_t sid;
     uint32_t ssid;
     uint32_t ssid_bits;
+    uint32_t page_shift;
 } smmu_master_t;
 
 struct smmu_master_node {
     smmu_master_t *master;
+    uint32_t smmu_index;
+    uint32_t sid;
     struct smmu_master_node *next;
 };
 
+/* Masters hashed on (smmu_index, sid), grown to keep chains short */
+#define SMMU_MASTER_HASH_MIN_LOG2 6
+
+typedef struct {
+    struct smmu_master_node **bucket;
+    uint32_t log2size;
+    uint32_t count;
+} smmu_master_table_t;
+
 #endif /*__SMMU_V3_H__ */
@@ -55,6 +55,86 @@ uint32_t val_mpam_execute_error_tests(uint32_t num_pe);
 uint32_t val_mpam_execute_cache_tests(uint32_t num_pe);
 uint32_t val_mpam_execute_membw_tests(uint32_t num_pe);
 
+/* Traffic class of a contention run, see val_mpam_contention_run */
+typedef struct {
+    uint16_t partid;      /* PARTID driven by the PEs of the class */
+    uint8_t  pmg;         /* PMG driven by the PEs of the class */
+    uint32_t num_pe;      /* number of PEs generating the traffic */
+    uint32_t mode;        /* MPAM_TRAFFIC_MODE_e */
+    uint64_t byte_count;  /* MBWU count over the measurement window */
+    uint64_t bw_mbps;     /* bandwidth over the measurement window */
+} MPAM_CONT_CLASS;
+
+#define MPAM_CONT_CLASS_MAX 8
+
+/* Monitor types of a sampler, see val_mpam_mon_sampler_init */
+typedef enum {
+    MPAM_SAMPLE_MBWU,
+    MPAM_SAMPLE_CSU
+} MPAM_SAMPLE_TYPE_e;
+
+/* Sample flags */
+#define MPAM_SAMPLE_NRDY   0x1    /* monitor not ready, value not valid */
+#define MPAM_SAMPLE_OFLOW  0x2    /* counter wrapped during the interval */
+
+/* One monitor reading of a time series */
+typedef struct {
+    uint64_t time_us;     /* time since the start of sampling */
+    uint64_t value;       /* MBWU: bytes over the interval, CSU: occupancy */
+    uint32_t interval_us; /* MBWU: interval covered by value */
+    uint32_t flags;       /* MPAM_SAMPLE_* */
+} MPAM_MON_SAMPLE;
+
+/* Time series of one monitor instance, samples kept in a ring */
+typedef struct {
+    uint32_t msc_index;
+    uint16_t mon_sel;
+    uint32_t type;        /* MPAM_SAMPLE_TYPE_e */
+    uint32_t cnt_width;   /* MBWU: counter width in bits */
+    uint32_t scale;       /* MBWU: scaling of the 31 bit counter */
+    uint64_t last_raw;    /* MBWU: last ready counter value */
+    uint64_t last_tick;   /* MBWU: generic counter at last_raw */
+    uint64_t start_tick;
+    uint32_t size;        /* ring capacity */
+    uint32_t head;        /* next slot written */
+    uint32_t count;       /* samples in the ring */
+    uint32_t dropped;     /* samples overwritten */
+    uint32_t nrdy_cnt;
+    uint32_t oflow_cnt;
+    MPAM_MON_SAMPLE *ring;
+} MPAM_MON_SAMPLER;
+
+/* One step of a CSU occupancy profile, see val_mpam_csu_profile */
+typedef struct {
+    uint32_t fill_pct;    /* buffer size in percent of the cache size, set by caller */
+    uint64_t buf_size;    /* buffer size used for the step */
+    uint64_t csu;         /* CSU monitor reading after the fill */
+    uint32_t flags;       /* MPAM_SAMPLE_NRDY if the monitor never became ready */
+} MPAM_CSU_POINT;
+
+/* Partition controls of a sweep, see val_mpam_partition_sweep */
+typedef enum {
+    MPAM_SWEEP_CPOR,
+    MPAM_SWEEP_CCAP,
+    MPAM_SWEEP_MBWPBM,
+    MPAM_SWEEP_MBWMAX,
+    MPAM_SWEEP_MBWMIN,
+    MPAM_SWEEP_CTRL_MAX
+} MPAM_SWEEP_CTRL_e;
+
+/* One configuration of a sweep and its results */
+typedef struct {
+    uint32_t ctrl;        /* MPAM_SWEEP_CTRL_e, set by caller */
+    uint32_t pct;         /* configuration in percent, set by caller */
+    uint32_t programmed;  /* PARTIDs programmed, 0 if the control is absent */
+    uint32_t mismatch;    /* PARTIDs reading back differently from PARTID 0 */
+    uint64_t prog_ns_avg; /* programming latency of one PARTID */
+    uint64_t prog_ns_max;
+    uint32_t bursts;      /* PARTIDs exercised with a traffic burst */
+    uint64_t bw_mbps;     /* average burst bandwidth */
+    uint64_t mon_avg;     /* average MBWU bytes or CSU occupancy of a burst */
+} MPAM_SWEEP_CFG;
+
 // VAL API prototypes
 uint32_t val_mpam_msc_reset_errcode(uint32_t msc_index);
 uint32_t val_mpam_msc_get_errcode(uint32_t msc_index);
@@ -65,16 +145,42 @@ uint32_t val_mpam_msc_generate_pmgor_error(uint32_t msc_index);
 void     val_mpam_msc_generate_msmon_config_error(uint32_t msc_index, uint16_t mon_count);
 void     val_mpam_msc_generate_msmon_oflow_error(uint32_t msc_index, uint16_t mon_count);
 void     val_mpam_msc_trigger_intr(uint32_t msc_index);
+void     val_mpam_wait_us(uint64_t time_us);
+void     val_mpam_evict_buf(void *buf, uint64_t size);
+uint64_t val_mpam_set_pe_partid(uint16_t partid, uint8_t pmg);
+void     val_mpam_mbwu_select(uint32_t msc_index, uint16_t mon_sel);
+void     val_mpam_configure_mbwu_mon(uint32_t msc_index, uint16_t partid, uint8_t pmg,
+                                     uint16_t mon_sel);
+void     val_mpam_mbwu_mon_enable(uint32_t msc_index, uint16_t mon_sel, uint32_t enable);
+uint32_t val_mpam_contention_run(uint32_t msc_index, uint32_t rsrc_index, MPAM_CONT_CLASS *cls,
+                                 uint32_t cls_cnt, uint64_t buf_size, uint32_t window_us,
+                                 uint32_t test_num);
+uint32_t val_mpam_contention_check_ratio(MPAM_CONT_CLASS *limited, MPAM_CONT_CLASS *reference,
+                                         uint32_t max_pct);
+void     val_mpam_contention_set_sampling(uint32_t period_us);
+uint32_t val_mpam_mon_sampler_init(MPAM_MON_SAMPLER *smp, uint32_t msc_index, uint16_t mon_sel,
+                                   MPAM_SAMPLE_TYPE_e type, uint32_t size);
+void     val_mpam_mon_sampler_free(MPAM_MON_SAMPLER *smp);
+void     val_mpam_mon_sample(MPAM_MON_SAMPLER *smp);
+void     val_mpam_mon_sample_run(MPAM_MON_SAMPLER *smp, uint32_t smp_cnt, uint32_t period_us,
+                                 uint32_t duration_us);
+void     val_mpam_mon_sample_report(MPAM_MON_SAMPLER *smp);
+uint32_t val_mpam_csu_profile(uint32_t msc_index, uint32_t llc_index, uint16_t partid,
+                              uint8_t pmg, MPAM_CSU_POINT *pt, uint32_t pt_cnt);
+uint32_t val_mpam_partition_sweep(uint32_t msc_index, uint32_t rsrc_index, MPAM_SWEEP_CFG *cfg,
+                                  uint32_t cfg_cnt, uint32_t burst_cnt, uint64_t burst_size);
 
 // Register tests entry calls
 uint32_t reg001_entry(void);
 uint32_t reg002_entry(void);
 uint32_t reg003_entry(void);
+uint32_t reg004_entry(void);
 
 // Memory Bandwidth partitioning tests entry calls
 uint32_t mem001_entry(void);
 uint32_t mem002_entry(void);
 uint32_t mem003_entry(void);
+uint32_t mem004_entry(void);
 
 // Error and Interrupt tests entry calls
 uint32_t error001_entry(void);
@@ -101,6 +207,7 @@ uint32_t monitor001_entry(void);
 uint32_t monitor002_entry(void);
 uint32_t monitor003_entry(void);
 uint32_t monitor004_entry(void);
+uint32_t monitor005_entry(void);
 
 // Accessing system registers from .S -> can be moved to respective .h
 uint64_t arm64_write_sp(uint64_t write_data);
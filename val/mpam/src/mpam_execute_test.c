@@ -116,6 +116,7 @@ val_mpam_execute_membw_tests(uint32_t num_pe)
   status = mem001_entry();
   status |= mem002_entry();
   status |= mem003_entry();
+  status |= mem004_entry();
 
   val_print_test_end(status, "MEMORY BANDWIDTH");
 
@@ -159,6 +160,7 @@ val_mpam_execute_register_tests(uint32_t num_pe)
   status |= reg001_entry();
   status |= reg002_entry();
   status |= reg003_entry();
+  status |= reg004_entry();
 
   val_print_test_end(status, "REGISTER");
 
@@ -207,6 +209,7 @@ val_mpam_execute_cache_tests(uint32_t num_pe)
   status |= monitor002_entry();
   status |= monitor003_entry();
   status |= monitor004_entry();
+  status |= monitor005_entry();
 
   val_print_test_end(status, "CACHE");
 
@@ -0,0 +1,447 @@
+/** @file
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "common/include/acs_val.h"
+#include "common/include/acs_common.h"
+#include "common/include/acs_mpam.h"
+#include "common/include/acs_mpam_reg.h"
+#include "common/include/acs_memory.h"
+#include "common/include/acs_timer_support.h"
+#include "mpam/include/mpam_val_interface.h"
+
+/**
+  @brief   Converts generic counter ticks to microseconds.
+  @param   ticks - generic counter ticks.
+  @return  time in microseconds, 0 if the counter frequency is unknown.
+**/
+static
+uint64_t
+sample_ticks_to_us(uint64_t ticks)
+{
+  uint64_t freq = ArmArchTimerReadReg(CntFrq);
+
+  if (freq == 0)
+      return 0;
+
+  return (ticks * 1000000) / freq;
+}
+
+/**
+  @brief   Reads the raw value of the selected MBWU monitor, without scaling.
+  @param   smp - sampler of the monitor.
+  @param   raw - returns the counter value.
+  @return  1 if the monitor is not ready, 0 otherwise.
+**/
+static
+uint32_t
+sample_mbwu_read_raw(MPAM_MON_SAMPLER *smp, uint64_t *raw)
+{
+  uint64_t data;
+
+  if (smp->cnt_width > 31) {
+      data = val_mpam_mmr_read64(smp->msc_index, REG_MSMON_MBWU_L);
+      if (BITFIELD_READ(MSMON_MBWU_L_NRDY, data))
+          return 1;
+      if (smp->cnt_width == 63)
+          *raw = BITFIELD_READ(MSMON_MBWU_L_63BIT_VALUE, data);
+      else
+          *raw = BITFIELD_READ(MSMON_MBWU_L_44BIT_VALUE, data);
+      return 0;
+  }
+
+  data = val_mpam_mmr_read(smp->msc_index, REG_MSMON_MBWU);
+  if (BITFIELD_READ(MSMON_MBWU_NRDY, data))
+      return 1;
+  *raw = BITFIELD_READ(MSMON_MBWU_VALUE, data);
+  return 0;
+}
+
+/**
+  @brief   This API initialises a sampler that records a time series of one
+           MBWU or CSU monitor instance into a ring of preallocated samples.
+           The monitor itself is configured and enabled by the caller.
+  @param   smp       - sampler to initialise.
+  @param   msc_index - index of the MSC node in the MPAM info table.
+  @param   mon_sel   - monitor instance.
+  @param   type      - MPAM_SAMPLE_MBWU or MPAM_SAMPLE_CSU.
+  @param   size      - number of samples kept, older samples are overwritten.
+  @return  0 on success, 1 if the ring could not be allocated.
+**/
+uint32_t
+val_mpam_mon_sampler_init(MPAM_MON_SAMPLER *smp, uint32_t msc_index, uint16_t mon_sel,
+                          MPAM_SAMPLE_TYPE_e type, uint32_t size)
+{
+  val_memory_set(smp, sizeof(MPAM_MON_SAMPLER), 0);
+
+  if (size == 0)
+      return 1;
+
+  smp->ring = val_memory_calloc(size, sizeof(MPAM_MON_SAMPLE));
+  if (smp->ring == NULL) {
+      val_print(ACS_PRINT_ERR, "\n       Sampler ring allocation failed", 0);
+      return 1;
+  }
+
+  smp->msc_index = msc_index;
+  smp->mon_sel = mon_sel;
+  smp->type = type;
+  smp->size = size;
+
+  if (type == MPAM_SAMPLE_MBWU) {
+      if (val_mpam_mbwu_supports_lwd(msc_index))
+          smp->cnt_width = val_mpam_mbwu_supports_long(msc_index) ? 63 : 44;
+      else {
+          smp->cnt_width = 31;
+          smp->scale = BITFIELD_READ(MBWUMON_IDR_SCALE,
+                                     val_mpam_mmr_read(msc_index, REG_MPAMF_MBWUMON_IDR));
+      }
+  }
+
+  return 0;
+}
+
+/**
+  @brief   This API frees the ring of a sampler.
+  @param   smp - sampler initialised with val_mpam_mon_sampler_init.
+  @return  None
+**/
+void
+val_mpam_mon_sampler_free(MPAM_MON_SAMPLER *smp)
+{
+  if (smp->ring != NULL)
+      val_memory_free(smp->ring);
+
+  smp->ring = NULL;
+  smp->size = 0;
+  smp->count = 0;
+}
+
+/**
+  @brief   Starts the time series of a sampler: the time origin is set and,
+           for MBWU, the current count becomes the baseline of the first
+           interval.
+  @param   smp  - sampler of the monitor.
+  @param   tick - generic counter value of the time origin.
+  @return  None
+**/
+static
+void
+sample_start(MPAM_MON_SAMPLER *smp, uint64_t tick)
+{
+  uint64_t raw = 0;
+
+  smp->start_tick = tick;
+  smp->last_tick = tick;
+  smp->last_raw = 0;
+
+  if (smp->type == MPAM_SAMPLE_MBWU) {
+      val_mpam_mbwu_select(smp->msc_index, smp->mon_sel);
+      if (sample_mbwu_read_raw(smp, &raw) == 0)
+          smp->last_raw = raw;
+  }
+}
+
+/**
+  @brief   This API takes one sample of the monitor of a sampler.
+           MBWU samples hold the bytes counted since the previous ready
+           sample, so a not ready reading only widens the next interval.
+           A counter wrap is detected from MSMON_CFG_MBWU_CTL.OFLOW_STATUS or
+           from the count going backwards, and one wrap is accounted for by
+           modulo arithmetic on the counter width.
+           CSU samples hold the occupancy at the time of the sample.
+  @param   smp - sampler of the monitor.
+  @return  None
+**/
+void
+val_mpam_mon_sample(MPAM_MON_SAMPLER *smp)
+{
+  MPAM_MON_SAMPLE *s;
+  uint64_t now;
+  uint64_t raw;
+  uint64_t mask;
+  uint32_t data;
+
+  if ((smp->ring == NULL) || (smp->size == 0))
+      return;
+
+  /* MON_SEL is common to all monitor types */
+  val_mpam_mbwu_select(smp->msc_index, smp->mon_sel);
+  now = ArmArchTimerReadReg(CntPct);
+
+  s = &smp->ring[smp->head];
+  s->time_us = sample_ticks_to_us(now - smp->start_tick);
+  s->value = 0;
+  s->interval_us = 0;
+  s->flags = 0;
+
+  if (smp->type == MPAM_SAMPLE_CSU) {
+      data = val_mpam_mmr_read(smp->msc_index, REG_MSMON_CSU);
+      if (BITFIELD_READ(MSMON_CSU_NRDY, data))
+          s->flags |= MPAM_SAMPLE_NRDY;
+      else
+          s->value = BITFIELD_READ(MSMON_CSU_VALUE, data);
+  }
+  else if (sample_mbwu_read_raw(smp, &raw))
+      s->flags |= MPAM_SAMPLE_NRDY;
+  else {
+      data = val_mpam_mmr_read(smp->msc_index, REG_MSMON_CFG_MBWU_CTL);
+      if (BITFIELD_READ(MBWU_CTL_OFLOW_STATUS, data)) {
+          s->flags |= MPAM_SAMPLE_OFLOW;
+          data = BITFIELD_WRITE(data, MBWU_CTL_OFLOW_STATUS, 0);
+          val_mpam_mmr_write(smp->msc_index, REG_MSMON_CFG_MBWU_CTL, data);
+      }
+      if (raw < smp->last_raw)
+          s->flags |= MPAM_SAMPLE_OFLOW;
+
+      mask = (1ULL << smp->cnt_width) - 1;
+      s->value = ((raw - smp->last_raw) & mask) << smp->scale;
+      s->interval_us = (uint32_t)sample_ticks_to_us(now - smp->last_tick);
+
+      smp->last_raw = raw;
+      smp->last_tick = now;
+  }
+
+  if (s->flags & MPAM_SAMPLE_NRDY)
+      smp->nrdy_cnt++;
+  if (s->flags & MPAM_SAMPLE_OFLOW)
+      smp->oflow_cnt++;
+
+  smp->head = (smp->head + 1) % smp->size;
+  if (smp->count < smp->size)
+      smp->count++;
+  else
+      smp->dropped++;
+}
+
+/**
+  @brief   This API samples a set of monitors periodically for a duration,
+           polling the generic counter from the calling PE. All samplers share
+           the same time origin, so their series line up in the report.
+  @param   smp         - samplers initialised with val_mpam_mon_sampler_init.
+  @param   smp_cnt     - number of samplers.
+  @param   period_us   - sampling period in microseconds.
+  @param   duration_us - sampling duration in microseconds.
+  @return  None
+**/
+void
+val_mpam_mon_sample_run(MPAM_MON_SAMPLER *smp, uint32_t smp_cnt, uint32_t period_us,
+                        uint32_t duration_us)
+{
+  uint32_t i;
+  uint64_t freq;
+  uint64_t start;
+  uint64_t end;
+  uint64_t next;
+  uint64_t period;
+
+  freq = ArmArchTimerReadReg(CntFrq);
+  if ((freq == 0) || (period_us == 0)) {
+      val_print(ACS_PRINT_WARN, "\n       Monitor sampling not possible", 0);
+      val_mpam_wait_us(duration_us);
+      return;
+  }
+
+  period = ((uint64_t)period_us * freq) / 1000000;
+  if (period == 0)
+      period = 1;
+
+  start = ArmArchTimerReadReg(CntPct);
+  end = start + ((uint64_t)duration_us * freq) / 1000000;
+
+  for (i = 0; i < smp_cnt; i++)
+      sample_start(&smp[i], start);
+
+  for (next = start + period; next <= end; next += period) {
+      while (ArmArchTimerReadReg(CntPct) < next)
+          ;
+      for (i = 0; i < smp_cnt; i++)
+          val_mpam_mon_sample(&smp[i]);
+  }
+
+  while (ArmArchTimerReadReg(CntPct) < end)
+      ;
+}
+
+/**
+  @brief   This API prints the time series of a sampler as a compact timeline,
+           oldest sample first, followed by a summary line. Samples are
+           printed at debug level, MBWU values as MB/s over their interval.
+  @param   smp - sampler of the monitor.
+  @return  None
+**/
+void
+val_mpam_mon_sample_report(MPAM_MON_SAMPLER *smp)
+{
+  MPAM_MON_SAMPLE *s;
+  uint32_t i;
+  uint32_t valid = 0;
+  uint64_t value;
+  uint64_t min = 0;
+  uint64_t max = 0;
+  uint64_t sum = 0;
+
+  if ((smp->ring == NULL) || (smp->count == 0))
+      return;
+
+  val_print(ACS_PRINT_DEBUG, "\n       Timeline MSC %d", smp->msc_index);
+  val_print(ACS_PRINT_DEBUG, " mon %d", smp->mon_sel);
+  val_print(ACS_PRINT_DEBUG,
+            (smp->type == MPAM_SAMPLE_MBWU) ? " MBWU (MB/s)" : " CSU (bytes)", 0);
+
+  for (i = 0; i < smp->count; i++) {
+      s = &smp->ring[(smp->head + smp->size - smp->count + i) % smp->size];
+
+      val_print(ACS_PRINT_DEBUG, "\n         %8lld us", s->time_us);
+      if (s->flags & MPAM_SAMPLE_NRDY) {
+          val_print(ACS_PRINT_DEBUG, "     NRDY", 0);
+          continue;
+      }
+
+      if (smp->type == MPAM_SAMPLE_MBWU)
+          value = s->interval_us ? (s->value / s->interval_us) : 0;
+      else
+          value = s->value;
+
+      val_print(ACS_PRINT_DEBUG, " %8lld", value);
+      if (s->flags & MPAM_SAMPLE_OFLOW)
+          val_print(ACS_PRINT_DEBUG, " OFLOW", 0);
+
+      if ((valid == 0) || (value < min))
+          min = value;
+      if (value > max)
+          max = value;
+      sum += value;
+      valid++;
+  }
+
+  val_print(ACS_PRINT_TEST, "\n       Mon %d", smp->mon_sel);
+  val_print(ACS_PRINT_TEST, " samples %d", smp->count + smp->dropped);
+  if (valid) {
+      val_print(ACS_PRINT_TEST, " min %lld", min);
+      val_print(ACS_PRINT_TEST, " avg %lld", sum / valid);
+      val_print(ACS_PRINT_TEST, " max %lld", max);
+  }
+  if (smp->nrdy_cnt)
+      val_print(ACS_PRINT_TEST, " NRDY %d", smp->nrdy_cnt);
+  if (smp->oflow_cnt)
+      val_print(ACS_PRINT_TEST, " OFLOW %d", smp->oflow_cnt);
+  if (smp->dropped)
+      val_print(ACS_PRINT_TEST, " dropped %d", smp->dropped);
+}
+
+/**
+  @brief   This API profiles the cache storage usage of a PARTID and PMG in a
+           cache MSC. For every step a buffer of fill_pct percent of the cache
+           size, as described by the PPTT, is read twice by the calling PE with
+           the PARTID and PMG, and the CSU monitor is read once it is ready.
+           The buffer is evicted before the next step so that every step
+           starts from an empty partition.
+           Prerequisite - val_mpam_memory_configure_ris_sel for MSCs with RIS.
+  @param   msc_index - index of the MSC node in the MPAM info table.
+  @param   llc_index - index of the cache in the cache info table.
+  @param   partid    - PARTID of the fills.
+  @param   pmg       - PMG of the fills.
+  @param   pt        - profile steps, fill_pct set by the caller.
+  @param   pt_cnt    - number of steps.
+  @return  ACS_STATUS_PASS if profiled, ACS_STATUS_SKIP if the MSC has no CSU
+           monitor or the cache size is unknown, ACS_STATUS_FAIL otherwise.
+**/
+uint32_t
+val_mpam_csu_profile(uint32_t msc_index, uint32_t llc_index, uint16_t partid, uint8_t pmg,
+                     MPAM_CSU_POINT *pt, uint32_t pt_cnt)
+{
+  uint32_t i;
+  uint32_t data;
+  uint64_t cache_size;
+  uint64_t nrdy_us;
+  uint64_t mpam2_el2;
+  uint64_t start;
+  uint64_t freq;
+  uint8_t *buf;
+
+  if (!val_mpam_supports_csumon(msc_index) || (val_mpam_get_csumon_count(msc_index) == 0))
+      return ACS_STATUS_SKIP;
+
+  cache_size = val_cache_get_info(CACHE_SIZE, llc_index);
+  if ((cache_size == INVALID_CACHE_INFO) || (cache_size == 0))
+      return ACS_STATUS_SKIP;
+
+  nrdy_us = val_mpam_get_info(MPAM_MSC_NRDY, msc_index, 0);
+  freq = ArmArchTimerReadReg(CntFrq);
+
+  val_print(ACS_PRINT_DEBUG, "\n       CSU profile, cache size 0x%llx", cache_size);
+
+  for (i = 0; i < pt_cnt; i++) {
+      pt[i].buf_size = (cache_size * pt[i].fill_pct) / 100;
+      pt[i].buf_size = (pt[i].buf_size + MPAM_TRAFFIC_CHUNK - 1) &
+                       ~((uint64_t)MPAM_TRAFFIC_CHUNK - 1);
+      pt[i].csu = 0;
+      pt[i].flags = 0;
+
+      if (pt[i].buf_size == 0)
+          continue;
+
+      buf = (uint8_t *)val_aligned_alloc(MEM_ALIGN_4K, pt[i].buf_size);
+      if (buf == NULL) {
+          val_print(ACS_PRINT_ERR, "\n       CSU profile buffer allocation failed", 0);
+          return ACS_STATUS_FAIL;
+      }
+
+      /* start with none of the buffer in the cache */
+      val_mpam_evict_buf(buf, pt[i].buf_size);
+
+      val_mpam_configure_csu_mon(msc_index, partid, pmg, 0);
+      val_mpam_csumon_enable(msc_index);
+      val_mpam_wait_us(nrdy_us);
+
+      /* first pass allocates, second pass re-references the lines that stayed */
+      mpam2_el2 = val_mpam_set_pe_partid(partid, pmg);
+      val_mpam_mem_traffic(MPAM_TRAFFIC_READ, NULL, buf, pt[i].buf_size, 0);
+      val_mpam_mem_traffic(MPAM_TRAFFIC_READ, NULL, buf, pt[i].buf_size, 0);
+      val_mpam_reg_write(MPAM2_EL2, mpam2_el2);
+
+      /* the monitor may be not ready for up to MAX_NRDY_USEC */
+      start = ArmArchTimerReadReg(CntPct);
+      do {
+          data = val_mpam_mmr_read(msc_index, REG_MSMON_CSU);
+          if (BITFIELD_READ(MSMON_CSU_NRDY, data) == 0)
+              break;
+      } while ((freq != 0) &&
+               (ArmArchTimerReadReg(CntPct) - start) < (nrdy_us * freq) / 1000000);
+
+      if (BITFIELD_READ(MSMON_CSU_NRDY, data))
+          pt[i].flags |= MPAM_SAMPLE_NRDY;
+      else
+          pt[i].csu = BITFIELD_READ(MSMON_CSU_VALUE, data);
+
+      val_mpam_csumon_disable(msc_index);
+
+      val_mpam_evict_buf(buf, pt[i].buf_size);
+      val_memory_free_aligned(buf);
+
+      val_print(ACS_PRINT_DEBUG, "\n         %3d%%", pt[i].fill_pct);
+      val_print(ACS_PRINT_DEBUG, " buf 0x%llx", pt[i].buf_size);
+      if (pt[i].flags & MPAM_SAMPLE_NRDY)
+          val_print(ACS_PRINT_DEBUG, " CSU NRDY", 0);
+      else {
+          val_print(ACS_PRINT_DEBUG, " CSU 0x%llx", pt[i].csu);
+          val_print(ACS_PRINT_DEBUG, " (%d%% of cache)", (pt[i].csu * 100) / cache_size);
+      }
+  }
+
+  return ACS_STATUS_PASS;
+}
@@ -0,0 +1,356 @@
+/** @file
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "common/include/acs_val.h"
+#include "common/include/acs_common.h"
+#include "common/include/acs_mpam.h"
+#include "common/include/acs_mpam_reg.h"
+#include "common/include/acs_memory.h"
+#include "common/include/acs_timer_support.h"
+#include "mpam/include/mpam_val_interface.h"
+
+static char8_t *sweep_ctrl_name[MPAM_SWEEP_CTRL_MAX] = {
+  "\n       CPOR  ",
+  "\n       CCAP  ",
+  "\n       MBWPBM",
+  "\n       MBWMAX",
+  "\n       MBWMIN"
+};
+
+/**
+  @brief   Checks whether the selected MSC resource implements a control.
+  @param   msc_index - index of the MSC node in the MPAM info table.
+  @param   ctrl      - MPAM_SWEEP_CTRL_e.
+  @return  1 if implemented, 0 otherwise.
+**/
+static
+uint32_t
+sweep_ctrl_supported(uint32_t msc_index, uint32_t ctrl)
+{
+  switch (ctrl) {
+  case MPAM_SWEEP_CPOR:
+      return val_mpam_supports_cpor(msc_index);
+  case MPAM_SWEEP_CCAP:
+      return val_mpam_supports_ccap(msc_index);
+  case MPAM_SWEEP_MBWPBM:
+      return val_mpam_msc_supports_mbwpbm(msc_index);
+  case MPAM_SWEEP_MBWMAX:
+      return val_mpam_msc_supports_mbw_max(msc_index);
+  case MPAM_SWEEP_MBWMIN:
+      return val_mpam_msc_supports_mbw_min(msc_index);
+  default:
+      return 0;
+  }
+}
+
+/**
+  @brief   Programs a control of a PARTID with the existing configure APIs.
+  @param   msc_index - index of the MSC node in the MPAM info table.
+  @param   ctrl      - MPAM_SWEEP_CTRL_e.
+  @param   partid    - PARTID to program.
+  @param   pct       - configuration in percent.
+  @return  None
+**/
+static
+void
+sweep_program(uint32_t msc_index, uint32_t ctrl, uint16_t partid, uint32_t pct)
+{
+  switch (ctrl) {
+  case MPAM_SWEEP_CPOR:
+      val_mpam_configure_cpor(msc_index, partid, pct);
+      break;
+  case MPAM_SWEEP_CCAP:
+      val_mpam_configure_ccap(msc_index, partid, SOFTLIMIT_DIS, pct);
+      break;
+  case MPAM_SWEEP_MBWPBM:
+      val_mpam_configure_mbwpbm(msc_index, partid, pct);
+      break;
+  case MPAM_SWEEP_MBWMAX:
+      val_mpam_msc_configure_mbwmax(msc_index, partid,
+                                    (pct < 100) ? HARDLIMIT_EN : HARDLIMIT_DIS, pct);
+      break;
+  case MPAM_SWEEP_MBWMIN:
+      val_mpam_msc_configure_mbwmin(msc_index, partid, pct);
+      break;
+  default:
+      break;
+  }
+}
+
+/**
+  @brief   Reads back the configuration of a control for a PARTID. For the
+           bitmap controls the word holding the last bit set by pct is read.
+  @param   msc_index - index of the MSC node in the MPAM info table.
+  @param   ctrl      - MPAM_SWEEP_CTRL_e.
+  @param   partid    - PARTID to read.
+  @param   pct       - configuration in percent.
+  @return  register value.
+**/
+static
+uint32_t
+sweep_readback(uint32_t msc_index, uint32_t ctrl, uint16_t partid, uint32_t pct)
+{
+  uint32_t data;
+  uint32_t bits;
+  uint32_t width;
+  uint32_t reg;
+
+  /* retaining other configured fields e.g, RIS index if supported */
+  data = val_mpam_mmr_read(msc_index, REG_MPAMCFG_PART_SEL);
+  data = BITFIELD_WRITE(data, PART_SEL_PARTID_SEL, partid);
+  val_mpam_mmr_write(msc_index, REG_MPAMCFG_PART_SEL, data);
+
+  switch (ctrl) {
+  case MPAM_SWEEP_CPOR:
+  case MPAM_SWEEP_MBWPBM:
+      if (ctrl == MPAM_SWEEP_CPOR) {
+          width = val_mpam_get_cpbm_width(msc_index);
+          reg = REG_MPAMCFG_CPBM;
+      } else {
+          width = val_mpam_get_mbwpbm_width(msc_index);
+          reg = REG_MPAMCFG_MBW_PBM;
+      }
+      bits = (width * pct) / 100;
+      if (bits == 0)
+          bits = 1;
+      return val_mpam_mmr_read(msc_index, reg + ((bits - 1) / 32) * 4);
+  case MPAM_SWEEP_CCAP:
+      return val_mpam_mmr_read(msc_index, REG_MPAMCFG_CMAX);
+  case MPAM_SWEEP_MBWMAX:
+      return val_mpam_mmr_read(msc_index, REG_MPAMCFG_MBW_MAX);
+  case MPAM_SWEEP_MBWMIN:
+      return val_mpam_mmr_read(msc_index, REG_MPAMCFG_MBW_MIN);
+  default:
+      return 0;
+  }
+}
+
+/**
+  @brief   Runs a traffic burst with a PARTID and measures it. Memory
+           resources are loaded with a copy and counted by MBWU monitor 0,
+           cache resources are filled by reads and measured by CSU monitor 0.
+  @param   msc_index - index of the MSC node in the MPAM info table.
+  @param   rsrc_type - MPAM resource type of the selected resource.
+  @param   partid    - PARTID of the burst.
+  @param   buf       - burst buffer, twice size for memory resources.
+  @param   size      - burst size.
+  @param   mon       - returns the monitor reading, 0 without monitor.
+  @return  bandwidth of the burst in MB/s.
+**/
+static
+uint64_t
+sweep_burst(uint32_t msc_index, uint32_t rsrc_type, uint16_t partid, uint8_t *buf,
+            uint64_t size, uint64_t *mon)
+{
+  uint64_t mpam2_el2;
+  uint64_t bw;
+  uint64_t count;
+  uint32_t has_mbwu = 0;
+  uint32_t has_csu = 0;
+
+  *mon = 0;
+
+  if (rsrc_type == MPAM_RSRC_TYPE_MEMORY) {
+      val_mpam_evict_buf(buf, 2 * size);
+      has_mbwu = val_mpam_msc_supports_mbwumon(msc_index) &&
+                 val_mpam_get_mbwumon_count(msc_index);
+      if (has_mbwu) {
+          val_mpam_configure_mbwu_mon(msc_index, partid, DEFAULT_PMG, 0);
+          val_mpam_mbwu_mon_enable(msc_index, 0, 1);
+      }
+  } else {
+      val_mpam_evict_buf(buf, size);
+      has_csu = val_mpam_supports_csumon(msc_index) && val_mpam_get_csumon_count(msc_index);
+      if (has_csu) {
+          val_mpam_configure_csu_mon(msc_index, partid, DEFAULT_PMG, 0);
+          val_mpam_csumon_enable(msc_index);
+          val_mpam_wait_us(val_mpam_get_info(MPAM_MSC_NRDY, msc_index, 0));
+      }
+  }
+
+  mpam2_el2 = val_mpam_set_pe_partid(partid, DEFAULT_PMG);
+  if (rsrc_type == MPAM_RSRC_TYPE_MEMORY)
+      bw = val_mpam_mem_traffic(MPAM_TRAFFIC_COPY, buf + size, buf, size, 0);
+  else
+      bw = val_mpam_mem_traffic(MPAM_TRAFFIC_READ, NULL, buf, size, 0);
+  val_mpam_reg_write(MPAM2_EL2, mpam2_el2);
+
+  if (has_mbwu) {
+      val_mpam_mbwu_mon_enable(msc_index, 0, 0);
+      count = val_mpam_memory_mbwumon_read_count(msc_index);
+      if (count != (uint64_t)MPAM_MON_NOT_READY)
+          *mon = count;
+  }
+
+  if (has_csu) {
+      *mon = val_mpam_read_csumon(msc_index);
+      val_mpam_csumon_disable(msc_index);
+  }
+
+  return bw;
+}
+
+/**
+  @brief   This API sweeps partition configurations over every PARTID of an
+           MSC resource. For each configuration all PARTIDs are programmed,
+           timing every programming and reading the configuration back;
+           burst_cnt PARTIDs spread over the range also run a traffic burst.
+           The PARTIDs are restored to the default configuration afterwards
+           and the results are printed as one table row per configuration.
+           Prerequisite - val_mpam_memory_configure_ris_sel for MSCs with RIS.
+  @param   msc_index  - index of the MSC node in the MPAM info table.
+  @param   rsrc_index - index of the resource in the MSC node.
+  @param   cfg        - configurations, ctrl and pct set by the caller.
+  @param   cfg_cnt    - number of configurations.
+  @param   burst_cnt  - number of PARTIDs exercised with traffic, 0 for none.
+  @param   burst_size - size of a burst.
+  @return  ACS_STATUS_PASS if every programmed PARTID read back consistently,
+           ACS_STATUS_SKIP if no configuration applies, ACS_STATUS_FAIL otherwise.
+**/
+uint32_t
+val_mpam_partition_sweep(uint32_t msc_index, uint32_t rsrc_index, MPAM_SWEEP_CFG *cfg,
+                         uint32_t cfg_cnt, uint32_t burst_cnt, uint64_t burst_size)
+{
+  uint32_t c;
+  uint32_t partid;
+  uint32_t partid_max;
+  uint32_t burst_step = 0;
+  uint32_t rsrc_type;
+  uint32_t ref = 0;
+  uint32_t status = ACS_STATUS_SKIP;
+  uint64_t freq;
+  uint64_t start;
+  uint64_t ns;
+  uint64_t ns_sum;
+  uint64_t bw_sum;
+  uint64_t mon_sum;
+  uint64_t mon;
+  uint64_t mem_size;
+  uint8_t *buf = NULL;
+
+  partid_max = val_mpam_get_max_partid(msc_index);
+  rsrc_type = val_mpam_get_info(MPAM_MSC_RSRC_TYPE, msc_index, rsrc_index);
+  freq = ArmArchTimerReadReg(CntFrq);
+
+  /* burst buffers, traffic is only generated for memory and PE cache resources */
+  if (burst_cnt && burst_size) {
+      burst_size &= ~((uint64_t)MPAM_TRAFFIC_CHUNK - 1);
+      if (rsrc_type == MPAM_RSRC_TYPE_MEMORY) {
+          mem_size = val_mpam_memory_get_size(msc_index, rsrc_index);
+          if (mem_size < 2 * burst_size)
+              burst_size = (mem_size / 2) & ~((uint64_t)MPAM_TRAFFIC_CHUNK - 1);
+          if (burst_size)
+              buf = (uint8_t *)val_mem_alloc_at_address(
+                               val_mpam_memory_get_base(msc_index, rsrc_index), 2 * burst_size);
+      }
+      else if ((rsrc_type == MPAM_RSRC_TYPE_PE_CACHE) && burst_size)
+          buf = (uint8_t *)val_aligned_alloc(MEM_ALIGN_4K, burst_size);
+
+      if (buf != NULL)
+          burst_step = (partid_max + burst_cnt) / burst_cnt;
+  }
+
+  for (c = 0; c < cfg_cnt; c++) {
+      cfg[c].programmed = 0;
+      cfg[c].mismatch = 0;
+      cfg[c].prog_ns_avg = 0;
+      cfg[c].prog_ns_max = 0;
+      cfg[c].bursts = 0;
+      cfg[c].bw_mbps = 0;
+      cfg[c].mon_avg = 0;
+
+      if ((cfg[c].ctrl >= MPAM_SWEEP_CTRL_MAX) || !sweep_ctrl_supported(msc_index, cfg[c].ctrl))
+          continue;
+
+      if (status == ACS_STATUS_SKIP)
+          status = ACS_STATUS_PASS;
+
+      ns_sum = 0;
+      bw_sum = 0;
+      mon_sum = 0;
+
+      for (partid = 0; partid <= partid_max; partid++) {
+          start = ArmArchTimerReadReg(CntPct);
+          sweep_program(msc_index, cfg[c].ctrl, partid, cfg[c].pct);
+          ns = ArmArchTimerReadReg(CntPct) - start;
+          if (freq != 0)
+              ns = (ns * 1000000000) / freq;
+
+          ns_sum += ns;
+          if (ns > cfg[c].prog_ns_max)
+              cfg[c].prog_ns_max = ns;
+          cfg[c].programmed++;
+
+          /* every PARTID must hold the same configuration as PARTID 0 */
+          if (partid == 0)
+              ref = sweep_readback(msc_index, cfg[c].ctrl, partid, cfg[c].pct);
+          else if (sweep_readback(msc_index, cfg[c].ctrl, partid, cfg[c].pct) != ref) {
+              val_print(ACS_PRINT_DEBUG, "\n       Readback mismatch for PARTID %d", partid);
+              cfg[c].mismatch++;
+              status = ACS_STATUS_FAIL;
+          }
+
+          if (burst_step && ((partid % burst_step) == 0)) {
+              bw_sum += sweep_burst(msc_index, rsrc_type, partid, buf, burst_size, &mon);
+              mon_sum += mon;
+              cfg[c].bursts++;
+          }
+      }
+
+      cfg[c].prog_ns_avg = ns_sum / cfg[c].programmed;
+      if (cfg[c].bursts) {
+          cfg[c].bw_mbps = bw_sum / cfg[c].bursts;
+          cfg[c].mon_avg = mon_sum / cfg[c].bursts;
+      }
+
+      /* back to the reset configuration, no portion or bandwidth restriction */
+      for (partid = 0; partid <= partid_max; partid++)
+          sweep_program(msc_index, cfg[c].ctrl, partid,
+                        (cfg[c].ctrl == MPAM_SWEEP_MBWMIN) ? 0 : 100);
+  }
+
+  if (buf != NULL) {
+      if (rsrc_type == MPAM_RSRC_TYPE_MEMORY)
+          val_mem_free_at_address((uint64_t)buf, 2 * burst_size);
+      else
+          val_memory_free_aligned(buf);
+  }
+
+  val_print(ACS_PRINT_TEST, "\n       MSC %d", msc_index);
+  val_print(ACS_PRINT_TEST, " resource %d", rsrc_index);
+  val_print(ACS_PRINT_TEST, " PARTIDs %d", partid_max + 1);
+  val_print(ACS_PRINT_TEST, "\n       Ctrl     Pct  Mismatch  Avg ns  Max ns  Bursts  MB/s  Mon", 0);
+
+  for (c = 0; c < cfg_cnt; c++) {
+      if (cfg[c].ctrl >= MPAM_SWEEP_CTRL_MAX)
+          continue;
+      val_print(ACS_PRINT_TEST, sweep_ctrl_name[cfg[c].ctrl], 0);
+      val_print(ACS_PRINT_TEST, " %3d", cfg[c].pct);
+      if (cfg[c].programmed == 0) {
+          val_print(ACS_PRINT_TEST, "  not implemented", 0);
+          continue;
+      }
+      val_print(ACS_PRINT_TEST, "  %8d", cfg[c].mismatch);
+      val_print(ACS_PRINT_TEST, "  %6lld", cfg[c].prog_ns_avg);
+      val_print(ACS_PRINT_TEST, "  %6lld", cfg[c].prog_ns_max);
+      val_print(ACS_PRINT_TEST, "  %6d", cfg[c].bursts);
+      val_print(ACS_PRINT_TEST, "  %4lld", cfg[c].bw_mbps);
+      val_print(ACS_PRINT_TEST, "  0x%llx", cfg[c].mon_avg);
+  }
+
+  return status;
+}
@@ -0,0 +1,438 @@
+/** @file
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "common/include/acs_val.h"
+#include "common/include/acs_common.h"
+#include "common/include/acs_pe.h"
+#include "common/include/acs_mpam.h"
+#include "common/include/acs_mpam_reg.h"
+#include "common/include/acs_memory.h"
+#include "common/include/acs_timer_support.h"
+#include "mpam/include/mpam_val_interface.h"
+
+/* Test input passed to the contention PEs */
+#define CONT_INPUT(partid, pmg, mode)  ((uint64_t)(partid) | ((uint64_t)(pmg) << 16) | \
+                                        ((uint64_t)(mode) << 24))
+#define CONT_INPUT_PARTID(in)          ((uint16_t)((in) & 0xFFFF))
+#define CONT_INPUT_PMG(in)             ((uint8_t)(((in) >> 16) & 0xFF))
+#define CONT_INPUT_MODE(in)            ((uint32_t)(((in) >> 24) & 0xFF))
+
+/* Shared with the contention PEs, cleaned to PoC after every update */
+static volatile uint8_t g_cont_run;
+static uint64_t g_cont_buf_size;
+static uint32_t g_cont_test_num;
+
+/* Monitor sampling period of the contention runs, 0 when not sampled */
+static uint32_t g_cont_sample_us;
+
+/**
+  @brief   This API busy waits for a number of microseconds on the generic counter.
+  @param   time_us - time to wait in microseconds.
+  @return  None
+**/
+void
+val_mpam_wait_us(uint64_t time_us)
+{
+  uint64_t freq;
+  uint64_t start;
+  uint64_t ticks;
+
+  freq = ArmArchTimerReadReg(CntFrq);
+  if (freq == 0) {
+      val_time_delay_ms(time_us);
+      return;
+  }
+
+  ticks = (time_us * freq) / 1000000;
+  start = ArmArchTimerReadReg(CntPct);
+  while ((ArmArchTimerReadReg(CntPct) - start) < ticks)
+      ;
+}
+
+/**
+  @brief   This API cleans and invalidates a buffer from the caches line by
+           line, so that the next traffic on it reaches the memory and
+           allocates again with the PARTID and PMG of that traffic.
+  @param   buf  - buffer base.
+  @param   size - buffer size.
+  @return  None
+**/
+void
+val_mpam_evict_buf(void *buf, uint64_t size)
+{
+  uint64_t offset;
+
+  for (offset = 0; offset < size; offset += MPAM_TRAFFIC_CHUNK)
+      val_data_cache_ops_by_va((addr_t)((uint8_t *)buf + offset), CLEAN_AND_INVALIDATE);
+}
+
+/**
+  @brief   This API programs the default PARTID and PMG of the current PE in
+           MPAM2_EL2, used by the traffic the PE generates.
+  @param   partid  - PARTID for the PE traffic.
+  @param   pmg     - PMG for the PE traffic.
+  @return  previous value of MPAM2_EL2, to be restored by the caller.
+**/
+uint64_t
+val_mpam_set_pe_partid(uint16_t partid, uint8_t pmg)
+{
+  uint64_t mpam2_el2;
+  uint64_t data;
+
+  mpam2_el2 = val_mpam_reg_read(MPAM2_EL2);
+
+  /* Clear the PARTID_D & PMG_D bits in mpam2_el2 before writing to them */
+  data = CLEAR_BITS_M_TO_N(mpam2_el2, MPAMn_ELx_PARTID_D_SHIFT+15, MPAMn_ELx_PARTID_D_SHIFT);
+  data = CLEAR_BITS_M_TO_N(data, MPAMn_ELx_PMG_D_SHIFT+7, MPAMn_ELx_PMG_D_SHIFT);
+  data |= (((uint64_t)pmg << MPAMn_ELx_PMG_D_SHIFT) |
+           ((uint64_t)partid << MPAMn_ELx_PARTID_D_SHIFT));
+
+  val_mpam_reg_write(MPAM2_EL2, data);
+  return mpam2_el2;
+}
+
+/**
+  @brief   This API selects an MBWU monitor instance in MSMON_CFG_MON_SEL,
+           retaining the RIS selection.
+  @param   msc_index - index of the MSC node in the MPAM info table.
+  @param   mon_sel   - monitor instance.
+  @return  None
+**/
+void
+val_mpam_mbwu_select(uint32_t msc_index, uint16_t mon_sel)
+{
+  uint32_t data;
+
+  data = val_mpam_mmr_read(msc_index, REG_MSMON_CFG_MON_SEL);
+  data = BITFIELD_WRITE(data, MON_SEL_MON_SEL, mon_sel);
+  val_mpam_mmr_write(msc_index, REG_MSMON_CFG_MON_SEL, data);
+}
+
+/**
+  @brief   This API configures an MBWU monitor instance to count the traffic of
+           one PARTID and PMG, and resets it. The monitor is left disabled.
+           Prerequisite - If MSC supports RIS, Resource instance should be
+                          selected using val_mpam_memory_configure_ris_sel
+                          prior calling this API.
+  @param   msc_index - index of the MSC node in the MPAM info table.
+  @param   partid    - PARTID to match.
+  @param   pmg       - PMG to match.
+  @param   mon_sel   - monitor instance.
+  @return  None
+**/
+void
+val_mpam_configure_mbwu_mon(uint32_t msc_index, uint16_t partid, uint8_t pmg, uint16_t mon_sel)
+{
+  uint32_t data;
+
+  val_mpam_mbwu_select(msc_index, mon_sel);
+  val_mpam_memory_mbwumon_disable(msc_index);
+
+  /* count read and write bandwidth of the PARTID and PMG */
+  data = BITFIELD_SET(MBWU_FLT_PARTID, partid) | BITFIELD_SET(MBWU_FLT_PMG, pmg) |
+         BITFIELD_SET(MBWU_FLT_RWBW, MBWU_FLT_RWBW_RW);
+  val_mpam_mmr_write(msc_index, REG_MSMON_CFG_MBWU_FLT, data);
+
+  data = BITFIELD_SET(MBWU_CTL_MATCH_PARTID, 1) | BITFIELD_SET(MBWU_CTL_MATCH_PMG, 1);
+  val_mpam_mmr_write(msc_index, REG_MSMON_CFG_MBWU_CTL, data);
+
+  val_mpam_memory_mbwumon_reset(msc_index);
+}
+
+/**
+  @brief   This API enables or disables an MBWU monitor instance configured with
+           val_mpam_configure_mbwu_mon, keeping its PARTID and PMG match.
+  @param   msc_index - index of the MSC node in the MPAM info table.
+  @param   mon_sel   - monitor instance.
+  @param   enable    - 1 to enable, 0 to disable.
+  @return  None
+**/
+void
+val_mpam_mbwu_mon_enable(uint32_t msc_index, uint16_t mon_sel, uint32_t enable)
+{
+  uint32_t data;
+
+  val_mpam_mbwu_select(msc_index, mon_sel);
+  data = val_mpam_mmr_read(msc_index, REG_MSMON_CFG_MBWU_CTL);
+  data = BITFIELD_WRITE(data, MBWU_CTL_EN, enable ? 1 : 0);
+  val_mpam_mmr_write(msc_index, REG_MSMON_CFG_MBWU_CTL, data);
+}
+
+/**
+  @brief   Payload of the contention PEs. Generates traffic with the PARTID, PMG
+           and mode passed as test input until the primary PE stops the run.
+  @param   None
+  @return  None
+**/
+static
+void
+contention_payload(void)
+{
+  uint32_t pe_index;
+  uint64_t payload;
+  uint64_t input;
+  uint64_t mpam2_el2;
+  uint8_t *buf;
+
+  pe_index = val_pe_get_index_mpid(val_pe_get_mpid());
+  val_get_test_data(pe_index, &payload, &input);
+
+  buf = (uint8_t *)val_get_shared_memcpybuf(pe_index);
+  mpam2_el2 = val_mpam_set_pe_partid(CONT_INPUT_PARTID(input), CONT_INPUT_PMG(input));
+
+  while (g_cont_run) {
+      val_mpam_mem_traffic(CONT_INPUT_MODE(input), buf + g_cont_buf_size, buf,
+                           g_cont_buf_size, MPAM_TRAFFIC_NON_TEMPORAL);
+      val_data_cache_ops_by_va((addr_t)&g_cont_run, INVALIDATE);
+  }
+
+  val_mpam_reg_write(MPAM2_EL2, mpam2_el2);
+  val_set_status(pe_index, RESULT_PASS(g_cont_test_num, 01));
+}
+
+/**
+  @brief   This API waits for the contention PEs to complete.
+  @param   primary_pe_index - index of the PE running the run.
+  @param   num_pe           - number of PEs.
+  @param   used_pe          - number of contention PEs, scales the timeout.
+  @return  0 if all PEs completed, 1 on timeout.
+**/
+static
+uint32_t
+contention_wait_pe(uint32_t primary_pe_index, uint32_t num_pe, uint32_t used_pe)
+{
+  uint32_t pe_index;
+  uint32_t pending;
+  uint64_t timeout = used_pe * TIMEOUT_LARGE;
+
+  do {
+      pending = 0;
+      for (pe_index = 0; pe_index < num_pe; pe_index++) {
+          if (pe_index != primary_pe_index)
+              pending |= IS_RESULT_PENDING(val_get_status(pe_index));
+      }
+  } while (pending && (--timeout));
+
+  if (pending) {
+      for (pe_index = 0; pe_index < num_pe; pe_index++) {
+          if ((pe_index != primary_pe_index) && IS_RESULT_PENDING(val_get_status(pe_index)))
+              val_print(ACS_PRINT_ERR, "\n       Contention PE %x time-out", pe_index);
+      }
+      return 1;
+  }
+
+  return 0;
+}
+
+/**
+  @brief   This API makes the following contention runs record the MBWU
+           monitor of every class as a time series over the measurement
+           window, reported as a timeline.
+  @param   period_us - sampling period in microseconds, 0 to disable.
+  @return  None
+**/
+void
+val_mpam_contention_set_sampling(uint32_t period_us)
+{
+  g_cont_sample_us = period_us;
+}
+
+/**
+  @brief   This API runs traffic classes simultaneously against a memory MSC
+           resource. Each class drives its PARTID and PMG from num_pe PEs, and
+           is counted by its own MBWU monitor over a measurement window taken
+           while all PEs are loading the memory. The PE calling the API only
+           orchestrates the run.
+           Prerequisite - val_mpam_memory_configure_ris_sel for MSCs with RIS.
+  @param   msc_index  - index of the MSC node in the MPAM info table.
+  @param   rsrc_index - index of the memory resource in the MSC node.
+  @param   cls        - traffic classes, byte_count and bw_mbps are returned.
+  @param   cls_cnt    - number of classes, at most MPAM_CONT_CLASS_MAX.
+  @param   buf_size   - per PE buffer size, reduced to fit the memory range.
+  @param   window_us  - measurement window in microseconds.
+  @param   test_num   - test number used for the contention PE status.
+  @return  ACS_STATUS_PASS if every class was measured, ACS_STATUS_SKIP if
+           the system lacks PEs or monitors, ACS_STATUS_FAIL otherwise.
+**/
+uint32_t
+val_mpam_contention_run(uint32_t msc_index, uint32_t rsrc_index, MPAM_CONT_CLASS *cls,
+                        uint32_t cls_cnt, uint64_t buf_size, uint32_t window_us,
+                        uint32_t test_num)
+{
+  uint32_t c;
+  uint32_t i;
+  uint32_t pe_index;
+  uint32_t primary_pe_index;
+  uint32_t num_pe = val_pe_get_num();
+  uint32_t used_pe = 0;
+  uint32_t status = ACS_STATUS_PASS;
+  uint64_t mem_size;
+  uint64_t freq;
+  uint64_t start;
+  uint64_t ticks;
+  uint64_t count;
+  uint32_t smp_cnt = 0;
+  MPAM_MON_SAMPLER smp[MPAM_CONT_CLASS_MAX];
+
+  primary_pe_index = val_pe_get_index_mpid(val_pe_get_mpid());
+
+  if ((cls_cnt == 0) || (cls_cnt > MPAM_CONT_CLASS_MAX))
+      return ACS_STATUS_FAIL;
+
+  for (c = 0; c < cls_cnt; c++)
+      used_pe += cls[c].num_pe;
+
+  if (used_pe > num_pe - 1) {
+      val_print(ACS_PRINT_TEST, "\n       Contention needs %d secondary PEs", used_pe);
+      return ACS_STATUS_SKIP;
+  }
+
+  if (val_mpam_get_mbwumon_count(msc_index) < cls_cnt) {
+      val_print(ACS_PRINT_TEST, "\n       Contention needs %d MBWU monitors", cls_cnt);
+      return ACS_STATUS_SKIP;
+  }
+
+  /* source and destination buffer for every PE, fitted in the memory range */
+  mem_size = val_mpam_memory_get_size(msc_index, rsrc_index);
+  if (mem_size < (uint64_t)num_pe * 2 * buf_size)
+      buf_size = mem_size / (num_pe * 2);
+  buf_size &= ~((uint64_t)MPAM_TRAFFIC_CHUNK - 1);
+  if (buf_size == 0)
+      return ACS_STATUS_SKIP;
+
+  if (!val_alloc_shared_memcpybuf(val_mpam_memory_get_base(msc_index, rsrc_index),
+                                  2 * buf_size, num_pe))
+      return ACS_STATUS_FAIL;
+
+  for (c = 0; c < cls_cnt; c++) {
+      val_mpam_configure_mbwu_mon(msc_index, cls[c].partid, cls[c].pmg, c);
+      cls[c].byte_count = 0;
+      cls[c].bw_mbps = 0;
+  }
+
+  g_cont_buf_size = buf_size;
+  g_cont_test_num = test_num;
+  g_cont_run = 1;
+  val_data_cache_ops_by_va((addr_t)&g_cont_buf_size, CLEAN);
+  val_data_cache_ops_by_va((addr_t)&g_cont_test_num, CLEAN);
+  val_data_cache_ops_by_va((addr_t)&g_cont_run, CLEAN);
+
+  /* hand out secondary PEs to the classes in order */
+  pe_index = 0;
+  for (c = 0; c < cls_cnt; c++) {
+      for (i = 0; i < cls[c].num_pe; i++, pe_index++) {
+          if (pe_index == primary_pe_index)
+              pe_index++;
+          val_set_status(pe_index, RESULT_PENDING(test_num));
+          val_execute_on_pe(pe_index, contention_payload,
+                            CONT_INPUT(cls[c].partid, cls[c].pmg, cls[c].mode));
+      }
+  }
+
+  /* let every PE reach steady state before measuring */
+  val_mpam_wait_us(window_us);
+
+  if (g_cont_sample_us) {
+      for (smp_cnt = 0; smp_cnt < cls_cnt; smp_cnt++) {
+          if (val_mpam_mon_sampler_init(&smp[smp_cnt], msc_index, smp_cnt, MPAM_SAMPLE_MBWU,
+                                        window_us / g_cont_sample_us + 1))
+              break;
+      }
+  }
+
+  freq = ArmArchTimerReadReg(CntFrq);
+  start = ArmArchTimerReadReg(CntPct);
+  for (c = 0; c < cls_cnt; c++)
+      val_mpam_mbwu_mon_enable(msc_index, c, 1);
+
+  if (smp_cnt == cls_cnt)
+      val_mpam_mon_sample_run(smp, smp_cnt, g_cont_sample_us, window_us);
+  else
+      val_mpam_wait_us(window_us);
+
+  for (c = 0; c < cls_cnt; c++)
+      val_mpam_mbwu_mon_enable(msc_index, c, 0);
+  ticks = ArmArchTimerReadReg(CntPct) - start;
+
+  g_cont_run = 0;
+  val_data_cache_ops_by_va((addr_t)&g_cont_run, CLEAN);
+
+  for (c = 0; c < cls_cnt; c++) {
+      val_mpam_mbwu_select(msc_index, c);
+      count = val_mpam_memory_mbwumon_read_count(msc_index);
+      if (count == (uint64_t)MPAM_MON_NOT_READY) {
+          val_print(ACS_PRINT_ERR, "\n       MBWU monitor %d not ready", c);
+          status = ACS_STATUS_FAIL;
+          continue;
+      }
+      cls[c].byte_count = count;
+      if ((freq != 0) && (ticks != 0))
+          cls[c].bw_mbps = ((count / 1000) * freq / ticks) / 1000;
+  }
+
+  if (contention_wait_pe(primary_pe_index, num_pe, used_pe))
+      status = ACS_STATUS_FAIL;
+
+  for (c = 0; c < cls_cnt; c++) {
+      val_print(ACS_PRINT_TEST, "\n       Class %d", c);
+      val_print(ACS_PRINT_TEST, " PARTID %d", cls[c].partid);
+      val_print(ACS_PRINT_TEST, " PMG %d", cls[c].pmg);
+      val_print(ACS_PRINT_TEST, " PEs %d", cls[c].num_pe);
+      val_print(ACS_PRINT_TEST, " bytes 0x%llx", cls[c].byte_count);
+      val_print(ACS_PRINT_TEST, " MB/s %lld", cls[c].bw_mbps);
+      if (smp_cnt == cls_cnt)
+          val_mpam_mon_sample_report(&smp[c]);
+  }
+
+  for (c = 0; c < smp_cnt; c++)
+      val_mpam_mon_sampler_free(&smp[c]);
+
+  val_mem_free_shared_memcpybuf(num_pe);
+  return status;
+}
+
+/**
+  @brief   This API checks the bandwidth isolation of two classes measured by
+           val_mpam_contention_run: the share of the limited class must not
+           exceed max_pct percent of the share of the reference class.
+  @param   limited   - class with the more restrictive configuration.
+  @param   reference - class it is compared with.
+  @param   max_pct   - maximum ratio limited / reference, in percent.
+  @return  ACS_STATUS_PASS if isolated, ACS_STATUS_FAIL otherwise.
+**/
+uint32_t
+val_mpam_contention_check_ratio(MPAM_CONT_CLASS *limited, MPAM_CONT_CLASS *reference,
+                                uint32_t max_pct)
+{
+  uint64_t limited_pe;
+  uint64_t reference_pe;
+
+  if ((limited->num_pe == 0) || (reference->num_pe == 0) || (reference->byte_count == 0))
+      return ACS_STATUS_FAIL;
+
+  /* compare per PE shares, classes may use different PE counts */
+  limited_pe = limited->byte_count / limited->num_pe;
+  reference_pe = reference->byte_count / reference->num_pe;
+
+  val_print(ACS_PRINT_DEBUG, "\n       Isolation ratio %lld percent",
+            (limited_pe * 100) / reference_pe);
+
+  if (limited_pe * 100 > reference_pe * max_pct)
+      return ACS_STATUS_FAIL;
+
+  return ACS_STATUS_PASS;
+}